@@ -0,0 +1,124 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include <cstring>
+#include "AsyncLogBuf.h"
+
+
+AsyncLogBuf::AsyncLogBuf(std::streambuf* pSink, size_t bufferSize)
+	: pSink(pSink)
+{
+	buffers[0].resize(bufferSize);
+	buffers[1].resize(bufferSize);
+	fillBuffer = 0;
+	pendingSize = 0;
+	pending = false;
+	shutdown = false;
+	setp(buffers[0].data(), buffers[0].data() + bufferSize);
+	writer = std::thread(&AsyncLogBuf::writerLoop, this);
+}
+
+AsyncLogBuf::~AsyncLogBuf()
+{
+	flush();
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		shutdown = true;
+	}
+	writeReady.notify_one();
+	writer.join();
+}
+
+void AsyncLogBuf::flush()
+{
+	handOff();
+	std::unique_lock<std::mutex> guard(lock);
+	writeDone.wait(guard, [this] { return (!pending); });
+	pSink->pubsync();
+}
+
+AsyncLogBuf::int_type AsyncLogBuf::overflow(int_type ch)
+{
+	handOff();
+	if (!traits_type::eq_int_type(ch, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(ch);
+		pbump(1);
+	}
+	return (traits_type::not_eof(ch));
+}
+
+std::streamsize AsyncLogBuf::xsputn(const char* pChars, std::streamsize count)
+{
+	std::streamsize written = 0;
+	while (written < count)
+	{
+		std::streamsize room = epptr() - pptr();
+		if (room == 0)
+		{
+			handOff();
+			room = epptr() - pptr();
+		}
+		std::streamsize chunk = std::min(room, count - written);
+		memcpy(pptr(), pChars + written, (size_t)chunk);
+		pbump((int)chunk);
+		written += chunk;
+	}
+	return (written);
+}
+
+int AsyncLogBuf::sync()
+{
+	return (0);                                     // Buffered until full or flush()
+}
+
+void AsyncLogBuf::handOff()
+{
+	size_t size = pptr() - pbase();
+	if (size == 0)
+		return;
+
+	std::unique_lock<std::mutex> guard(lock);
+	writeDone.wait(guard, [this] { return (!pending); });      // Writer finished with the other buffer
+	pendingSize = size;
+	pending = true;
+	fillBuffer ^= 1;
+	setp(buffers[fillBuffer].data(), buffers[fillBuffer].data() + buffers[fillBuffer].size());
+	guard.unlock();
+	writeReady.notify_one();
+}
+
+void AsyncLogBuf::writerLoop()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true)
+	{
+		writeReady.wait(guard, [this] { return (pending || shutdown); });
+		if (pending)
+		{
+			const char* pData = buffers[fillBuffer ^ 1].data();
+			size_t size = pendingSize;
+			guard.unlock();
+			pSink->sputn(pData, (std::streamsize)size);
+			guard.lock();
+			pending = false;
+			writeDone.notify_all();
+		}
+		else if (shutdown)
+			return;
+	}
+}
@@ -0,0 +1,62 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+/*
+*   Class AsyncLogBuf is a stream buffer that collects log messages in memory and has a background thread write
+*      them to another stream buffer (e.g. the log file), so the simulation does not wait for file I/O.
+*   There are two buffers:  one is filled while the background thread writes the other.  A buffer is handed to the
+*      background thread only when it is full or on flush(), so std::endl does not cause a write.
+*      flush() (and the destructor) return only after everything written so far has reached the sink.
+*   Messages must come from one thread at a time (the simulation thread;  worker threads log to per-Device buffers).
+*/
+
+class AsyncLogBuf : public std::streambuf
+{
+public:
+	explicit AsyncLogBuf(std::streambuf* pSink, size_t bufferSize = 1 << 16);
+	~AsyncLogBuf();
+	AsyncLogBuf(AsyncLogBuf& copySource) = delete;             // Disable copy constructor
+	AsyncLogBuf& operator= (const AsyncLogBuf&) = delete;      // Disable assignment operator
+
+	void flush();
+
+protected:
+	virtual int_type overflow(int_type ch);
+	virtual std::streamsize xsputn(const char* pChars, std::streamsize count);
+	virtual int sync();
+
+private:
+	std::streambuf* pSink;
+	std::vector<char> buffers[2];
+	int fillBuffer;                      // Buffer being filled;  the other one belongs to the writer while pending
+	size_t pendingSize;
+	bool pending;                        // Other buffer holds pendingSize octets not yet written
+	bool shutdown;
+	std::mutex lock;
+	std::condition_variable writeReady;
+	std::condition_variable writeDone;
+	std::thread writer;
+
+	void handOff();
+	void writerLoop();
+};
@@ -0,0 +1,419 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "Benchmark.h"
+#include <cstdio>
+#include <sstream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fstream>
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+
+/*
+*   BenchSap is an ISS that supplies a Bridge with one ingress Frame at a time and discards egress Frames,
+*      so Bridge::run can be timed without Macs and links.
+*/
+class BenchSap : public Iss
+{
+public:
+	BenchSap(unsigned long long addr) : macAddress(addr), transmitted(0) { enabled = true; }
+
+	virtual unsigned long long getMacAddress() const override { return (macAddress); }
+	virtual unique_ptr<Frame> Indication() override { return (std::move(pIngress)); }
+	virtual void Request(unique_ptr<Frame> /* pFrameIn */) override { transmitted++; }
+
+	unique_ptr<Frame> pIngress;
+	unsigned long long macAddress;
+	unsigned long long transmitted;
+};
+
+
+void Benchmark::run()
+{
+	cout << endl << "   Benchmarks:  " << endl << endl;
+	SimLog::logFile << endl << "   Benchmarks:  " << endl << endl;
+
+	nborLookup();
+	xpduCheck();
+	traceRecord();
+	bridgeForwarding();
+	vlanFlooding();
+}
+
+double Benchmark::nsPerOp(std::chrono::steady_clock::time_point start, unsigned long long ops)
+{
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return (elapsed.count() / (ops ? ops : 1));
+}
+
+void Benchmark::report(const std::string& name, unsigned long long size, double ns)
+{
+	cout << "    " << std::left << std::setw(24) << name << std::right << std::setw(8) << size
+		<< std::fixed << std::setprecision(1) << std::setw(12) << ns << " ns/op" << endl;
+	SimLog::logFile << "    " << std::left << std::setw(24) << name << std::right << std::setw(8) << size
+		<< std::fixed << std::setprecision(1) << std::setw(12) << ns << " ns/op" << endl;
+	cout.unsetf(std::ios::floatfield);
+	SimLog::logFile.unsetf(std::ios::floatfield);
+}
+
+void Benchmark::trimMemory()
+{
+	//  Returns memory the heap holds free (e.g. from an earlier scenario) to the system, so reusing it counts again
+#ifdef _WIN32
+	SetProcessWorkingSetSize(GetCurrentProcess(), (SIZE_T)-1, (SIZE_T)-1);
+#elif defined(__GLIBC__)
+	malloc_trim(0);
+#endif
+}
+
+size_t Benchmark::residentMemoryKB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return (0);
+	return (counters.WorkingSetSize / 1024);
+#else
+	std::ifstream statm("/proc/self/statm");       // Total and resident pages
+	size_t totalPages = 0;
+	size_t residentPages = 0;
+	if (!(statm >> totalPages >> residentPages))
+		return (0);
+	return (residentPages * (size_t)sysconf(_SC_PAGESIZE) / 1024);
+#endif
+}
+
+void Benchmark::nborLookup()
+{
+	//  Looks up each neighbor of a port in turn, as rxProcessFrame does for each received LLDPDU, with the
+	//     hash index and with a linear search of nborMIBs (the way findNborIndex used to work).
+	//     Neighbors are many ports on a few chassis, as seen by a port facing a hub, TPMR, or virtual switch.
+	const unsigned int nborCounts[] = { 1, 10, 100, 1000, 10000 };
+	const unsigned long long targetOps = 2000000;
+
+	for (unsigned int nborCount : nborCounts)
+	{
+		LldpPort port(0x24a60bff0000, 0, NearestBridgeDA);
+		std::vector<TlvView> chassisViews;
+		std::vector<TlvView> portViews;
+
+		for (unsigned int i = 0; i < nborCount; i++)
+		{
+			MibEntry nbor;
+			nbor.chassisID = TLV(TLVtypes::CHASSIS_ID, 7);
+			nbor.chassisID.putChar(2, 4);
+			nbor.chassisID.putAddr(3, 0x24a60b000000 + ((unsigned long long)(i / 64) << 16));
+			nbor.portID = TLV(TLVtypes::PORT_ID, 5);
+			nbor.portID.putChar(2, 4);
+			nbor.portID.putLong(3, i % 64);
+			port.addNbor(nbor);
+		}
+		for (auto& nbor : port.nborMIBs)           // Views into the MIB stay valid since nborMIBs no longer changes
+		{
+			chassisViews.push_back(nbor.chassisID.view());
+			portViews.push_back(nbor.portID.view());
+		}
+
+		unsigned long long found = 0;
+		unsigned long long ops = std::max(targetOps / nborCount, (unsigned long long)1) * nborCount;
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned long long op = 0; op < ops; op++)
+		{
+			unsigned int i = (unsigned int)(op % nborCount);
+			found += (port.findNbor(chassisViews[i], portViews[i]) == i);
+		}
+		report("hashed nbor lookup", nborCount, nsPerOp(start, ops));
+
+		unsigned long long linearOps = std::max((targetOps / 100) / nborCount, (unsigned long long)1) * nborCount;
+		start = std::chrono::steady_clock::now();
+		for (unsigned long long op = 0; op < linearOps; op++)
+		{
+			unsigned int i = (unsigned int)(op % nborCount);
+			unsigned int index = 0;
+			while ((index < port.nborMIBs.size()) &&
+				!((port.nborMIBs[index].chassisID == chassisViews[i]) && (port.nborMIBs[index].portID == portViews[i])))
+				index++;
+			found += (index == i);
+		}
+		report("linear nbor lookup", nborCount, nsPerOp(start, linearOps));
+
+		if (found != ops + linearOps)
+			SimLog::logFile << "    nbor lookup found wrong neighbor " << (ops + linearOps - found) << " times" << endl;
+	}
+}
+
+void Benchmark::xpduCheck()
+{
+	//  CRC-32C of XPDU sized blocks (from a single short TLV up to a full 1500 octet XPDU) with the table driven
+	//     calculation and, if the processor has SSE4.2, with the crc32 instruction.  Size is in octets.
+	const size_t blockSizes[] = { 16, 64, 256, 1500 };
+	const unsigned long long targetBytes = 200000000;
+	std::vector<unsigned char> block(1500);
+	for (size_t i = 0; i < block.size(); i++)
+		block[i] = (unsigned char)(i * 31 + 7);
+
+	for (size_t blockSize : blockSizes)
+	{
+		unsigned long long ops = targetBytes / blockSize;
+		unsigned long check = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned long long op = 0; op < ops; op++)
+			check = Crc32c::computeTable(block.data(), blockSize, check);
+		report("crc32c table", blockSize, nsPerOp(start, ops));
+
+		if (Crc32c::hardwareAvailable())
+		{
+			unsigned long hwCheck = 0;
+			start = std::chrono::steady_clock::now();
+			for (unsigned long long op = 0; op < ops; op++)
+				hwCheck = Crc32c::computeHardware(block.data(), blockSize, hwCheck);
+			report("crc32c sse4.2", blockSize, nsPerOp(start, ops));
+			if (hwCheck != check)
+				SimLog::logFile << "    crc32c sse4.2 and table results differ" << endl;
+		}
+	}
+}
+
+void Benchmark::traceRecord()
+{
+	//  Cost of one Trace::record call with tracing off, and with tracing on (including the amortized cost of
+	//     flushing full thread buffers to the mapped trace file).  Size is the number of events recorded.
+	const unsigned long long ops = 4000000;
+	const std::string fileName = "benchmark.trace";
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned long long op = 0; op < ops; op++)
+		Trace::record(TRACE_LLDP_RX_STATE, 0x24a60b000000, (uint16_t)(op & 7), 0, (uint32_t)op & 0xf, (uint32_t)(op + 1) & 0xf);
+	report("trace off", ops, nsPerOp(start, ops));
+
+	if (Trace::open(fileName, (size_t)ops))
+	{
+		start = std::chrono::steady_clock::now();
+		for (unsigned long long op = 0; op < ops; op++)
+			Trace::record(TRACE_LLDP_RX_STATE, 0x24a60b000000, (uint16_t)(op & 7), 0, (uint32_t)op & 0xf, (uint32_t)(op + 1) & 0xf);
+		report("trace on", ops, nsPerOp(start, ops));
+		Trace::close();
+		std::remove(fileName.c_str());
+	}
+	else
+		SimLog::logFile << "    trace benchmark could not create " << fileName << endl;
+}
+
+void Benchmark::bridgeForwarding()
+{
+	//  Frames between end stations attached to the ports of a 48 port Bridge, one ingress Frame per port per run.
+	//     "bridge forward" frames go to stations the Bridge has learned (one egress Frame each);  "bridge flood"
+	//     frames go to stations that never transmit, so every Frame is flooded (47 egress Frames each, as every
+	//     Frame was before the Bridge learned addresses).  Size is the number of end stations.
+	const unsigned short nPorts = 48;
+	const unsigned int stationCounts[] = { 48, 480, 4800, 48000 };
+	const unsigned long long targetFrames = 2000000;
+	int savedDebug = SimLog::Debug;
+	SimLog::Debug = LOG_RESULT;                     // Otherwise tracing each flooded Frame copy dominates
+	SimLog::Time = 0;
+
+	for (unsigned int stationCount : stationCounts)
+	{
+		for (int flood = 0; flood < 2; flood++)
+		{
+			Bridge bridge(0xff, 0, nPorts);
+			std::vector<shared_ptr<BenchSap>> saps;
+			for (unsigned short p = 0; p < nPorts; p++)
+			{
+				saps.push_back(make_shared<BenchSap>(defaultBrdgAddr + 0xff0000 + p));
+				bridge.bPorts[p]->pIss = saps.back();
+			}
+			auto station = [](unsigned long long i) { return (defaultEndStnAddr + i); };   // Station i is on port i % nPorts
+			unsigned long long unknown = (flood ? 0x800000 : 0);
+
+			for (unsigned int i = 0; i < stationCount; i += nPorts)       // Every station announces itself
+			{
+				for (unsigned short p = 0; p < nPorts; p++)
+					saps[p]->pIngress = make_unique<Frame>(defaultDA, station(i + p), nullptr);
+				bridge.run(true);
+			}
+
+			unsigned long long runs = std::max(targetFrames / (flood ? 20 : 1) / nPorts, (unsigned long long)1);
+			unsigned long long before = 0;
+			for (auto& pSap : saps)
+				before += pSap->transmitted;
+			unsigned long long seed = 0x9e3779b97f4a7c15ULL;
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned long long run = 0; run < runs; run++)
+			{
+				for (unsigned short p = 0; p < nPorts; p++)
+				{
+					seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+					unsigned long long src = (((seed >> 33) % (stationCount / nPorts)) * nPorts) + p;
+					unsigned long long dst = (seed >> 17) % stationCount;
+					saps[p]->pIngress = make_unique<Frame>(station(dst + unknown), station(src), nullptr);
+				}
+				bridge.run(true);
+			}
+			double ns = nsPerOp(start, runs * nPorts);
+			report(flood ? "bridge flood" : "bridge forward", stationCount, ns);
+
+			unsigned long long after = 0;
+			for (auto& pSap : saps)
+				after += pSap->transmitted;
+			if (!flood && (after - before > runs * nPorts))
+				SimLog::logFile << "    bridge forwarding flooded " << (after - before - runs * nPorts) << " extra frames" << endl;
+		}
+	}
+	SimLog::Debug = savedDebug;
+}
+
+void Benchmark::vlanFlooding()
+{
+	//  Flooding in a VLAN-aware 48 port Bridge with many VLANs, each with 4 member ports, so each flooded Frame is
+	//     replicated to the 3 other members of its VLAN rather than to all 47 other ports.  Frames arrive tagged.
+	//     "vlan flood" transmits them tagged (no tag change);  "vlan flood untag" transmits them untagged, which pops
+	//     the tag once per flooded Frame.  Size is the number of VLANs.
+	const unsigned short nPorts = 48;
+	const unsigned short members = 4;
+	const unsigned int vlanCounts[] = { 48, 480, 4080 };
+	const unsigned long long targetFrames = 2000000;
+	int savedDebug = SimLog::Debug;
+	SimLog::Debug = LOG_RESULT;
+	SimLog::Time = 0;
+
+	for (unsigned int vlanCount : vlanCounts)
+	{
+		for (int untag = 0; untag < 2; untag++)
+		{
+			Bridge bridge(0xff, 0, nPorts);
+			bridge.vlanType = CVlanEthertype;
+			std::vector<shared_ptr<BenchSap>> saps;
+			for (unsigned short p = 0; p < nPorts; p++)
+			{
+				saps.push_back(make_shared<BenchSap>(defaultBrdgAddr + 0xff0000 + p));
+				bridge.bPorts[p]->pIss = saps.back();
+			}
+			std::vector<shared_ptr<Sdu>> tags;                   // VLAN i (VID i + 2) has member ports i to i + 3
+			for (unsigned int i = 0; i < vlanCount; i++)
+			{
+				unsigned short vid = (unsigned short)(i + 2);
+				for (unsigned short k = 0; k < members; k++)
+					bridge.setVlanMembership((unsigned short)((i + k) % nPorts), vid, true, (untag != 0));
+				tags.push_back(FramePool::makeSdu<VlanTag>(CVlanEthertype, vid));
+			}
+
+			unsigned long long runs = std::max(targetFrames / 4 / nPorts, (unsigned long long)1);
+			unsigned long long before = 0;
+			for (auto& pSap : saps)
+				before += pSap->transmitted;
+			unsigned long long seed = 0x9e3779b97f4a7c15ULL;
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned long long run = 0; run < runs; run++)
+			{
+				for (unsigned short p = 0; p < nPorts; p++)
+				{
+					seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+					unsigned long long i = (((seed >> 33) % (vlanCount / nPorts)) * nPorts) + p;   // A VLAN of port p
+					saps[p]->pIngress = make_unique<Frame>(defaultEndStnAddr + 0x800000, defaultEndStnAddr + p, tags[i]);
+				}
+				bridge.run(true);
+			}
+			double ns = nsPerOp(start, runs * nPorts);
+			report(untag ? "vlan flood untag" : "vlan flood", vlanCount, ns);
+
+			unsigned long long after = 0;
+			for (auto& pSap : saps)
+				after += pSap->transmitted;
+			if (after - before != runs * nPorts * (members - 1))
+				SimLog::logFile << "    vlan flooding sent " << (after - before) << " frames, expected "
+				                << (runs * nPorts * (members - 1)) << endl;
+		}
+	}
+	SimLog::Debug = savedDebug;
+}
+
+bool Benchmark::scenario(const std::string& spec, unsigned int threads)
+{
+	//  Builds the network described by spec, connects its links at the start of the run (as Topology::schedule does
+	//     for a topology file), and runs it to the end time.  Frames counts Frames delivered over all links.
+	//     Memory is the growth in the working set from before the build to the end of the run, with free heap memory
+	//     trimmed first, so it is this scenario's own rather than the high-water mark of the process.
+	int savedDebug = SimLog::Debug;
+	SimLog::Debug = LOG_RESULT;                     // Otherwise logging every LLDPDU dominates
+	std::vector<unique_ptr<Device>> Devices;
+	Topology topology(Devices);
+	trimMemory();
+	size_t baseMemoryKB = residentMemoryKB();
+
+	auto start = std::chrono::steady_clock::now();
+	if (!topology.generate(spec))
+	{
+		cout << "    scenario " << spec << ":  " << topology.getError() << endl;
+		SimLog::logFile << "    scenario " << spec << ":  " << topology.getError() << endl;
+		SimLog::Debug = savedDebug;
+		return (false);
+	}
+	double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (auto& pDev : Devices)
+		pDev->reset();
+	EventScheduler sim(Devices);
+	sim.setThreads(threads);
+	int startTime = SimLog::Time;
+	topology.schedule(sim, startTime);
+
+	start = std::chrono::steady_clock::now();
+	sim.run(startTime + topology.get_endTime());
+	double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (runSeconds <= 0.0)
+		runSeconds = 1e-9;
+
+	unsigned long long frames = 0;
+	for (auto& pDev : Devices)
+		for (auto& pMac : pDev->pMacs)
+			frames += pMac->getLinkStats().frames;
+	int ticks = SimLog::Time - startTime;
+	size_t memoryKB = residentMemoryKB();
+	memoryKB = (memoryKB > baseMemoryKB) ? (memoryKB - baseMemoryKB) : 0;
+
+	std::ostringstream line;
+	line << "    " << std::left << std::setw(32) << spec << std::right
+		<< std::setw(8) << topology.getDeviceCount() << " devices" << std::setw(8) << topology.getLinkCount() << " links"
+		<< std::fixed << std::setprecision(3) << std::setw(9) << buildSeconds << " s build"
+		<< std::setw(9) << runSeconds << " s run" << std::setprecision(0)
+		<< std::setw(10) << (ticks / runSeconds) << " ticks/s" << std::setw(12) << (frames / runSeconds) << " frames/s"
+		<< std::setw(9) << (memoryKB / 1024) << " MB added";
+	cout << line.str() << endl;
+	SimLog::logFile << line.str() << endl;
+
+	Devices.clear();                                // While logging is still quiet
+	SimLog::Debug = savedDebug;
+	return (true);
+}
+
+void Benchmark::scenarios(unsigned int threads)
+{
+	const char* specs[] = { "fattree", "torus2d", "torus3d", "ring", "star", "random" };
+
+	cout << endl << "   Scenarios (" << threads << " threads):  " << endl << endl;
+	SimLog::logFile << endl << "   Scenarios (" << threads << " threads):  " << endl << endl;
+	for (const char* spec : specs)
+		scenario(spec, threads);
+}
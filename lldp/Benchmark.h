@@ -0,0 +1,58 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <chrono>
+#include "LldpPort.h"
+#include "Crc32c.h"
+#include "Trace.h"
+#include "Bridge.h"
+#include "Topology.h"
+
+/*
+*   Class Benchmark times pieces of the simulation in isolation, so the cost of an operation can be measured as the
+*      thing it depends on (e.g. number of neighbors) grows.  Run with "-bench" on the command line;  results
+*      are written to cout and to the log file.  The lldpbench program has the microbenchmarks of the LLDP
+*      routines themselves, with repetition and JSON output.
+*   Benchmark is a friend of LldpPort so it can exercise the neighbor MIB without going through the state machines
+*      (which would make the log output dominate the measurement).
+*   A scenario builds a whole network with one of the Topology generators and runs it, reporting the time to build it,
+*      the simulated ticks and delivered Frames per second of wall time, and the memory it added.  Run with
+*      "-scenario SPEC" (SPEC as for Topology::generate) or "-scenario all" for every generator at its default size.
+*      Memory added is the working set at the end of the run less the working set before the build (after free heap
+*      memory is released), so each scenario reports its own figure rather than the process high water mark.
+*/
+
+class Benchmark
+{
+public:
+	static void run();
+
+	static void nborLookup();
+	static void xpduCheck();
+	static void traceRecord();
+	static void bridgeForwarding();
+	static void vlanFlooding();
+
+	static bool scenario(const std::string& spec, unsigned int threads = 1);
+	static void scenarios(unsigned int threads = 1);
+
+private:
+	static double nsPerOp(std::chrono::steady_clock::time_point start, unsigned long long ops);
+	static void report(const std::string& name, unsigned long long size, double ns);
+	static void trimMemory();                            // Release free heap memory from the working set
+	static size_t residentMemoryKB();                    // Current working set (0 if not known)
+};
@@ -18,15 +18,19 @@ limitations under the License.
 #include "Bridge.h"
 
 
-Bridge::Bridge(unsigned short devNum, unsigned short sysNum, int nPorts)
+Bridge::Bridge(unsigned int devNum, unsigned short sysNum, int nPorts)
 	: Component(ComponentTypes::BRIDGE)
 {
 	vlanType = 0;   // Type = 0 means MAC Bridge.  Can change to CVlanEthertype or SVlanEthertype
-	SystemId.id = defaultBrdgAddr + (0x10000 * devNum) + (0x1000 * sysNum);
+	SystemId.id = deviceAddress(defaultBrdgAddr, devNum) + (0x1000 * sysNum);
 
+	bPorts.reserve(nPorts);
+	allPorts.reserve(nPorts);
 	for (int i = 0; i < nPorts; i++)
 	{
 		bPorts.push_back(make_unique<BridgePort>());
+		allPorts.push_back((unsigned short)i);
+		setVlanMembership((unsigned short)i, DefaultPvid, true, true);
 	}
 //	cout << "Bridge Constructor called:  BridgePort count = " << bPorts.size() << endl;
 }
@@ -40,7 +44,7 @@ Bridge::~Bridge()
 
 void Bridge::reset()
 {
-	//TODO:
+	fdb.clear();
 }
 
 
@@ -53,37 +57,208 @@ void Bridge::timerTick()
 }
 
 
+void Bridge::advanceTimers(int /* ticks */)
+{
+	// No timers
+}
+
+int Bridge::nextEventTime() const
+{
+	// Bridge only acts on frames at its ports, which the service providers (e.g. Mac, LLDP shim) account for
+	return (SimTimeNever);
+}
+
+
 void Bridge::run(bool singleStep)
 {
 	if (!suspended)
 	{
-		for (auto& ingress : bPorts)                            // For each BridgePort that may have an ingress Frame
+		unsigned short nPorts = (unsigned short)bPorts.size();
+		for (unsigned short in = 0; in < nPorts; in++)         // For each BridgePort that may have an ingress Frame
 		{
+			BridgePort& ingress = *bPorts[in];
 			unique_ptr<Frame> thisFrame = nullptr;              //      Check for an ingress Frame
-			if (ingress->pIss)
+			if (ingress.pIss)
+			{
+				thisFrame = std::move(ingress.pIss->Indication());
+			}
+			if (!thisFrame ||                                            // If no ingress frame
+				(thisFrame->MacDA == ingress.pIss->getMacAddress()) ||   //    or destined to this ingress port
+				isReservedAddress(thisFrame->MacDA))                     //    or to a reserved address, then discard
+				//TODO: Consider case where port has multiple address (LAG)
+				continue;
+
+			unsigned short vid = 0;
+			if (vlanType != 0)                                  // VLAN-aware, so classify the Frame to a VLAN
 			{
-				thisFrame = std::move(ingress->pIss->Indication());
+				vid = ingress.pvid;
+				if (thisFrame->getNextEtherType() == vlanType)
+				{
+					const VlanTag& tag = VlanTag::getVlanTag(*thisFrame);
+					thisFrame->Priority = tag.Vtag.pri;
+					thisFrame->DropEligible = tag.Vtag.de;
+					if (tag.Vtag.id != 0)                       //    A priority tagged Frame gets the PVID
+						vid = tag.Vtag.id;
+				}
+				if (!ingress.memberSet[vid])                    //    Ingress filtering
+					continue;
 			}
-			if ((thisFrame) &&                                           // If there is an ingress frame
-				(thisFrame->MacDA != ingress->pIss->getMacAddress()))    //    not destined to this ingress port
-				//TODO: Need to do other address filtering here.  Consider case where port has multiple address (LAG)
-				//  and at least filter 802.1 reserved addresses
+			thisFrame->VlanIdentifier = vid;
+
+			fdb.learn(vid, thisFrame->MacSA, in, SimLog::Time);
+			unsigned short out = FilteringDatabase::NoPort;
+			if (!FilteringDatabase::isGroupAddress(thisFrame->MacDA))
+				out = fdb.lookup(vid, thisFrame->MacDA, SimLog::Time);
+
+			if (out == in)                                      // Destination is on the ingress side, so filter
+				continue;
+			if ((out != FilteringDatabase::NoPort) && (out < nPorts) && isEgressPort(out, vid))
 			{
-				for (auto& egress : bPorts)
+				transmit(out, std::move(thisFrame));            // Known destination, so forward on that port only
+				continue;
+			}
+
+			const std::vector<unsigned short>& floodSet = getFloodSet(vid);
+			unique_ptr<Frame> reformatted[2];                   // Copies with the egress tag format (untagged, tagged)
+			unsigned short lastEgress = FilteringDatabase::NoPort;   // Flood to every other operational member of the VLAN,
+			for (unsigned short egress : floodSet)                    //    sending the original frame on the last one
+			{
+				if ((egress != in) && isEgressPort(egress, vid))
 				{
-					if ((ingress != egress) &&
-						egress->pIss && egress->pIss->getOperational())  // Then at every other operational BridgePort
-					{
-						unique_ptr<Frame> frameCopy = make_unique<Frame>(*thisFrame);  // Transmit a copy of the frame
-						egress->pIss->Request(move(frameCopy));
-					}
+					if (lastEgress != FilteringDatabase::NoPort)
+						transmitCopy(lastEgress, *thisFrame, reformatted);
+					lastEgress = egress;
 				}
 			}
+			if (lastEgress != FilteringDatabase::NoPort)
+				transmit(lastEgress, std::move(thisFrame));
+		}
+	}
+}
+
+
+bool Bridge::isEgressPort(unsigned short port, unsigned short vid) const
+{
+	const BridgePort& egress = *bPorts[port];
+	return (egress.pIss && egress.pIss->getOperational() && ((vlanType == 0) || egress.memberSet[vid]));
+}
+
+bool Bridge::isTaggedEgress(unsigned short port, unsigned short vid) const
+{
+	return ((vlanType != 0) && !bPorts[port]->untaggedSet[vid]);
+}
+
+bool Bridge::needsTagChange(const Frame& thisFrame, bool tagged) const
+{
+	if (vlanType == 0)
+		return (false);
+	if (thisFrame.getNextEtherType() != vlanType)       // Arrived untagged (or with a tag of another type)
+		return (tagged);
+	return (!tagged || (((const VlanTag&)thisFrame.getNextSdu()).Vtag.id != thisFrame.VlanIdentifier));
+}
+
+void Bridge::setTagFormat(Frame& thisFrame, bool tagged) const
+{
+	if (needsTagChange(thisFrame, tagged))
+	{
+		if (thisFrame.getNextEtherType() == vlanType)   // Remove the received tag (which may be a priority tag)
+			thisFrame.PopTag();
+		if (tagged)
+			thisFrame.PushTag(FramePool::makeSdu<VlanTag>(vlanType, thisFrame.VlanIdentifier,
+				thisFrame.Priority, thisFrame.DropEligible));
+	}
+}
+
+void Bridge::transmit(unsigned short port, unique_ptr<Frame> thisFrame)
+{
+	if (vlanType != 0)
+	{
+		setTagFormat(*thisFrame, isTaggedEgress(port, thisFrame->VlanIdentifier));
+		thisFrame->VlanIdentifier = 0;                  // Frames at an ISS have no VLAN_identifier
+	}
+	bPorts[port]->pIss->Request(std::move(thisFrame));
+}
+
+void Bridge::transmitCopy(unsigned short port, const Frame& thisFrame, unique_ptr<Frame> reformatted[2])
+{
+	const Frame* pSource = &thisFrame;
+	if (vlanType != 0)
+	{
+		bool tagged = isTaggedEgress(port, thisFrame.VlanIdentifier);
+		if (needsTagChange(thisFrame, tagged))
+		{
+			if (!reformatted[tagged])                   // First port needing this format, so change the tag once
+			{                                           //    and copy the result for this and later ports
+				reformatted[tagged] = make_unique<Frame>(thisFrame);
+				setTagFormat(*reformatted[tagged], tagged);
+			}
+			pSource = reformatted[tagged].get();
 		}
 	}
+	unique_ptr<Frame> pCopy = make_unique<Frame>(*pSource);
+	pCopy->VlanIdentifier = 0;                          // Frames at an ISS have no VLAN_identifier
+	bPorts[port]->pIss->Request(std::move(pCopy));
 }
 
 
+void Bridge::setVlanMembership(unsigned short port, unsigned short vid, bool member, bool untagged)
+{
+	if ((port >= bPorts.size()) || (vid == 0) || (vid >= VlanIdCount - 1))
+		return;
+
+	BridgePort& bPort = *bPorts[port];
+	bPort.untaggedSet.set(vid, member && untagged);
+	if (bPort.memberSet[vid] == member)
+		return;
+	bPort.memberSet.set(vid, member);
+
+	std::vector<unsigned short>& floodSet = floodSets[vid];     // Kept in port order so flooding order matches
+	auto pos = std::lower_bound(floodSet.begin(), floodSet.end(), port);
+	if (member)
+		floodSet.insert(pos, port);
+	else
+		floodSet.erase(pos);
+	if (floodSet.empty())
+		floodSets.erase(vid);
+}
+
+bool Bridge::isVlanMember(unsigned short port, unsigned short vid) const
+{
+	return ((port < bPorts.size()) && (vid < VlanIdCount) && bPorts[port]->memberSet[vid]);
+}
+
+bool Bridge::isVlanUntagged(unsigned short port, unsigned short vid) const
+{
+	return ((port < bPorts.size()) && (vid < VlanIdCount) && bPorts[port]->untaggedSet[vid]);
+}
+
+void Bridge::set_pvid(unsigned short port, unsigned short vid)
+{
+	if ((port < bPorts.size()) && (vid != 0) && (vid < VlanIdCount - 1))
+		bPorts[port]->pvid = vid;
+}
+
+unsigned short Bridge::get_pvid(unsigned short port) const
+{
+	return ((port < bPorts.size()) ? bPorts[port]->pvid : 0);
+}
+
+const std::vector<unsigned short>& Bridge::getFloodSet(unsigned short vid) const
+{
+	static const std::vector<unsigned short> noPorts;
+
+	if (vlanType == 0)
+		return (allPorts);
+	auto it = floodSets.find(vid);
+	return ((it == floodSets.end()) ? noPorts : it->second);
+}
+
+
+bool Bridge::isReservedAddress(unsigned long long mac)
+{
+	return ((mac & ~0xfULL) == (unsigned long long)NearestCustomerBridgeDA);   // 01-80-C2-00-00-00 to -0F
+}
+
 
 /**/
 
@@ -91,6 +266,7 @@ void Bridge::run(bool singleStep)
 BridgePort::BridgePort()
 {
 	pIss = nullptr;
+	pvid = Bridge::DefaultPvid;
 
 //	cout << "    BridgePort Constructor called." << endl;
 //	SimLog::logFile << "    BridgePort Constructor called." << endl;
@@ -16,6 +16,40 @@ limitations under the License.
 
 #pragma once
 #include "Mac.h"
+#include "FilteringDatabase.h"
+#include <unordered_map>
+
+/*
+*   Class VlanSet is a set of VIDs held as a bitmap that only extends as far as the highest VID added to it, so a port
+*      that is only in low numbered VLANs (e.g. the default VLAN 1) costs one word rather than a bit for every VID.
+*/
+class VlanSet
+{
+public:
+	bool operator[] (unsigned short vid) const
+	{
+		size_t word = vid >> 6;
+		return ((word < bits.size()) && ((bits[word] >> (vid & 0x3f)) & 1));
+	}
+
+	void set(unsigned short vid, bool val)
+	{
+		size_t word = vid >> 6;
+		if (word >= bits.size())
+		{
+			if (!val)
+				return;
+			bits.resize(word + 1, 0);
+		}
+		if (val)
+			bits[word] |= (1ULL << (vid & 0x3f));
+		else
+			bits[word] &= ~(1ULL << (vid & 0x3f));
+	}
+
+private:
+	std::vector<unsigned long long> bits;
+};
 
 /*
 *   Class BridgePort is a "port" on a Bridge. A "port" is an interface pointing to an ISS Service Access Point.
@@ -34,6 +68,11 @@ public:
 
 	shared_ptr<Iss> pIss;
 
+	// VLAN configuration, only used when the Bridge is VLAN-aware (vlanType is non-zero)
+	unsigned short pvid;                      // Port VLAN Identifier assigned to untagged and priority tagged Frames
+	VlanSet memberSet;                        // VLANs for which this port is in the member set
+	VlanSet untaggedSet;                      // VLANs for which Frames are transmitted untagged on this port
+
 };
 /**/
 
@@ -41,8 +80,21 @@ public:
 *   Class Bridge is a system component that can be contained in a Device.
 *       A  Bridge has two or more BridgePorts.
 *
-*       Currently the Bridge is not VLAN-aware, and does not learn addresses, so it simply
-*           replicates a Frame received at one port to be transmitted on all other ports.
+*       The Bridge learns the source address of each received Frame in its FilteringDatabase, and forwards a Frame
+*           to a known individual destination on that one port.  A Frame for an unknown or group destination is
+*           flooded to every other operational port.  Frames for the IEEE 802.1 reserved addresses
+*           (01-80-C2-00-00-00 through 01-80-C2-00-00-0F) are filtered, never forwarded.
+*       If vlanType is zero the Bridge is not VLAN-aware (all Frames are learned and looked up with VID 0).
+*       If vlanType is CVlanEthertype or SVlanEthertype the Bridge is VLAN-aware:
+*           A Frame is assigned to the VLAN in a tag with that EtherType, or to the PVID of the ingress port if the
+*           Frame is untagged or priority tagged, and is discarded if the ingress port is not in that VLAN's member set.
+*           Learning and lookup use the VID (independent VLAN learning).  A Frame is forwarded or flooded only to
+*           ports in the member set of its VLAN, and each port's untagged set decides whether it is transmitted with
+*           or without a tag.  Each BridgePort holds its member and untagged sets as bitmaps indexed by VID, and the
+*           Bridge keeps the list of member ports of each VLAN (its flood set) so flooding visits only those ports.
+*           A tag is only pushed or popped when the egress port needs a different format than the Frame arrived with,
+*           and a forwarded (not flooded) Frame is changed in place rather than copied.
+*           By default every port has PVID 1 and is an untagged member of VLAN 1.
 *       Currently it does not implement any loop prevention protocols, so beware of
 *           generating data frames in a simulation with Bridges connected in a loop!
 */
@@ -50,7 +102,7 @@ public:
 class Bridge : public Component
 {
 public:
-	Bridge(unsigned short devNum = 0, unsigned short sysNum = 0, int nPorts = 8);
+	Bridge(unsigned int devNum = 0, unsigned short sysNum = 0, int nPorts = 8);
 	~Bridge();
 	Bridge(Bridge& copySource) = delete;             // Disable copy constructor
 	Bridge& operator= (const Bridge&) = delete;      // Disable assignment operator
@@ -58,11 +110,36 @@ public:
 	unsigned short vlanType;
 	sysId SystemId;
 	std::vector<unique_ptr<BridgePort>> bPorts;
+	FilteringDatabase fdb;
 
 	void reset();
 	void timerTick();
-	void run(bool singleStep);    // Receives a Frame from each BridgePort, replicates
-	                                    //     and transmits the Frame on all other BridgePorts
+	void advanceTimers(int ticks);
+	int nextEventTime() const;
+	void run(bool singleStep);    // Receives a Frame from each BridgePort, and forwards it to the learned
+	                              //     BridgePort for its destination or floods it to all other BridgePorts
+
+	void setVlanMembership(unsigned short port, unsigned short vid, bool member, bool untagged = false);
+	bool isVlanMember(unsigned short port, unsigned short vid) const;
+	bool isVlanUntagged(unsigned short port, unsigned short vid) const;
+	void set_pvid(unsigned short port, unsigned short vid);
+	unsigned short get_pvid(unsigned short port) const;
+	const std::vector<unsigned short>& getFloodSet(unsigned short vid) const;    // Member ports of a VLAN
+
+	static bool isReservedAddress(unsigned long long mac);
+
+	static const unsigned short DefaultPvid = 1;
+
+private:
+	std::unordered_map<unsigned short, std::vector<unsigned short>> floodSets;   // Member ports of each VLAN that has any
+	std::vector<unsigned short> allPorts;                                         // Flood set when not VLAN-aware
+
+	bool isEgressPort(unsigned short port, unsigned short vid) const;
+	bool isTaggedEgress(unsigned short port, unsigned short vid) const;
+	bool needsTagChange(const Frame& thisFrame, bool tagged) const;
+	void setTagFormat(Frame& thisFrame, bool tagged) const;
+	void transmit(unsigned short port, unique_ptr<Frame> thisFrame);
+	void transmitCopy(unsigned short port, const Frame& thisFrame, unique_ptr<Frame> reformatted[2]);
 
 };
 /**/
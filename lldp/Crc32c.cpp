@@ -0,0 +1,121 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include <cstring>
+#include "Crc32c.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <nmmintrin.h>
+#define CRC32C_X86
+#define CRC32C_TARGET_SSE42
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <nmmintrin.h>
+#define CRC32C_X86
+#define CRC32C_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+
+
+const unsigned long Crc32cPolynomial = 0x82f63b78;      // Castagnoli polynomial, bit reversed
+
+struct Crc32cTable
+{
+	unsigned long entry[256];
+
+	Crc32cTable()
+	{
+		for (unsigned long i = 0; i < 256; i++)
+		{
+			unsigned long crc = i;
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc & 1) ? ((crc >> 1) ^ Crc32cPolynomial) : (crc >> 1);
+			entry[i] = crc;
+		}
+	}
+};
+
+static bool detectHardware()
+{
+#if defined(CRC32C_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return ((info[2] & (1 << 20)) != 0);                // ECX bit 20 is SSE4.2
+#elif defined(CRC32C_X86)
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return (false);
+	return ((ecx & bit_SSE4_2) != 0);
+#else
+	return (false);
+#endif
+}
+
+
+unsigned long Crc32c::compute(const unsigned char* pData, size_t length, unsigned long crc)
+{
+	static const bool useHardware = hardwareAvailable();
+	return (useHardware ? computeHardware(pData, length, crc) : computeTable(pData, length, crc));
+}
+
+unsigned long Crc32c::computeTable(const unsigned char* pData, size_t length, unsigned long crc)
+{
+	static const Crc32cTable table;
+	unsigned long c = ~crc & 0xffffffff;
+	for (size_t i = 0; i < length; i++)
+		c = table.entry[(c ^ pData[i]) & 0xff] ^ (c >> 8);
+	return (~c & 0xffffffff);
+}
+
+#ifdef CRC32C_X86
+CRC32C_TARGET_SSE42 unsigned long Crc32c::computeHardware(const unsigned char* pData, size_t length, unsigned long crc)
+{
+	size_t i = 0;
+#if defined(_M_X64) || defined(__x86_64__)
+	unsigned long long c = ~crc & 0xffffffff;
+	for (; i + 8 <= length; i += 8)
+	{
+		unsigned long long word;
+		memcpy(&word, pData + i, 8);
+		c = _mm_crc32_u64(c, word);
+	}
+	unsigned int c32 = (unsigned int)c;
+#else
+	unsigned int c32 = ~crc & 0xffffffff;
+	for (; i + 4 <= length; i += 4)
+	{
+		unsigned int word;
+		memcpy(&word, pData + i, 4);
+		c32 = _mm_crc32_u32(c32, word);
+	}
+#endif
+	for (; i < length; i++)
+		c32 = _mm_crc32_u8(c32, pData[i]);
+	return (~c32 & 0xffffffff);
+}
+#else
+unsigned long Crc32c::computeHardware(const unsigned char* pData, size_t length, unsigned long crc)
+{
+	return (computeTable(pData, length, crc));
+}
+#endif
+
+bool Crc32c::hardwareAvailable()
+{
+	static const bool available = detectHardware();
+	return (available);
+}
@@ -0,0 +1,34 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <cstddef>
+
+/*
+*   Class Crc32c computes the CRC-32C (Castagnoli) of a block of octets, as used for XPDU check values.
+*   compute() uses the SSE4.2 crc32 instruction when the processor has it, and otherwise a table driven
+*      calculation that gives the same result.  Passing the result of one call as crc to the next continues the
+*      CRC over the concatenated blocks, so the check of an XPDU can be built one TLV at a time.
+*/
+
+class Crc32c
+{
+public:
+	static unsigned long compute(const unsigned char* pData, size_t length, unsigned long crc = 0);
+	static unsigned long computeTable(const unsigned char* pData, size_t length, unsigned long crc = 0);
+	static unsigned long computeHardware(const unsigned char* pData, size_t length, unsigned long crc = 0);  // Only if hardwareAvailable()
+	static bool hardwareAvailable();
+};
@@ -25,7 +25,7 @@ limitations under the License.
 
 
 
-unsigned short Device::devCnt = 0;
+unsigned int Device::devCnt = 0;
 
 Device::Device(int numMacs)	
 	: Component(ComponentTypes::DEVICE)
@@ -58,12 +58,12 @@ Device::~Device()
 	//	cout << "Device Destructor called." << endl;
 }
 
-unsigned short Device::getDeviceCount()
+unsigned int Device::getDeviceCount()
 {
 	return (devCnt);
 }
 
-unsigned short Device::getDeviceNumber()
+unsigned int Device::getDeviceNumber()
 {
 	return (devNum);
 }
@@ -110,6 +110,38 @@ void Device::run(bool singleStep)                 // If not suspended, Make one
 	}
 }
 
+void Device::advanceTimers(int ticks)            // If not suspended, Tick timers in all Components and Macs the given number of times
+{
+	if (!suspended && (ticks > 0))
+	{
+		for (auto& pComp : pComponents)
+		{
+			pComp->advanceTimers(ticks);
+		}
+		for (auto& pMac : pMacs)
+		{
+			pMac->advanceTimers(ticks);
+		}
+	}
+}
+
+int Device::nextEventTime() const                 // Earliest nextEventTime() of all Components and Macs
+{
+	int next = SimTimeNever;
+	if (!suspended)
+	{
+		for (auto& pComp : pComponents)
+		{
+			next = std::min(next, pComp->nextEventTime());
+		}
+		for (auto& pMac : pMacs)
+		{
+			next = std::min(next, pMac->nextEventTime());
+		}
+	}
+	return (next);
+}
+
 void Device::transmit()                           // If not suspended, Transmit a Frame from any Macs in Device with a Frame ready to transmit
 {
 	for (auto& pMac : pMacs)
@@ -199,7 +231,7 @@ void Device::createBridge(unsigned short type, string sysName, string sysDesc)
 		}
 		pLldpPort->set_portDescription(portAnimal);
 
-		pLLDP->pLldpPorts.push_back(pLldpPort);                            // Put LLDP instance in the Device's LLDP shim
+		pLLDP->addPort(pLldpPort);                                         // Put LLDP instance in the Device's LLDP shim
 	}
 	/**/
 
@@ -250,6 +282,12 @@ void Device::createEndStation(string sysName, string sysDesc)
 	} 
 	*/
 
+	if (nPorts > 0)                                       // Without the Lag shim only the first Mac can be used
+	{
+		pStation->pIss = pMacs[0];                        // Attach the first Mac to the End Station
+		pMacs[0]->updateMacSystemId(pStation->SystemId.id);
+	}
+
 	pComponents.push_back(move(pStation));                            // Put the End Station in the Device Components vector
 	// pComponents.push_back(move(pLag));                                // Put the Link Aggregation shim in the Device Components vector
 	/**/
@@ -257,10 +295,10 @@ void Device::createEndStation(string sysName, string sysDesc)
 
 
 
-EndStn::EndStn(unsigned short devNum, unsigned short sysNum)
+EndStn::EndStn(unsigned int devNum, unsigned short sysNum)
 	: Component(ComponentTypes::END_STATION)
 {
-	SystemId.id = defaultEndStnAddr + (0x10000 * devNum) + (0x1000 * sysNum);
+	SystemId.id = deviceAddress(defaultEndStnAddr, devNum) + (0x1000 * sysNum);
 	sequenceNumber = 0;
 	rxFrameCount = 0;
 	pIss = nullptr;
@@ -300,6 +338,17 @@ void EndStn::timerTick()
 	}
 }
 
+void EndStn::advanceTimers(int /* ticks */)
+{
+	// No timers
+}
+
+int EndStn::nextEventTime() const
+{
+	// End Station only acts on frames at its ISS, which the service provider (e.g. Mac) accounts for
+	return (SimTimeNever);
+}
+
 
 void EndStn::run(bool singleStep)
 {
@@ -311,7 +360,7 @@ void EndStn::run(bool singleStep)
 		{
 			rxFrameCount++;
 
-			if (SimLog::Debug > 5)
+			if (SIM_LOG_ENABLED(LOG_EVENT, LOG_FRAME))
 			{
 				SimLog::logFile << "Time " << SimLog::Time << "    EndStation " << hex << SystemId.addr << " received frame ";
 				pFrame->PrintFrameHeader();
@@ -338,7 +387,7 @@ void EndStn::generateTestFrame(shared_ptr<Sdu> pTag)
 	if (pIss->getOperational())  // Transmit frame only if MAC won't immediately discard
 	{
 		unsigned long long thisSA = SystemId.addr;
-		shared_ptr<Sdu> thisSdu = std::make_shared<TestSdu>(sequenceNumber);
+		shared_ptr<Sdu> thisSdu = FramePool::makeSdu<TestSdu>(sequenceNumber);
 		unique_ptr<Frame> thisFrame = make_unique<Frame>(defaultDA, thisSA, thisSdu);
 //		unique_ptr<Frame> thisFrame = make_unique<Frame>(defaultDA, SystemId.addr, thisSdu);  // Why won't SystemId.addr work?
 		if (pTag) 
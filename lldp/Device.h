@@ -35,7 +35,7 @@ using namespace std;
 class EndStn : public Component
 {
 public:
-	EndStn(unsigned short devNum, unsigned short sysNum);
+	EndStn(unsigned int devNum, unsigned short sysNum);
 	~EndStn();
 	EndStn(EndStn& copySource) = delete;             // Disable copy constructor
 	EndStn& operator= (const EndStn&) = delete;      // Disable assignment operator
@@ -47,6 +47,8 @@ public:
 	void reset();
 	void timerTick();
 	void run(bool singleStep);
+	void advanceTimers(int ticks);
+	int nextEventTime() const;
 
 	void generateTestFrame(shared_ptr<Sdu> pTag = nullptr);
 
@@ -73,8 +75,8 @@ public:
 	Device(Device& copySource) = delete;             // Disable copy constructor
 	Device& operator= (const Device&) = delete;      // Disable assignment operator
 
-	static unsigned short getDeviceCount();
-	unsigned short getDeviceNumber();
+	static unsigned int getDeviceCount();
+	unsigned int getDeviceNumber();
 
 	std::vector<unique_ptr<Component>> pComponents;
 	std::vector<shared_ptr<Mac>> pMacs;
@@ -90,6 +92,8 @@ public:
 	       //   Should I add a restoreDefault() routine?
 	virtual void timerTick() override;                     // If not suspended, Tick timers in all Components and Macs
 	virtual void run(bool singleStep) override;            // If not suspended, Make one or more pass through all state machines in all Components and Macs
+	virtual void advanceTimers(int ticks) override;        // If not suspended, Tick timers in all Components and Macs the given number of times
+	virtual int nextEventTime() const override;            // Earliest nextEventTime() of all Components and Macs
 
 	void transmit();                      // If not suspended, Transmit a Frame from any Macs in Device with a Frame ready to transmit
 	void disconnect();                    // Disconnect all Macs in the Device that are connected to other Macs
@@ -98,8 +102,8 @@ public:
 	void createEndStation(string sysName = "", string sysDesc = "");                          // Helper function for creating a Device with a single End Station Component
 
 protected:
-	static unsigned short devCnt;
-	unsigned short devNum;
+	static unsigned int devCnt;
+	unsigned int devNum;
 
 };
 /**/
@@ -0,0 +1,297 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "EventScheduler.h"
+
+
+bool SimEvent::operator> (const SimEvent& other) const
+{
+	return ((time > other.time) || ((time == other.time) && (sequence > other.sequence)));
+}
+
+
+EventScheduler::EventScheduler(std::vector<unique_ptr<Device>>& devices)
+	: Devices(devices)
+{
+	sequence = 0;
+	lockStep = false;
+	stepCount = 0;
+	deviceRunCount = 0;
+}
+
+EventScheduler::~EventScheduler()
+{
+}
+
+void EventScheduler::setLockStep(bool val)
+{
+	lockStep = val;
+	if (!lockStep)                                  // Nothing was scheduled while in lockstep, so make sure everything
+		for (size_t i = 0; i < wakeTime.size(); i++)    //    gets run (and so rescheduled) at the current time.
+			wake(i, SimLog::Time, SimEventTypes::TIMER_EXPIRY);
+}
+
+bool EventScheduler::getLockStep() const
+{
+	return (lockStep);
+}
+
+void EventScheduler::setThreads(unsigned int threads)
+{
+	if (threads > 1)
+		pPool = make_unique<WorkerPool>(threads);
+	else
+		pPool = nullptr;
+}
+
+unsigned int EventScheduler::getThreads() const
+{
+	return (pPool ? pPool->getThreadCount() : 1);
+}
+
+unsigned long long EventScheduler::getStepCount() const
+{
+	return (stepCount);
+}
+
+unsigned long long EventScheduler::getDeviceRunCount() const
+{
+	return (deviceRunCount);
+}
+
+void EventScheduler::schedule(int time, std::function<void()> action)
+{
+	actions.push_back(action);
+	push(std::max(time, SimLog::Time), SimEventTypes::ADMIN_ACTION, actions.size() - 1);
+}
+
+void EventScheduler::run(int endTime)
+{
+	attachDevices();
+
+	int time = SimLog::Time;
+	while (time < endTime)
+	{
+		if (!lockStep)                              // Jump to the time of the next event
+		{
+			if (events.empty())
+				break;
+			time = events.top().time;
+			if (time >= endTime)
+				break;
+		}
+		step(time);
+		time++;
+	}
+
+	synchronize(endTime - 1);                       // Leave all Device timers as if every tick had been run
+	SimLog::Time = endTime;
+}
+
+void EventScheduler::attachDevices()
+{
+	//  Pick up any Devices added since the last call.  A new Device starts out running at the current time.
+	size_t oldCount = wakeTime.size();
+	if (Devices.size() > oldCount)
+	{
+		wakeTime.resize(Devices.size(), SimTimeNever);
+		lastTick.resize(Devices.size(), SimLog::Time - 1);
+		isDue.resize(Devices.size(), false);
+		partnerWakes.resize(Devices.size());
+		while (devLog.size() < Devices.size())
+			devLog.push_back(make_unique<std::stringbuf>());
+		for (size_t i = oldCount; i < Devices.size(); i++)
+		{
+			unsigned int devNum = Devices[i]->getDeviceNumber();
+			if (devNum >= devIndex.size())
+				devIndex.resize(devNum + 1, Devices.size());
+			devIndex[devNum] = i;
+			wake(i, SimLog::Time, SimEventTypes::TIMER_EXPIRY);
+		}
+	}
+}
+
+void EventScheduler::push(int time, SimEventTypes type, size_t index)
+{
+	SimEvent event;
+	event.time = time;
+	event.sequence = sequence++;
+	event.type = type;
+	event.index = index;
+	events.push(event);
+}
+
+void EventScheduler::wake(size_t dev, int time, SimEventTypes type)
+{
+	//  Only need a new event if it is earlier than one already pending.  Later events left in the queue
+	//     are discarded when popped because they no longer match wakeTime.
+	if ((time != SimTimeNever) && (time < wakeTime[dev]) && !lockStep)
+	{
+		wakeTime[dev] = time;
+		push(time, type, dev);
+	}
+}
+
+void EventScheduler::synchronize(int time)
+{
+	for (size_t i = 0; i < Devices.size(); i++)
+	{
+		if (lastTick[i] < time)
+		{
+			Devices[i]->advanceTimers(time - lastTick[i]);
+			lastTick[i] = time;
+		}
+	}
+}
+
+void EventScheduler::step(int time)
+{
+	SimLog::Time = time;
+	stepCount++;
+
+	SIM_LOG(LOG_EVENT, LOG_SIM) << "*" << endl;
+
+	//  Collect everything due at this time
+	std::vector<size_t> dueActions;
+	dueDevices.clear();
+	while (!events.empty() && (events.top().time == time))
+	{
+		SimEvent event = events.top();
+		events.pop();
+		if (event.type == SimEventTypes::ADMIN_ACTION)
+			dueActions.push_back(event.index);
+		else if ((wakeTime[event.index] == time) && !isDue[event.index])
+		{
+			isDue[event.index] = true;
+			dueDevices.push_back(event.index);
+		}
+	}
+
+	//  Administrative actions happen before anything runs, and can affect any Device
+	if (!dueActions.empty())
+	{
+		synchronize(time - 1);
+		for (auto index : dueActions)
+		{
+			actions[index]();
+			actions[index] = nullptr;
+		}
+		attachDevices();
+	}
+	if (!dueActions.empty() || lockStep)
+	{
+		for (size_t i = 0; i < Devices.size(); i++)
+		{
+			if (!isDue[i])
+			{
+				isDue[i] = true;
+				dueDevices.push_back(i);
+			}
+		}
+	}
+	std::sort(dueDevices.begin(), dueDevices.end());    // Run in the same order as the lockstep loop
+
+	//  Run all state machines in due devices
+	if (pPool)
+		pPool->parallelFor(dueDevices.size(), [this](size_t k) { runDevice(dueDevices[k]); });
+	else
+		for (auto i : dueDevices)
+			runDevice(i);
+	deviceRunCount += dueDevices.size();
+	flushLogs();
+
+	//  Transmit from any MAC with frames to transmit.  Each Mac request queue has only its own Device as consumer
+	//     and each indication queue only its link partner as producer, so this can also run in parallel.
+	if (pPool)
+		pPool->parallelFor(dueDevices.size(), [this](size_t k) { transmitDevice(dueDevices[k]); });
+	else
+		for (auto i : dueDevices)
+			transmitDevice(i);
+	flushLogs();
+
+	//  Schedule the next time each Device needs to run
+	for (auto i : dueDevices)
+	{
+		isDue[i] = false;
+		wake(i, Devices[i]->nextEventTime(), SimEventTypes::TIMER_EXPIRY);
+	}
+	for (auto i : dueDevices)
+	{
+		for (auto partner : partnerWakes[i])
+			wake(partner, time + 1, SimEventTypes::FRAME_ARRIVAL);
+		partnerWakes[i].clear();
+	}
+}
+
+std::streambuf* EventScheduler::redirectLog(size_t dev)
+{
+	//  Send this thread's log messages to the Device buffer, starting with the same formatting no matter what
+	//     ran before in this thread.  Returns the buffer to restore afterwards.
+	std::ostream& log = SimLog::logFile;
+	log.flags(std::ios::dec | std::ios::skipws);
+	log.fill(' ');
+	log.precision(6);
+	log.width(0);
+	return (log.rdbuf(devLog[dev].get()));
+}
+
+void EventScheduler::runDevice(size_t dev)
+{
+	//  May be running in any thread.  Touches nothing outside the Device except its own entries in the per-Device vectors.
+	std::streambuf* pSavedBuf = redirectLog(dev);
+
+	wakeTime[dev] = SimTimeNever;
+	Devices[dev]->advanceTimers(SimLog::Time - lastTick[dev]);     // Catch up on skipped ticks and tick for this time
+	lastTick[dev] = SimLog::Time;
+	Devices[dev]->run(true);                                        // Run device with single-step true
+
+	SimLog::logFile.rdbuf(pSavedBuf);
+}
+
+void EventScheduler::transmitDevice(size_t dev)
+{
+	std::streambuf* pSavedBuf = redirectLog(dev);
+
+	Device& device = *Devices[dev];
+	if (!device.getSuspended())
+	{
+		for (auto& pMac : device.pMacs)
+		{
+			if (pMac->Transmit())                           // Partner Device needs to run on the next tick
+			{
+				shared_ptr<Mac> pPartner = pMac->getLinkPartner();
+				if (pPartner && (pPartner->getDevNum() < devIndex.size()) && (devIndex[pPartner->getDevNum()] < Devices.size()))
+					partnerWakes[dev].push_back(devIndex[pPartner->getDevNum()]);
+			}
+		}
+	}
+
+	SimLog::logFile.rdbuf(pSavedBuf);
+}
+
+void EventScheduler::flushLogs()
+{
+	for (auto i : dueDevices)
+	{
+		std::string text = devLog[i]->str();
+		if (!text.empty())
+		{
+			SimLog::logFile.write(text.data(), text.size());
+			devLog[i]->str(std::string());
+		}
+	}
+}
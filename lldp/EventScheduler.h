@@ -0,0 +1,101 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <functional>
+#include <sstream>
+#include <vector>
+#include "Device.h"
+#include "WorkerPool.h"
+
+/*
+*   Class EventScheduler runs the simulation by jumping from one time at which something can happen to the next,
+*      rather than stepping every Device through timerTick(), run() and transmit() on every value of SimLog::Time.
+*   Events are kept in a priority queue ordered by time (and by scheduling order within a time):
+*      -- ADMIN_ACTION:  an arbitrary action (e.g. Mac::Connect) supplied by the test.  Since an action can change
+*            anything, every Device is run at the time of an action.
+*      -- TIMER_EXPIRY:  the time a Device reported from nextEventTime() after it last ran.
+*      -- FRAME_ARRIVAL:  a Frame was delivered to a Mac in the Device, so the Device runs on the following tick.
+*   Within a time the Devices with pending work are run in the same order, and with the same run-then-transmit
+*      phases, as the lockstep loop.  A Device that is skipped has its timers caught up with advanceTimers() before
+*      it next runs, so the results are the same as running every Device on every tick.
+*   Setting lockStep runs every Device on every tick, which is useful as a reference when checking the event-driven mode.
+*   With more than one thread the Devices due at a time are run in parallel on a WorkerPool, and all have finished
+*      before anything is transmitted.  Transmission is then done in parallel the same way.  Each Device run writes SimLog::logFile messages to a buffer of its own
+*      (starting from default stream formatting) and the buffers are copied to the log in Device order, so the log
+*      is the same for any number of threads.
+*/
+
+enum SimEventTypes { ADMIN_ACTION, TIMER_EXPIRY, FRAME_ARRIVAL };
+
+class SimEvent
+{
+public:
+	int time;
+	unsigned long long sequence;     // Preserves scheduling order of events with the same time
+	SimEventTypes type;
+	size_t index;                    // Index of Device (TIMER_EXPIRY, FRAME_ARRIVAL) or action (ADMIN_ACTION)
+
+	bool operator> (const SimEvent& other) const;
+};
+
+class EventScheduler
+{
+public:
+	EventScheduler(std::vector<unique_ptr<Device>>& devices);
+	~EventScheduler();
+	EventScheduler(EventScheduler& copySource) = delete;             // Disable copy constructor
+	EventScheduler& operator= (const EventScheduler&) = delete;      // Disable assignment operator
+
+	void schedule(int time, std::function<void()> action);    // Run action at the start of the given time
+	void run(int endTime);                                    // Run simulation until SimLog::Time reaches endTime
+
+	void setLockStep(bool val);
+	bool getLockStep() const;
+	void setThreads(unsigned int threads);                    // Number of threads used to run Devices (1 = serial)
+	unsigned int getThreads() const;
+	unsigned long long getStepCount() const;                  // Number of distinct times at which anything ran
+	unsigned long long getDeviceRunCount() const;             // Number of times a Device was run
+
+private:
+	std::vector<unique_ptr<Device>>& Devices;
+	std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events;
+	std::vector<std::function<void()>> actions;
+	unsigned long long sequence;
+	bool lockStep;
+
+	std::vector<int> wakeTime;           // Per Device: earliest pending TIMER_EXPIRY or FRAME_ARRIVAL event
+	std::vector<int> lastTick;           // Per Device: last time the Device timers were ticked
+	std::vector<bool> isDue;             // Per Device: will run in the current step
+	std::vector<size_t> devIndex;        // Device number to index in Devices
+	std::vector<size_t> dueDevices;
+	std::vector<std::vector<size_t>> partnerWakes;     // Per Device: Devices that received a Frame from it this step
+	std::vector<unique_ptr<std::stringbuf>> devLog;    // Per Device: log messages from the current step
+	unique_ptr<WorkerPool> pPool;
+
+	unsigned long long stepCount;
+	unsigned long long deviceRunCount;
+
+	void attachDevices();
+	void push(int time, SimEventTypes type, size_t index);
+	void wake(size_t dev, int time, SimEventTypes type);
+	void synchronize(int time);
+	void step(int time);
+	std::streambuf* redirectLog(size_t dev);
+	void runDevice(size_t dev);
+	void transmitDevice(size_t dev);
+	void flushLogs();
+};
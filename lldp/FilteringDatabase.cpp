@@ -0,0 +1,209 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "FilteringDatabase.h"
+
+
+FilteringDatabase::FilteringDatabase(size_t initialCapacity, size_t maxEntries)
+	: maxEntries(maxEntries)
+{
+	size_t size = 8;
+	while (size < initialCapacity)
+		size <<= 1;
+	table.assign(size, Entry{ 0, 0, NoPort });
+	mask = size - 1;
+	count = 0;
+	ageingTime = 300;
+	learnFailures = 0;
+	lastSweep = SimTimeNever;
+}
+
+FilteringDatabase::~FilteringDatabase()
+{
+}
+
+unsigned long long FilteringDatabase::makeKey(unsigned short vid, unsigned long long mac)
+{
+	return (((unsigned long long)vid << 48) | (mac & 0xffffffffffffULL));
+}
+
+size_t FilteringDatabase::home(unsigned long long key) const
+{
+	key ^= key >> 29;                          // Mix so that sequential addresses spread across the table
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 32;
+	return ((size_t)key & mask);
+}
+
+size_t FilteringDatabase::findSlot(unsigned long long key) const
+{
+	size_t slot = home(key);
+	while ((table[slot].port != NoPort) && (table[slot].key != key))
+		slot = (slot + 1) & mask;
+	return (slot);
+}
+
+bool FilteringDatabase::isGroupAddress(unsigned long long mac)
+{
+	return ((mac & 0x010000000000ULL) != 0);   // I/G bit of the first octet
+}
+
+void FilteringDatabase::learn(unsigned short vid, unsigned long long mac, unsigned short port, int now)
+{
+	if (isGroupAddress(mac) || (port == NoPort))
+		return;
+
+	unsigned long long key = makeKey(vid, mac);
+	size_t slot = findSlot(key);
+	if (table[slot].port == NoPort)                      // New address
+	{
+		if (removeAged(home(key), false, now))            // Reclaim aged entries in its probe sequence
+			slot = findSlot(key);
+		if ((count >= maxEntries) && (now != lastSweep))   // Full, so look for aged entries in the whole table
+		{                                                  //    (at most once a tick)
+			lastSweep = now;
+			if (removeAged(0, true, now))
+				slot = findSlot(key);
+		}
+		if (count >= maxEntries)
+		{
+			learnFailures++;
+			return;
+		}
+		if (2 * (count + 1) > table.size())
+		{
+			grow();
+			slot = findSlot(key);
+		}
+		table[slot].key = key;
+		count++;
+	}
+	table[slot].port = port;
+	table[slot].lastSeen = now;
+}
+
+unsigned short FilteringDatabase::lookup(unsigned short vid, unsigned long long mac, int now)
+{
+	size_t slot = findSlot(makeKey(vid, mac));
+	if (table[slot].port == NoPort)
+		return (NoPort);
+	if (now - table[slot].lastSeen > ageingTime)         // Aged out
+	{
+		removeSlot(slot);
+		return (NoPort);
+	}
+	return (table[slot].port);
+}
+
+bool FilteringDatabase::removeAged(size_t first, bool wholeTable, int now)
+{
+	//  Looks at the slots from first to the next empty slot (the rest of a probe sequence), or at every slot.
+	size_t remaining = table.size();
+	size_t slot = first;
+	bool removed = false;
+	while (remaining > 0)
+	{
+		if (table[slot].port == NoPort)
+		{
+			if (!wholeTable)
+				break;
+		}
+		else if (now - table[slot].lastSeen > ageingTime)
+		{
+			removeSlot(slot);                  // May move another entry into this slot, so look at it again
+			removed = true;
+			continue;
+		}
+		slot = (slot + 1) & mask;
+		remaining--;
+	}
+	return (removed);
+}
+
+void FilteringDatabase::removeSlot(size_t slot)
+{
+	//  Move back any later entry in the probe sequence whose home is not between the hole and its current slot,
+	//     so every entry stays reachable from its home without passing an empty slot.
+	size_t hole = slot;
+	size_t next = (hole + 1) & mask;
+	while (table[next].port != NoPort)
+	{
+		size_t want = home(table[next].key);
+		if (((next - want) & mask) >= ((next - hole) & mask))   // Home is at or before the hole
+		{
+			table[hole] = table[next];
+			hole = next;
+		}
+		next = (next + 1) & mask;
+	}
+	table[hole].port = NoPort;
+	count--;
+}
+
+void FilteringDatabase::flushPort(unsigned short port)
+{
+	size_t slot = 0;
+	while (slot < table.size())
+	{
+		if (table[slot].port == port)
+			removeSlot(slot);                  // May move another entry into this slot, so look at it again
+		else
+			slot++;
+	}
+}
+
+void FilteringDatabase::grow()
+{
+	std::vector<Entry> old(table.size() * 2, Entry{ 0, 0, NoPort });
+	old.swap(table);
+	mask = table.size() - 1;
+	for (auto& entry : old)
+		if (entry.port != NoPort)
+			table[findSlot(entry.key)] = entry;
+}
+
+void FilteringDatabase::clear()
+{
+	for (auto& entry : table)
+		entry.port = NoPort;
+	count = 0;
+}
+
+size_t FilteringDatabase::size() const
+{
+	return (count);
+}
+
+size_t FilteringDatabase::capacity() const
+{
+	return (table.size());
+}
+
+int FilteringDatabase::get_ageingTime() const
+{
+	return (ageingTime);
+}
+
+void FilteringDatabase::set_ageingTime(int ticks)
+{
+	ageingTime = std::max(1, ticks);
+}
+
+unsigned long long FilteringDatabase::get_learnFailures() const
+{
+	return (learnFailures);
+}
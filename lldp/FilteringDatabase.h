@@ -0,0 +1,77 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <vector>
+
+/*
+*   Class FilteringDatabase holds the dynamic (learned) entries of a Bridge's filtering database, mapping a
+*      (VID, individual MAC address) pair to the BridgePort the address was last seen on.
+*   Entries are in an open addressed hash table with linear probing.  Removal shifts later entries of the probe
+*      sequence back, so there are no tombstones and a lookup never probes past the first empty slot.  The table
+*      doubles when it becomes more than half full, up to maxEntries;  beyond that new addresses are not learned.
+*   Aging is lazy:  each entry records the time it was last refreshed, and an entry older than the ageing time is
+*      removed when a lookup finds it, or when learning a new address finds it in the probe sequence of that address,
+*      rather than by a periodic scan.  When the table is at maxEntries, learning a new address first removes every
+*      aged entry in the table (at most once a tick), so aged entries never stop new addresses being learned.
+*/
+
+class FilteringDatabase
+{
+public:
+	static const unsigned short NoPort = 0xffff;
+
+	FilteringDatabase(size_t initialCapacity = 64, size_t maxEntries = 1 << 20);
+	~FilteringDatabase();
+	FilteringDatabase(FilteringDatabase& copySource) = delete;             // Disable copy constructor
+	FilteringDatabase& operator= (const FilteringDatabase&) = delete;      // Disable assignment operator
+
+	void learn(unsigned short vid, unsigned long long mac, unsigned short port, int now);
+	unsigned short lookup(unsigned short vid, unsigned long long mac, int now);   // Returns NoPort if not known
+	void flushPort(unsigned short port);       // Removes all entries for a port (e.g. when it stops being operational)
+	void clear();
+
+	size_t size() const;
+	size_t capacity() const;
+	int get_ageingTime() const;
+	void set_ageingTime(int ticks);
+	unsigned long long get_learnFailures() const;      // Addresses not learned because the table was at maxEntries
+
+	static bool isGroupAddress(unsigned long long mac);
+
+private:
+	struct Entry
+	{
+		unsigned long long key;                // VID in the top 16 bits, MAC address in the low 48
+		int lastSeen;
+		unsigned short port;                   // NoPort if the slot is empty
+	};
+
+	std::vector<Entry> table;
+	size_t mask;                               // table.size() - 1
+	size_t count;
+	size_t maxEntries;
+	int ageingTime;
+	unsigned long long learnFailures;
+	int lastSweep;                             // Time of the last search of the whole table for aged entries
+
+	static unsigned long long makeKey(unsigned short vid, unsigned long long mac);
+	size_t home(unsigned long long key) const;
+	size_t findSlot(unsigned long long key) const;     // Slot holding key, or the empty slot ending its probe sequence
+	void removeSlot(size_t slot);
+	bool removeAged(size_t first, bool wholeTable, int now);   // True if any entries were removed
+	void grow();
+};
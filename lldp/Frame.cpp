@@ -94,6 +94,16 @@ unsigned short Sdu::getNextSubType() const
 	return (pNextSdu->subType);
 }
 
+size_t Sdu::getLength() const
+{
+	return (2);        // Just the EtherType unless the derived class knows its encoded size
+}
+
+shared_ptr<Sdu> Sdu::copyCorrupted(size_t /* offset */, unsigned char /* mask */) const
+{
+	return (nullptr);
+}
+
 
 
 
@@ -105,6 +115,7 @@ Frame::Frame(unsigned long long frameDA, unsigned long long frameSA, shared_ptr<
 	VlanIdentifier = 0;
 	Priority = 0;
 	DropEligible = false;
+	FramePool::frameCreated();
 
 //	cout << "Frame constructor called (" << SimLog::Time << ")" << endl;
 //	SimLog::logFile << "Frame Constructor called (" << SimLog::Time << ")" << endl;
@@ -119,9 +130,9 @@ Frame::Frame(const Frame& CopySource)
 	Priority = CopySource.Priority;
 	DropEligible = CopySource.DropEligible;
 	pNextSdu = CopySource.pNextSdu;           // shallow copy is fine
+	FramePool::frameCreated();
 
-	cout << "Frame copy constructor called (" << SimLog::Time << ")" << endl;
-	SimLog::logFile << "Frame copy constructor called (" << SimLog::Time << ")" << endl;
+	SIM_LOG(LOG_TRACE, LOG_FRAME) << "Frame copy constructor called (" << SimLog::Time << ")" << endl;
 }
 
 /*
@@ -135,11 +146,22 @@ Frame::Frame(const Frame&& frameCopy)
 Frame::~Frame()
 {
 	pNextSdu = nullptr;
+	FramePool::frameDestroyed();
 
 //	cout << "Frame destructor called (" << SimLog::Time << ")" << endl;
 //	SimLog::logFile << "Frame destructor called (" << SimLog::Time << ")" << endl;
 }
 
+void* Frame::operator new(size_t size)
+{
+	return (FramePool::allocate(size));
+}
+
+void Frame::operator delete(void* pFrame)
+{
+	FramePool::release(pFrame);
+}
+
 /**/
 const Sdu& Frame::getNextSdu() const
 {
@@ -188,6 +210,55 @@ unique_ptr<Frame>  Frame::RemoveTag() const
 	return(std::move(pNewFrame));
 }
 
+size_t Frame::getLength() const
+{
+	size_t length = 12;                                 // Destination and source addresses
+	for (const Sdu* pSdu = pNextSdu.get(); pSdu != nullptr; pSdu = pSdu->pNextSdu.get())
+		length += pSdu->getLength();
+	return (std::max(length, (size_t)60) + 4);          // Pad to minimum frame size, and add the FCS
+}
+
+bool Frame::CorruptOctet(size_t offset, unsigned char mask)
+{
+	if (offset < 6)
+	{
+		MacDA ^= (unsigned long long)mask << (8 * (5 - offset));
+		return (true);
+	}
+	if (offset < 12)
+	{
+		MacSA ^= (unsigned long long)mask << (8 * (11 - offset));
+		return (true);
+	}
+	offset -= 12;
+	if ((pNextSdu != nullptr) && (offset < pNextSdu->getLength()))   // Only the first Sdu, so no other Sdu is copied
+	{
+		shared_ptr<Sdu> pCorrupted = pNextSdu->copyCorrupted(offset, mask);
+		if (pCorrupted != nullptr)
+		{
+			pCorrupted->pNextSdu = pNextSdu->pNextSdu;
+			pNextSdu = pCorrupted;
+			return (true);
+		}
+	}
+	return (false);
+}
+
+void Frame::PushTag(shared_ptr<Sdu> pNewSdu)
+{
+	// The new Sdu must not yet be in any other Frame, since linking it into this chain modifies it
+	pNewSdu->pNextSdu = pNextSdu;
+	pNextSdu = pNewSdu;
+}
+
+void Frame::PopTag()
+{
+	if (pNextSdu != nullptr)
+	{
+		pNextSdu = pNextSdu->pNextSdu;
+	}
+}
+
 
 /*
 
@@ -233,19 +304,24 @@ VlanTag::VlanTag(unsigned short type, unsigned short identifier, unsigned short
 	Vtag.id = identifier;
 	Vtag.pri = priority;
 	Vtag.de = dropEligible;
-	cout << "        VlanTag Constructor called" << endl;
+	SIM_LOG(LOG_TRACE, LOG_FRAME) << "        VlanTag Constructor called" << endl;
 }
 
 VlanTag::VlanTag(const VlanTag& copySource)  // Copy constructor
 	: Sdu(copySource)
 {
 	Vtag = copySource.Vtag;
-	cout << "***** VlanTag Copy Constructor executed *****" << endl;
+	SIM_LOG(LOG_TRACE, LOG_FRAME) << "***** VlanTag Copy Constructor executed *****" << endl;
 }
 
 VlanTag::~VlanTag()
 {
-	cout << "        VlanTag Destructor called" << endl;
+	SIM_LOG(LOG_TRACE, LOG_FRAME) << "        VlanTag Destructor called" << endl;
+}
+
+size_t VlanTag::getLength() const
+{
+	return (4);
 }
 
 const VlanTag& VlanTag::getVlanTag(Frame& taggedFrame)        // Returns a constant reference to the Vlan tag
@@ -270,6 +346,11 @@ TestSdu::~TestSdu()
 
 }
 
+size_t TestSdu::getLength() const
+{
+	return (2 + sizeof(scratchPad));
+}
+
 const TestSdu& TestSdu::getTestSdu(Frame& testFrame)        // Returns a constant reference to the Test Sdu
 {
 	// Will generate an error if getNextEtherType and getNextSubType were not validated before calling 
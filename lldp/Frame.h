@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #pragma once
+#include "FramePool.h"
 
 /*
 *   The structure of a Frame in this simulation is a Frame header that includes a pointer to the first Sdu in a chain
@@ -27,8 +28,9 @@ limitations under the License.
 *       There is no difference between a "tag", a "Protocol Data Unit (PDU)", and a "Service Data Unit (SDU)" as far as this
 *       simulation is concerned.
 *   A Frame object is instantiated using "std::make_unique<Frame>" and is accessed via a "std::unique_ptr<Frame>" (or a reference).
-*       An object of a class derived from Sdu is created using, for example, "std::make_shared<Lacpdu>" and is accessed via a 
-*       a "std::shared_ptr<Lacpdu>" or "std::shared_ptr<Sdu>" (or a reference). This means there is a single "owner" of any Frame,
+*       An object of a class derived from Sdu is created using, for example, "FramePool::makeSdu<Lacpdu>" and is accessed via a 
+*       a "std::shared_ptr<Lacpdu>" or "std::shared_ptr<Sdu>" (or a reference).  Both Frames and Sdus get their memory from
+*       the FramePool. This means there is a single "owner" of any Frame,
 *       and that Frame can be modified by inserting or removing "tags" without affecting other Frames in the simulation.  When a 
 *       Frame is replicated (for example within a Bridge), a "shallow" copy is made.  This means the pointer to the Sdu in the 
 *       Frame header is copied, but the Sdu itself is not copied.  It is therefore critical that Sdus are not modified once they
@@ -52,6 +54,9 @@ public:
 	const Sdu& getNextSdu() const;
 	unsigned short getNextEtherType() const;
 	unsigned short getNextSubType() const;
+	virtual size_t getLength() const;          // Octets this Sdu adds to an encoded Frame, including its EtherType
+	virtual shared_ptr<Sdu> copyCorrupted(size_t offset, unsigned char mask) const;   // Copy with octet at offset (from the
+	                                           //    EtherType) XORed with mask;  nullptr if the Sdu does not model its octets
 
 protected:
 	unsigned short etherType;
@@ -71,6 +76,9 @@ public:
 	//	Frame(const Frame&& frameCopy);     // move constructor
 	~Frame();
 
+	static void* operator new(size_t size);      // Frames are allocated from the FramePool
+	static void operator delete(void* pFrame);
+
 	int TimeStamp;
 
 
@@ -96,6 +104,11 @@ public:
 	unsigned short getNextSubType() const;
 	unique_ptr<Frame> InsertTag(shared_ptr<Sdu> pNewSdu) const;
 	unique_ptr<Frame> RemoveTag() const;
+	size_t getLength() const;                // Octets in the encoded Frame from DA through FCS, padded to the minimum
+	bool CorruptOctet(size_t offset, unsigned char mask);   // XORs an octet of the encoded Frame with mask, in place;
+	                                                        //    false if the simulation does not model that octet
+	void PushTag(shared_ptr<Sdu> pNewSdu);   // In place versions of InsertTag and RemoveTag for the owner of the Frame,
+	void PopTag();                           //    which change the Sdu chain without copying the Frame header
 	//	void Frame::PrintSduList() const;
 	void PrintFrameHeader() const;
 
@@ -124,6 +137,7 @@ public:
 
 	vlanControlWord Vtag;
 	static const VlanTag& getVlanTag(Frame& taggedFrame);        // Returns a constant reference to the Vlan tag
+	virtual size_t getLength() const override;
 
 };
 
@@ -138,6 +152,7 @@ public:
 	~TestSdu();
 
 	static const TestSdu& getTestSdu(Frame& testFrame);        // Returns a constant reference to the Test Sdu
+	virtual size_t getLength() const override;
 	int scratchPad;
 };
 /**/
@@ -0,0 +1,217 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include <mutex>
+#include <vector>
+#include "FramePool.h"
+
+
+/*
+*   Every block starts with a BlockHeader.  While the block is in use the header holds its size class;
+*      while it is on a free list the header holds the pointer to the next free block.
+*   The header is 16 bytes so the memory returned to the caller keeps the alignment of the heap.
+*/
+union BlockHeader
+{
+	size_t sizeClass;
+	BlockHeader* pNext;
+	char align[16];
+};
+
+const size_t NumSizeClasses = FramePool::MaxPooledSize / FramePool::SizeClassStep;
+const size_t HeapBlock = ~(size_t)0;          // sizeClass of a block that came straight from the heap
+
+static size_t blockSize(size_t sizeClass)
+{
+	return (sizeof(BlockHeader) + ((sizeClass + 1) * FramePool::SizeClassStep));
+}
+
+static size_t blocksPerSlab(size_t sizeClass)
+{
+	return (FramePool::SlabSize / blockSize(sizeClass));
+}
+
+struct FreeList
+{
+	BlockHeader* pHead;
+	size_t count;
+};
+
+//  Moves up to count blocks from the front of source to the front of dest
+static void moveBlocks(FreeList& source, FreeList& dest, size_t count)
+{
+	while ((count > 0) && source.pHead)
+	{
+		BlockHeader* pBlock = source.pHead;
+		source.pHead = pBlock->pNext;
+		source.count--;
+		pBlock->pNext = dest.pHead;
+		dest.pHead = pBlock;
+		dest.count++;
+		count--;
+	}
+}
+
+static std::mutex sharedLock;                  // Protects sharedLists and slabs
+static FreeList sharedLists[NumSizeClasses];   // Blocks given back by threads that exited or had too many
+static std::vector<void*> slabs;               // Keeps slabs reachable;  never freed since blocks migrate between threads
+
+static thread_local FreeList freeLists[NumSizeClasses];     // Per thread, so no locking
+static thread_local bool threadExited = false;
+
+/*
+*   When a thread exits, its free blocks go to the shared lists so a worker thread does not take the blocks it
+*      released with it.  Blocks released by the thread after that (e.g. by destructors of other thread_local or
+*      static objects) go straight to the shared lists.
+*/
+class ThreadExit
+{
+public:
+	bool registered = false;
+	~ThreadExit()
+	{
+		std::lock_guard<std::mutex> guard(sharedLock);
+		for (size_t sizeClass = 0; sizeClass < NumSizeClasses; sizeClass++)
+			moveBlocks(freeLists[sizeClass], sharedLists[sizeClass], freeLists[sizeClass].count);
+		threadExited = true;
+	}
+};
+
+static thread_local ThreadExit threadExit;     // Constructed by the first refill in each thread
+
+std::atomic<bool> FramePool::enabled(true);
+std::atomic<long long> FramePool::liveFrames(0);
+std::atomic<long long> FramePool::peakFrames(0);
+
+
+static void refill(size_t sizeClass)
+{
+	FreeList& list = freeLists[sizeClass];
+	if (!threadExited)
+		threadExit.registered = true;
+	{
+		std::lock_guard<std::mutex> guard(sharedLock);
+		moveBlocks(sharedLists[sizeClass], list, blocksPerSlab(sizeClass));      // Reuse returned blocks first
+	}
+	if (list.pHead)
+		return;
+
+	char* pSlab = static_cast<char*>(::operator new(FramePool::SlabSize));
+	{
+		std::lock_guard<std::mutex> guard(sharedLock);
+		slabs.push_back(pSlab);
+	}
+
+	size_t size = blockSize(sizeClass);
+	for (size_t offset = 0; offset + size <= FramePool::SlabSize; offset += size)
+	{
+		BlockHeader* pBlock = reinterpret_cast<BlockHeader*>(pSlab + offset);
+		pBlock->pNext = list.pHead;
+		list.pHead = pBlock;
+		list.count++;
+	}
+}
+
+void* FramePool::allocate(size_t size)
+{
+	BlockHeader* pBlock = nullptr;
+
+	if (enabled.load(std::memory_order_relaxed) && (size <= MaxPooledSize))
+	{
+		size_t sizeClass = (size == 0) ? 0 : ((size - 1) / SizeClassStep);
+		FreeList& list = freeLists[sizeClass];
+		if (list.pHead == nullptr)
+			refill(sizeClass);
+		pBlock = list.pHead;
+		list.pHead = pBlock->pNext;
+		list.count--;
+		pBlock->sizeClass = sizeClass;
+	}
+	else
+	{
+		pBlock = static_cast<BlockHeader*>(::operator new(sizeof(BlockHeader) + size));
+		pBlock->sizeClass = HeapBlock;
+	}
+	return (pBlock + 1);
+}
+
+void FramePool::release(void* pMem)
+{
+	if (pMem == nullptr)
+		return;
+
+	BlockHeader* pBlock = static_cast<BlockHeader*>(pMem) - 1;
+	if (pBlock->sizeClass == HeapBlock)
+	{
+		::operator delete(pBlock);
+	}
+	else
+	{
+		size_t sizeClass = pBlock->sizeClass;
+		FreeList& list = threadExited ? sharedLists[sizeClass] : freeLists[sizeClass];
+		if (threadExited)
+			sharedLock.lock();
+		pBlock->pNext = list.pHead;
+		list.pHead = pBlock;
+		list.count++;
+		if (threadExited)
+			sharedLock.unlock();
+		else if (list.count > MaxThreadSlabs * blocksPerSlab(sizeClass))     // A thread that mostly releases (e.g. the
+		{                                                                     //    receiver of Frames) gives blocks back
+			std::lock_guard<std::mutex> guard(sharedLock);
+			moveBlocks(list, sharedLists[sizeClass], blocksPerSlab(sizeClass));
+		}
+	}
+}
+
+void FramePool::setEnabled(bool val)
+{
+	enabled = val;
+}
+
+bool FramePool::getEnabled()
+{
+	return (enabled);
+}
+
+void FramePool::frameCreated()
+{
+	long long live = liveFrames.fetch_add(1, std::memory_order_relaxed) + 1;
+	long long peak = peakFrames.load(std::memory_order_relaxed);
+	while ((live > peak) && !peakFrames.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		;
+}
+
+void FramePool::frameDestroyed()
+{
+	liveFrames.fetch_sub(1, std::memory_order_relaxed);
+}
+
+long long FramePool::getLiveFrames()
+{
+	return (liveFrames);
+}
+
+long long FramePool::getPeakFrames()
+{
+	return (peakFrames);
+}
+
+void FramePool::resetPeakFrames()
+{
+	peakFrames = liveFrames.load();
+}
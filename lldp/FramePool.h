@@ -0,0 +1,104 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <atomic>
+#include <memory>
+
+/*
+*   Class FramePool recycles the memory used by Frames and Sdus.
+*   Blocks are grouped in size classes of SizeClassStep bytes up to MaxPooledSize, and each thread keeps its own
+*      free list for each size class, so allocation and release take no locks.  A block released in a different
+*      thread than it was allocated in (e.g. a Frame transmitted to a Device running in another thread) simply
+*      joins the free list of the releasing thread.  A thread holding more than MaxThreadSlabs slabs' worth of free
+*      blocks of a size class moves a slab's worth to a shared (locked) list, and a thread that exits moves all its
+*      free blocks there, so blocks do not pile up in one thread or leave with a worker thread.  Free lists are
+*      refilled from the shared list, and only if it is empty by carving blocks from a new slab taken from the heap;
+*      slabs are never returned to the heap, so the pool holds at most the peak memory in use plus the free blocks
+*      the threads keep.
+*   Each block starts with a small header recording its size class, so a block is always released to the right place
+*      even if the pool was enabled or disabled after it was allocated.
+*   With the pool disabled (setEnabled(false)) every allocation goes straight to the heap, for comparison.
+*   The pool also counts live Frames (and the peak number of live Frames) whether or not it is enabled.
+*
+*   Frames use the pool through Frame::operator new/delete, so make_unique<Frame> is unchanged.  Sdus should be created
+*      with FramePool::makeSdu<T>(...) instead of make_shared<T>(...), which puts the Sdu and its reference count in
+*      a single pooled block.
+*/
+
+class FramePool
+{
+public:
+	static void* allocate(size_t size);
+	static void release(void* pBlock);
+
+	static void setEnabled(bool val);
+	static bool getEnabled();
+
+	static void frameCreated();
+	static void frameDestroyed();
+	static long long getLiveFrames();
+	static long long getPeakFrames();
+	static void resetPeakFrames();
+
+	template <class T, class... Args>
+	static shared_ptr<T> makeSdu(Args&&... args);
+
+	static const size_t SizeClassStep = 16;
+	static const size_t MaxPooledSize = 512;
+	static const size_t SlabSize = 64 * 1024;
+	static const size_t MaxThreadSlabs = 4;        // Free blocks a thread keeps per size class, in slabs
+
+private:
+	static std::atomic<bool> enabled;
+	static std::atomic<long long> liveFrames;
+	static std::atomic<long long> peakFrames;
+};
+
+
+/*
+*   PoolAllocator is a standard allocator that gets memory from FramePool, for use with std::allocate_shared.
+*/
+
+template <class T>
+class PoolAllocator
+{
+public:
+	typedef T value_type;
+
+	PoolAllocator() {}
+	template <class U> PoolAllocator(const PoolAllocator<U>&) {}
+
+	T* allocate(size_t n)
+	{
+		return (static_cast<T*>(FramePool::allocate(n * sizeof(T))));
+	}
+
+	void deallocate(T* p, size_t)
+	{
+		FramePool::release(p);
+	}
+
+	template <class U> bool operator== (const PoolAllocator<U>&) const { return (true); }
+	template <class U> bool operator!= (const PoolAllocator<U>&) const { return (false); }
+};
+
+
+template <class T, class... Args>
+shared_ptr<T> FramePool::makeSdu(Args&&... args)
+{
+	return (std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...));
+}
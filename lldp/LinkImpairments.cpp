@@ -0,0 +1,204 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "LinkImpairments.h"
+
+
+const char* impairmentCountName(ImpairmentCounts count)
+{
+	static const char* names[IMPAIR_COUNT] = { "framesIn", "lost", "burstLost", "duplicated", "reordered",
+		"corrupted", "fcsErrors", "framesOut" };
+	return ((count < IMPAIR_COUNT) ? names[count] : "unknown");
+}
+
+bool parseImpairmentProfile(const std::string& spec, ImpairmentProfile& profile, unsigned long long& seed)
+{
+	size_t start = 0;
+	while (start < spec.size())
+	{
+		size_t end = spec.find(',', start);
+		if (end == std::string::npos)
+			end = spec.size();
+		std::string pair = spec.substr(start, end - start);
+		start = end + 1;
+
+		size_t equals = pair.find('=');
+		if (equals == std::string::npos)
+			return (false);
+		std::string name = pair.substr(0, equals);
+		const char* value = pair.c_str() + equals + 1;
+
+		if (name == "loss") profile.lossRate = atof(value);
+		else if (name == "goodToBad") profile.goodToBad = atof(value);
+		else if (name == "badToGood") profile.badToGood = atof(value);
+		else if (name == "lossGood") profile.lossGood = atof(value);
+		else if (name == "lossBad") profile.lossBad = atof(value);
+		else if (name == "dup") profile.duplicateRate = atof(value);
+		else if (name == "reorder") profile.reorderRate = atof(value);
+		else if (name == "depth") profile.reorderDepth = (unsigned int)atoi(value);
+		else if (name == "corrupt") profile.corruptRate = atof(value);
+		else if (name == "fcs") profile.fcsCheck = (atoi(value) != 0);
+		else if (name == "seed") seed = strtoull(value, nullptr, 0);
+		else
+			return (false);
+	}
+	return (true);
+}
+
+
+LinkImpairments::LinkImpairments(const ImpairmentProfile& profile, unsigned long long seed)
+	: profile(profile), rng(seed)
+{
+	badState = false;
+	clearCounts();
+}
+
+LinkImpairments::~LinkImpairments()
+{
+	held.clear();
+}
+
+const ImpairmentProfile& LinkImpairments::getProfile() const
+{
+	return (profile);
+}
+
+unsigned long long LinkImpairments::get(ImpairmentCounts count) const
+{
+	return ((count < IMPAIR_COUNT) ? counts[count] : 0);
+}
+
+void LinkImpairments::clearCounts()
+{
+	for (auto& count : counts)
+		count = 0;
+}
+
+bool LinkImpairments::isHolding() const
+{
+	return (!held.empty());
+}
+
+int LinkImpairments::nextReleaseTime() const
+{
+	int next = SimTimeNever;
+	for (auto& hold : held)
+		next = std::min(next, hold.releaseTime);
+	return (next);
+}
+
+void LinkImpairments::clear()
+{
+	held.clear();
+}
+
+
+void LinkImpairments::apply(unique_ptr<Frame> pFrame, std::vector<unique_ptr<Frame>>& deliver)
+{
+	counts[IMPAIR_FRAMES_IN]++;
+	if (lose())
+		return;
+	if (rng.chance(profile.corruptRate) && !corrupt(*pFrame))
+		return;
+
+	unique_ptr<Frame> pDuplicate = nullptr;
+	if (rng.chance(profile.duplicateRate))
+	{
+		pDuplicate = make_unique<Frame>(*pFrame);
+		pDuplicate->TimeStamp = pFrame->TimeStamp;     // Copy constructor would restamp it with the current Time
+		counts[IMPAIR_DUPLICATED]++;
+	}
+
+	if ((profile.reorderDepth > 0) && rng.chance(profile.reorderRate))
+	{
+		HeldFrame hold;
+		hold.overtakes = 1 + (unsigned int)rng.below(profile.reorderDepth);
+		hold.releaseTime = SimLog::Time + profile.reorderDepth;
+		hold.pFrame = std::move(pFrame);
+		held.push_back(std::move(hold));
+		counts[IMPAIR_REORDERED]++;
+	}
+	else
+		pass(std::move(pFrame), deliver);
+
+	if (pDuplicate)
+		pass(std::move(pDuplicate), deliver);
+}
+
+void LinkImpairments::release(std::vector<unique_ptr<Frame>>& deliver)
+{
+	for (auto it = held.begin(); it != held.end(); )
+	{
+		if (it->releaseTime <= SimLog::Time)
+		{
+			deliver.push_back(std::move(it->pFrame));
+			counts[IMPAIR_FRAMES_OUT]++;
+			it = held.erase(it);
+		}
+		else
+			it++;
+	}
+}
+
+void LinkImpairments::pass(unique_ptr<Frame> pFrame, std::vector<unique_ptr<Frame>>& deliver)
+{
+	deliver.push_back(std::move(pFrame));
+	counts[IMPAIR_FRAMES_OUT]++;
+
+	for (auto it = held.begin(); it != held.end(); )       // Held Frames that have now been overtaken enough follow it
+	{
+		if (--(it->overtakes) == 0)
+		{
+			deliver.push_back(std::move(it->pFrame));
+			counts[IMPAIR_FRAMES_OUT]++;
+			it = held.erase(it);
+		}
+		else
+			it++;
+	}
+}
+
+bool LinkImpairments::lose()
+{
+	bool lost = rng.chance(profile.lossRate);
+	if (profile.goodToBad > 0.0)                       // Gilbert-Elliott:  move the chain, then lose in the new state
+	{
+		badState = badState ? !rng.chance(profile.badToGood) : rng.chance(profile.goodToBad);
+		if (rng.chance(badState ? profile.lossBad : profile.lossGood))
+		{
+			if (!lost && badState)
+				counts[IMPAIR_BURST_LOST]++;
+			lost = true;
+		}
+	}
+	if (lost)
+		counts[IMPAIR_LOST]++;
+	return (lost);
+}
+
+bool LinkImpairments::corrupt(Frame& frame)
+{
+	size_t offset = (size_t)rng.below(frame.getLength());
+	unsigned char mask = (unsigned char)(1 + rng.below(255));     // Non-zero, so the octet really changes
+	if (profile.fcsCheck || !frame.CorruptOctet(offset, mask))
+	{
+		counts[IMPAIR_FCS_ERRORS]++;
+		return (false);
+	}
+	counts[IMPAIR_CORRUPTED]++;
+	return (true);
+}
@@ -0,0 +1,152 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <vector>
+#include "Frame.h"
+
+/*
+*   SplitMix64 is a small, fast pseudo-random number generator with 64 bits of state.  The same seed always gives the
+*      same sequence, so a simulation run with impaired links can be repeated exactly.
+*/
+
+class SplitMix64
+{
+public:
+	explicit SplitMix64(unsigned long long seed = 0) : state(seed) {}
+
+	unsigned long long next()
+	{
+		unsigned long long z = (state += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return (z ^ (z >> 31));
+	}
+
+	double nextDouble()                          // Uniform in [0, 1)
+	{
+		return ((next() >> 11) * (1.0 / 9007199254740992.0));
+	}
+
+	bool chance(double probability)
+	{
+		return ((probability > 0.0) && (nextDouble() < probability));
+	}
+
+	unsigned long long below(unsigned long long limit)    // Uniform in [0, limit);  limit must be non-zero
+	{
+		return (next() % limit);
+	}
+
+private:
+	unsigned long long state;
+};
+
+
+/*
+*   ImpairmentProfile describes how a Link mistreats the Frames crossing it in one direction.
+*      Loss is Bernoulli (each Frame lost with probability lossRate) and/or Gilbert-Elliott (a two state Markov chain
+*          moved once per Frame, with a separate loss probability in the Good and Bad states, giving bursts of loss).
+*          The Gilbert-Elliott model is off while goodToBad is zero.
+*      A Frame that is not lost is duplicated with probability duplicateRate.
+*      A Frame is held back with probability reorderRate, and is delivered after between 1 and reorderDepth later
+*          Frames have overtaken it, or reorderDepth ticks after it arrived, whichever is first.
+*      A Frame is corrupted with probability corruptRate:  one octet of the encoded Frame is changed.  If fcsCheck is
+*          true (as on a real Link) the receiver's FCS check discards it.  If false it is delivered with the change,
+*          provided the octet is one the simulation carries (addresses or an LLDPDU);  corruption of any other octet
+*          is still discarded as an FCS error.
+*/
+
+struct ImpairmentProfile
+{
+	double lossRate = 0.0;
+	double goodToBad = 0.0;          // Gilbert-Elliott probability of moving from Good to Bad
+	double badToGood = 0.0;          // Gilbert-Elliott probability of moving from Bad to Good
+	double lossGood = 0.0;           // Gilbert-Elliott loss probability in the Good state
+	double lossBad = 1.0;            // Gilbert-Elliott loss probability in the Bad state
+	double duplicateRate = 0.0;
+	double reorderRate = 0.0;
+	unsigned int reorderDepth = 3;
+	double corruptRate = 0.0;
+	bool fcsCheck = true;
+};
+
+
+enum ImpairmentCounts {
+	IMPAIR_FRAMES_IN,                // Frames offered to the impaired Link
+	IMPAIR_LOST,                     // Frames lost (Bernoulli or Gilbert-Elliott)
+	IMPAIR_BURST_LOST,               // Frames lost in the Gilbert-Elliott Bad state (included in IMPAIR_LOST)
+	IMPAIR_DUPLICATED,               // Extra copies delivered
+	IMPAIR_REORDERED,                // Frames held back and overtaken
+	IMPAIR_CORRUPTED,                // Frames delivered with a changed octet
+	IMPAIR_FCS_ERRORS,               // Corrupted Frames discarded by the FCS check
+	IMPAIR_FRAMES_OUT,               // Frames passed on to the receiver (including duplicates and corrupted Frames)
+	IMPAIR_COUNT
+};
+
+const char* impairmentCountName(ImpairmentCounts count);
+
+// Reads a profile from comma separated name=value pairs, e.g. "loss=0.01,dup=0.001,reorder=0.05,depth=4,seed=7".
+//    Names are loss, goodToBad, badToGood, lossGood, lossBad, dup, reorder, depth, corrupt, fcs (0 or 1), and seed.
+//    Returns false (leaving profile and seed partly updated) if a pair is not recognized.
+bool parseImpairmentProfile(const std::string& spec, ImpairmentProfile& profile, unsigned long long& seed);
+
+
+/*
+*   LinkImpairments applies an ImpairmentProfile to the Frames a Mac delivers to its link partner.
+*   apply() takes each Frame as it arrives at the far end of the Link and appends whatever should be delivered
+*      to the receiver now (none, one, or more Frames, including held Frames that have been overtaken enough).
+*      release() appends held Frames whose time is up, for ticks on which no Frame arrives.
+*   An instance is used only by the thread transmitting on its Mac, so it needs no locking, and its results
+*      do not depend on the number of simulation threads.
+*/
+
+class LinkImpairments
+{
+public:
+	LinkImpairments(const ImpairmentProfile& profile, unsigned long long seed);
+	~LinkImpairments();
+	LinkImpairments(LinkImpairments& copySource) = delete;             // Disable copy constructor
+	LinkImpairments& operator= (const LinkImpairments&) = delete;      // Disable assignment operator
+
+	void apply(unique_ptr<Frame> pFrame, std::vector<unique_ptr<Frame>>& deliver);
+	void release(std::vector<unique_ptr<Frame>>& deliver);
+	void clear();                                      // Discards held Frames (e.g. when the Link goes down)
+	int nextReleaseTime() const;                       // Time the oldest held Frame must be delivered, or SimTimeNever
+	bool isHolding() const;
+
+	const ImpairmentProfile& getProfile() const;
+	unsigned long long get(ImpairmentCounts count) const;
+	void clearCounts();
+
+private:
+	struct HeldFrame
+	{
+		unique_ptr<Frame> pFrame;
+		unsigned int overtakes;      // Later Frames still to be delivered before this one
+		int releaseTime;
+	};
+
+	ImpairmentProfile profile;
+	SplitMix64 rng;
+	bool badState;                   // Gilbert-Elliott state
+	std::vector<HeldFrame> held;
+	unsigned long long counts[IMPAIR_COUNT];
+
+	bool lose();
+	bool corrupt(Frame& frame);
+	void pass(unique_ptr<Frame> pFrame, std::vector<unique_ptr<Frame>>& deliver);
+};
@@ -21,16 +21,46 @@ limitations under the License.
 LinkLayerDiscovery::LinkLayerDiscovery(unsigned long long chassis)
 	: Component(ComponentTypes::LINK_LAYER_DISCOVERY), chassisId(chassis)
 {
-cout << "LinkLayerDiscovery Constructor called." << endl;
-SimLog::logFile << "LinkLayerDiscovery Constructor called." << hex << "  chassis 0x" << chassisId << endl;
+//	cout << "LinkLayerDiscovery Constructor called." << endl;
+	SIM_LOG(LOG_DETAIL, LOG_SIM) << "LinkLayerDiscovery Constructor called." << hex << "  chassis 0x" << chassisId << endl;
 }
 
 
 LinkLayerDiscovery::~LinkLayerDiscovery()
 {
 	pLldpPorts.clear();
-cout << "LinkLayerDiscovery Destructor called." << endl;
-SimLog::logFile << "LinkLayerDiscovery Destructor called." << hex << "  chassis 0x" << chassisId << endl;
+//	cout << "LinkLayerDiscovery Destructor called." << endl;
+	SIM_LOG(LOG_DETAIL, LOG_SIM) << "LinkLayerDiscovery Destructor called." << hex << "  chassis 0x" << chassisId << endl;
+}
+
+void LinkLayerDiscovery::addPort(shared_ptr<LldpPort> pPort)
+{
+	pPort->pAgentMibUsage = &nborMibUsage;
+	nborMibUsage.add(pPort->get_nborMibSize());
+	pLldpPorts.push_back(pPort);
+}
+
+unsigned long long LinkLayerDiscovery::get_nborMibSize() const
+{
+	return (nborMibUsage.size);
+}
+
+unsigned long long LinkLayerDiscovery::get_nborMibPeakSize() const
+{
+	return (nborMibUsage.peak);
+}
+
+void LinkLayerDiscovery::reset_nborMibPeakSize()
+{
+	nborMibUsage.peak = nborMibUsage.size;
+}
+
+LldpStatsSnapshot LinkLayerDiscovery::get_stats() const
+{
+	LldpStatsSnapshot sum;
+	for (auto& pPort : pLldpPorts)
+		sum += pPort->get_stats();
+	return (sum);
 }
 
 void LinkLayerDiscovery::reset()
@@ -39,7 +69,7 @@ void LinkLayerDiscovery::reset()
 	{
 		pPort->reset();
 
-		if (SimLog::Debug > 12)
+		if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_MIB))
 		{
 			LldpPort& port = *pPort;
 			SimLog::logFile << "Time " << SimLog::Time << ":  Resetting LLDP "
@@ -60,7 +90,7 @@ void LinkLayerDiscovery::timerTick()
 		{
 			pPort->timerTick();
 
-			if ((SimLog::Debug > 12) && (SimLog::Time < 0))
+			if (SIM_LOG_ENABLED(LOG_TRACE, LOG_SIM) && (SimLog::Time < 0))
 			{
 				LldpPort& port = *pPort;
 				SimLog::logFile << "Time " << SimLog::Time << ":  LLDP timer tick"
@@ -74,6 +104,32 @@ void LinkLayerDiscovery::timerTick()
 }
 
 
+void LinkLayerDiscovery::advanceTimers(int ticks)
+{
+	if (!suspended)
+	{
+		for (auto& pPort : pLldpPorts)              // For each LLDP Port:
+		{
+			pPort->advanceTimers(ticks);
+		}
+	}
+}
+
+
+int LinkLayerDiscovery::nextEventTime() const
+{
+	int next = SimTimeNever;
+	if (!suspended)
+	{
+		for (auto& pPort : pLldpPorts)              // For each LLDP Port:
+		{
+			next = std::min(next, pPort->nextEventTime());
+		}
+	}
+	return (next);
+}
+
+
 void LinkLayerDiscovery::run(bool singleStep)
 {
 	unsigned short nPorts = (unsigned short)pLldpPorts.size();
@@ -96,7 +152,7 @@ void LinkLayerDiscovery::run(bool singleStep)
 		{
 			LldpPort& port = *pLldpPorts[i];
 
-			if ((SimLog::Debug > 12) && (SimLog::Time < 0))
+			if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_RX) && (SimLog::Time < 0))
 			{
 				LldpPort& port = *pLldpPorts[i];
 				SimLog::logFile << "Time " << SimLog::Time << ":  LLDP checking receive path"
@@ -108,7 +164,7 @@ void LinkLayerDiscovery::run(bool singleStep)
 				pTempFrame = move(pLldpPorts[i]->pIss->Indication());   // Get ingress frame, if available, from ISS
 			if (pTempFrame)                                            // If there is an ingress frame
 			{
-				if (SimLog::Debug > 5)
+				if (SIM_LOG_ENABLED(LOG_EVENT, LOG_LLDP_RX))
 				{
 					/**/
 					SimLog::logFile << "Time " << SimLog::Time << ":  LLDP in Device:Port " << hex << pLldpPorts[i]->chassisId
@@ -144,7 +200,7 @@ void LinkLayerDiscovery::run(bool singleStep)
 		for (unsigned short i = 0; i < nPorts; i++)              // For each LLDP Port:
 		{
 
-			if ((SimLog::Debug > 12) && (SimLog::Time < 0))
+			if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_RX) && (SimLog::Time < 0))
 			{
 				LldpPort& port = *pLldpPorts[i];
 				SimLog::logFile << "Time " << SimLog::Time << ":  LLDP running receive machines"
@@ -156,6 +212,7 @@ void LinkLayerDiscovery::run(bool singleStep)
 //			transitions += AggPort::LacpMuxSM::runMuxSM(*pAggPorts[i], true);
 			transitions += LldpPort::LldpRxSM::run(*pLldpPorts[i], true);
 //			transitions += AggPort::LacpMuxSM::run(*pAggPorts[i], true);
+			LldpPort::LldpRxSM::sendXpduResponses(*pLldpPorts[i]);
 		}
 //		updateAggregatorStatus();
 //		runCSDC();
@@ -187,7 +244,7 @@ void LinkLayerDiscovery::run(bool singleStep)
 			}
 			/**/
 
-			if ((SimLog::Debug > 12) && (SimLog::Time < 0))
+			if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_TX) && (SimLog::Time < 0))
 			{
 				LldpPort& port = *pLldpPorts[i];
 				SimLog::logFile << "Time " << SimLog::Time << ":  LLDP running transmit machines"
@@ -205,7 +262,7 @@ void LinkLayerDiscovery::run(bool singleStep)
 		for (unsigned short i = 0; i < nPorts; i++)              // For each LLDP Port:
 		{
 
-			if ((SimLog::Debug > 12) && (SimLog::Time < 0))
+			if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_TX) && (SimLog::Time < 0))
 			{
 				LldpPort& port = *pLldpPorts[i];
 				SimLog::logFile << "Time " << SimLog::Time << ":  LLDP checking transmit path"
@@ -30,10 +30,18 @@ public:
 	unsigned long long chassisId;
 
 	std::vector<shared_ptr<LldpPort>> pLldpPorts;
+	void addPort(shared_ptr<LldpPort> pPort);        // Adds to pLldpPorts and to the neighbor MIB size of this shim
 
 	void reset();
 	void timerTick();
 	void run(bool singleStep);
+	void advanceTimers(int ticks);
+	int nextEventTime() const;
+
+	unsigned long long get_nborMibSize() const;      // Sum of neighbor MIB size of all ports
+	unsigned long long get_nborMibPeakSize() const;  // Peak of the sum (not the sum of the peaks)
+	void reset_nborMibPeakSize();
+	LldpStatsSnapshot get_stats() const;             // Sum of the statistics of all ports
 
 /*
 //	bool LinkAgg::configDistRelay(unsigned short distRelayIndex, unsigned short numAggPorts, unsigned short numIrp, 
@@ -46,6 +54,8 @@ public:
 /**/
 
 private:
+	MibUsage nborMibUsage;
+
 	/*
 	void resetCSDC();
 	void runCSDC();
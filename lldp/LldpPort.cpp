@@ -22,24 +22,51 @@ limitations under the License.
 MibEntry::MibEntry()
 {
 	rxTtl = 0;
-	ttlTimer = 0;
+	ttlTimer = TimingWheel::NoTimer;
+	xreqTimer = TimingWheel::NoTimer;
 	totalSize = 0;
 	nborAddr = 0;
-	pXpduMap = make_shared<map<unsigned char, xpduMapEntry>>();
+	manifestTime = 0;
+	manifestXreqs = 0;
+	xreqRetries = 0;
+	convergenceTime = -1;
+	pXpduMap = make_shared<XpduTable>();
 	pNewXpduMap = nullptr;
 }
 
 MibEntry::~MibEntry()
 {}
 
-xpduMapEntry::xpduMapEntry()
+unsigned long MibEntry::computeSize() const
 {
-	sizeXpduTlvs = 0;
-	status = RxXpduStatus::CURRENT;
+	unsigned long size = 0;
+	if (pXpduMap)
+		for (auto& mapEntry : *pXpduMap)
+			size += mapEntry.second.sizeXpduTlvs;
+	if (pNewXpduMap)
+		for (auto& mapEntry : *pNewXpduMap)
+			size += mapEntry.second.sizeXpduTlvs;
+	return (size);
+}
+
+MibUsage::MibUsage()
+{
+	size = 0;
+	peak = 0;
+}
+
+void MibUsage::add(unsigned long long amount)
+{
+	size += amount;
+	if (size > peak)
+		peak = size;
+}
+
+void MibUsage::remove(unsigned long long amount)
+{
+	size -= amount;
 }
 
-xpduMapEntry::~xpduMapEntry()
-{}
 
 
 LldpPort::LldpPort(unsigned long long chassis, unsigned long port, unsigned long long dstAddr)
@@ -49,7 +76,13 @@ LldpPort::LldpPort(unsigned long long chassis, unsigned long port, unsigned long
 	pIss = nullptr;
 
 	pRxLldpFrame = nullptr;
+	pTxNormalLldpdu = nullptr;
+	pTxShutdownLldpdu = nullptr;
+	txLldpduSA = 0;
 	maxSizeNborMIBs = 20000;    // arbitrary maximum size for storing all neighbor MIB info
+	pAgentMibUsage = nullptr;
+	xreqSrtt = 0;
+	xreqRttvar = 0;
 
 	//   Initialize local MIB entry
 	bool success = false;
@@ -65,7 +98,6 @@ LldpPort::LldpPort(unsigned long long chassis, unsigned long port, unsigned long
 		SimLog::logFile << "Time " << SimLog::Time << ":   LldpTxSM failed to create PortID TLV" << endl;
 
 //	localMIB.ttl = TlvTtl(msgTxInterval * msgTxHold);   // Create TTL TLV
-	localMIB.ttlTimer = 0;                              // TTL timer not used on local MIB Entry
 
 	localMIB.totalSize = 8 + localMIB.chassisID.getLength() + localMIB.portID.getLength();
 
@@ -77,34 +109,43 @@ LldpPort::LldpPort(unsigned long long chassis, unsigned long port, unsigned long
 	/**/
 	// Initialize local MIB entry manifest
 	//   Need the Normal/Manifest LLDPDU and at least 3 XPDUs (with at least one TLV each) for testing
-	SimLog::logFile << "     creating local MIB xpdu map: " << hex;
-	map<unsigned char, xpduMapEntry>& myMap = *(localMIB.pXpduMap);
+	bool logMap = SIM_LOG_ENABLED(LOG_DETAIL, LOG_LLDP_MIB);
+	if (logMap)
+		SimLog::logFile << "     creating local MIB xpdu map: " << hex;
+	XpduTable& myMap = *(localMIB.pXpduMap);
+	myMap.reserve(4);
 	xpduMapEntry xpdu0;
 	xpduDescriptor desc0(0, 1, 0);
 	xpdu0.xpduDesc = desc0;
 	xpdu0.pTlvs.push_back(make_shared<TlvString>(TLVtypes::SYSTEM_NAME, systemName));
 	xpdu0.sizeXpduTlvs = xpdu0.pTlvs[0]->getLength();
+	xpdu0.xpduDesc.check = xpdu0.computeCheck();
 	myMap.insert(make_pair(xpdu0.xpduDesc.num, xpdu0));
-	SimLog::logFile << "(num = " << (unsigned short)xpdu0.xpduDesc.num << " , mapSize = " << myMap.size()
-		<< " TLV type " << (unsigned short)myMap.at(xpdu0.xpduDesc.num).pTlvs[0]->getType() << " ) ";
+	if (logMap)
+		SimLog::logFile << "(num = " << (unsigned short)xpdu0.xpduDesc.num << " , mapSize = " << myMap.size()
+			<< " TLV type " << (unsigned short)myMap.at(xpdu0.xpduDesc.num).pTlvs[0]->getType() << " ) ";
 
 	xpduMapEntry xpdu1;
 	xpduDescriptor desc1(1, 1, 0x0101);
 	xpdu1.xpduDesc = desc1;
 	xpdu1.pTlvs.push_back(make_shared<TlvString>(TLVtypes::SYSTEM_DESC, systemDescription));
 	xpdu1.sizeXpduTlvs = xpdu1.pTlvs[0]->getLength();
+	xpdu1.xpduDesc.check = xpdu1.computeCheck();
 	myMap.insert(make_pair(xpdu1.xpduDesc.num, xpdu1));
-	SimLog::logFile << "(num = " << (unsigned short)xpdu1.xpduDesc.num << " , mapSize = " << myMap.size()
-		<< " TLV type " << (unsigned short)myMap.at(xpdu1.xpduDesc.num).pTlvs[0]->getType() << " ) ";
+	if (logMap)
+		SimLog::logFile << "(num = " << (unsigned short)xpdu1.xpduDesc.num << " , mapSize = " << myMap.size()
+			<< " TLV type " << (unsigned short)myMap.at(xpdu1.xpduDesc.num).pTlvs[0]->getType() << " ) ";
 
 	xpduMapEntry xpdu2;
 	xpduDescriptor desc2(2, 1, 0x0201);
 	xpdu2.xpduDesc = desc2;
 	xpdu2.pTlvs.push_back(make_shared<TlvString>(TLVtypes::PORT_DESC, portDescription));
 	xpdu2.sizeXpduTlvs = xpdu1.pTlvs[0]->getLength();
+	xpdu2.xpduDesc.check = xpdu2.computeCheck();
 	myMap.insert(make_pair(xpdu2.xpduDesc.num, xpdu2));
-	SimLog::logFile << "(num = " << (unsigned short)xpdu2.xpduDesc.num << " , mapSize = " << myMap.size()
-		<< " TLV type " << (unsigned short)myMap.at(xpdu2.xpduDesc.num).pTlvs[0]->getType() << " ) ";
+	if (logMap)
+		SimLog::logFile << "(num = " << (unsigned short)xpdu2.xpduDesc.num << " , mapSize = " << myMap.size()
+			<< " TLV type " << (unsigned short)myMap.at(xpdu2.xpduDesc.num).pTlvs[0]->getType() << " ) ";
 
 	xpduMapEntry xpdu3;
 	xpduDescriptor desc3(3, 1, 0x0301);
@@ -113,11 +154,16 @@ LldpPort::LldpPort(unsigned long long chassis, unsigned long port, unsigned long
 	xpdu3.pTlvs.push_back(make_shared<TlvOui>(0x000001aa, 4 + (unsigned short)xpdu3str.length()));
 	xpdu3.pTlvs[0]->putString(6, xpdu3str);
 	xpdu3.sizeXpduTlvs = xpdu1.pTlvs[0]->getLength();
+	xpdu3.xpduDesc.check = xpdu3.computeCheck();
 	myMap.insert(make_pair(xpdu3.xpduDesc.num, xpdu3));
-	SimLog::logFile << "(num = " << (unsigned short)xpdu3.xpduDesc.num << " , mapSize = " << myMap.size()
-		<< " TLV type " << (unsigned short)myMap.at(xpdu3.xpduDesc.num).pTlvs[0]->getType() << " ) ";
-	SimLog::logFile << dec << endl;
-	SimLog::logFile << "      local MIB xpdu Map has " << myMap.size() << " entries" << endl;
+	if (logMap)
+		SimLog::logFile << "(num = " << (unsigned short)xpdu3.xpduDesc.num << " , mapSize = " << myMap.size()
+			<< " TLV type " << (unsigned short)myMap.at(xpdu3.xpduDesc.num).pTlvs[0]->getType() << " ) ";
+	if (logMap)
+	{
+		SimLog::logFile << dec << endl;
+		SimLog::logFile << "      local MIB xpdu Map has " << myMap.size() << " entries" << endl;
+	}
 
 	/**/
 
@@ -126,10 +172,13 @@ LldpPort::LldpPort(unsigned long long chassis, unsigned long port, unsigned long
 
 	operational = false;                                       // Set by Receive State Machine based on ISS.Operational
 	lldpV2Enabled = false;                                      //TODO:  what changes lldpV2Enabled?
+	rxInfoAge = false;
+	sentManifest = false;
+	adminStatus = ENABLED_RX_TX;
 	/**/
 
 //	cout << "LldpPort Constructor called." << endl;
-	SimLog::logFile << "LldpPort Constructor called." << hex << "  chassis 0x" << chassisId
+	SIM_LOG(LOG_DETAIL, LOG_LLDP_MIB) << "LldpPort Constructor called." << hex << "  chassis 0x" << chassisId
 		<< "  port 0x" << portId << dec << endl;
 }
 
@@ -140,7 +189,7 @@ LldpPort::~LldpPort()
 	pIss = nullptr;
 
 //	cout << "LldpPort Destructor called." << endl;
-	SimLog::logFile << "LldpPort Destructor called." << hex << "  chassis 0x" << chassisId
+	SIM_LOG(LOG_DETAIL, LOG_LLDP_MIB) << "LldpPort Destructor called." << hex << "  chassis 0x" << chassisId
 		<< "  port 0x" << portId << dec << endl;
 }
 
@@ -189,6 +238,78 @@ void LldpPort::run(bool singleStep)
 	LldpPort::LldpTxTimerSM::run(*this, singleStep);
 }
 
+void LldpPort::advanceTimers(int ticks)
+{
+	LldpPort::LldpRxSM::timerTick(*this, ticks);
+	LldpPort::LldpTxSM::timerTick(*this, ticks);
+	LldpPort::LldpTxTimerSM::timerTick(*this, ticks);
+}
+
+int LldpPort::nextEventTime() const
+{
+	//  Returns the next time one of the state machines could take a transition, assuming no new frames arrive
+	//     and no administrative changes are made.  Any state not recognized here as quiescent is treated as
+	//     active (i.e. the port will be run on the next tick), so this can only ever cause extra work, never missed work.
+	int now = SimLog::Time;
+	int next = SimTimeNever;
+	bool issOperational = pIss && pIss->getOperational();
+	bool txEnabled = (adminStatus == ENABLED_RX_TX) || (adminStatus == ENABLED_TX_ONLY);
+
+	if (pRxLldpFrame || !requests.empty() || !indications.empty())     // Frames still moving through the shim
+		return (now + 1);
+
+	switch (RxSmState)
+	{
+	case LldpRxSM::WAIT_OPERATIONAL:
+		if (rxInfoAge || issOperational) next = now + 1;
+		break;
+	case LldpRxSM::RX_WAIT_FRAME:
+		if (rxInfoAge || !issOperational || (!sentManifest && (adminStatus == DISABLED)) || (adminStatus == ENABLED_TX_ONLY))
+			next = now + 1;
+		break;
+	default:
+		next = now + 1;
+		break;
+	}
+	long long rxTimerTicks = rxTimers.ticksToNextExpiry();        // Neighbor TTL and XREQ timers
+	if (rxTimerTicks >= 0)
+		next = std::min(next, now + (int)std::max(rxTimerTicks, 1LL));
+
+	switch (TxSmState)
+	{
+	case LldpTxSM::TX_LLDP_INITIALIZE:
+		if (issOperational && txEnabled) next = now + 1;
+		break;
+	case LldpTxSM::TX_IDLE:
+		if (!issOperational || !txEnabled || txNow) next = now + 1;
+		break;
+	case LldpTxSM::TX_SHUTDOWN_FRAME:
+		if (!issOperational || (LLDP_txShutdownWhile == 0)) next = now + 1;
+		else next = std::min(next, now + LLDP_txShutdownWhile);
+		break;
+	default:
+		next = now + 1;
+		break;
+	}
+
+	bool txTimerGlobal = !issOperational || (adminStatus == DISABLED) || (adminStatus == ENABLED_RX_ONLY);
+	switch (TxTimerSmState)
+	{
+	case LldpTxTimerSM::TX_TIMER_INITIALIZE:
+		if (!txTimerGlobal) next = now + 1;
+		break;
+	case LldpTxTimerSM::TX_TIMER_IDLE:
+		if (txTimerGlobal || newNeighbor || localChange || (LLDP_txTTR == 0)) next = now + 1;
+		else next = std::min(next, now + LLDP_txTTR);
+		break;
+	default:
+		next = now + 1;
+		break;
+	}
+
+	return (next);
+}
+
 
 /**/
 /*
@@ -198,34 +319,39 @@ void LldpPort::run(bool singleStep)
 void LldpPort::updateManifest(TLVtypes tlvChanged)
 {
 	//TODO:  This currently assumes all TLVs are in a known position in a known xpdu
-	//TODO:  Should calculate check values
 	//TODO:  Problem with just updating totalSize is that if it is ever incorrect it will stay that way
 
-	map<unsigned char, xpduMapEntry>& myMap = *(localMIB.pXpduMap);
+	XpduTable& myMap = *(localMIB.pXpduMap);
+	unsigned char xpduChanged = 0;
 	switch (tlvChanged)
 	{
 	case SYSTEM_NAME:
 		// update(replace) first TLV in Normal/Manifest LLDPDU
 		myMap.at(0).xpduDesc.rev++;
-		myMap.at(0).xpduDesc.check++;  // should be calculated
 		localMIB.totalSize += (systemName.length() - myMap.at(0).pTlvs[0]->getLength());
 		myMap.at(0).pTlvs[0] = make_shared<TLV>(TlvString(TLVtypes::SYSTEM_NAME, systemName));
+		myMap.at(0).xpduDesc.check = myMap.at(0).computeCheck();    // Only the XPDU that changed is recalculated
 		break;
 	case SYSTEM_DESC:
 		// update(replace) first TLV in first XPDU
+		xpduChanged = 1;
 		myMap.at(1).xpduDesc.rev++;
-		myMap.at(1).xpduDesc.check++;  // should be calculated
 		localMIB.totalSize += (systemDescription.length() - myMap.at(1).pTlvs[0]->getLength());
 		myMap.at(1).pTlvs[0] = make_shared<TLV>(TlvString(TLVtypes::SYSTEM_DESC, systemDescription));
+		myMap.at(1).xpduDesc.check = myMap.at(1).computeCheck();
 		break;
 	case PORT_DESC:
 		// update(replace) first TLV in second XPDU
+		xpduChanged = 2;
 		myMap.at(2).xpduDesc.rev++;
-		myMap.at(2).xpduDesc.check++;  // should be calculated
 		localMIB.totalSize += (portDescription.length() - myMap.at(2).pTlvs[0]->getLength());
 		myMap.at(2).pTlvs[0] = make_shared<TLV>(TlvString(TLVtypes::PORT_DESC, portDescription));
+		myMap.at(2).xpduDesc.check = myMap.at(2).computeCheck();
 		break;
 	}
+	pTxNormalLldpdu = nullptr;     // Encoded LLDPDU no longer matches the local MIB
+	if (xpduChanged < pTxXpduLldpdus.size())
+		pTxXpduLldpdus[xpduChanged] = nullptr;
 	localChange = true;
 }
 
@@ -272,8 +398,140 @@ void LldpPort::set_lldpV2Enabled(bool enable)  // if no constraint checking then
 	lldpV2Enabled = enable;
 }
 
+int LldpPort::get_xreqWindow()
+{
+	return (xreqWindow);
+}
+
+void LldpPort::set_xreqWindow(int window)
+{
+	xreqWindow = std::min(std::max(window, 1), 255);
+}
+
+int LldpPort::get_xreqMaxRetries()
+{
+	return (xreqMaxRetries);
+}
+
+void LldpPort::set_xreqMaxRetries(int retries)
+{
+	xreqMaxRetries = std::min(std::max(retries, 0), 16);
+}
+
+unsigned long long LldpPort::get_stat(LldpStatistics stat) const
+{
+	return (stats.get(stat));
+}
+
+LldpStatsSnapshot LldpPort::get_stats() const
+{
+	return (stats.snapshot());
+}
+
+void LldpPort::clear_stats()
+{
+	stats.clear();
+}
+
+unsigned long long LldpPort::get_nborMibSize() const
+{
+	return (nborMibUsage.size);
+}
+
+unsigned long long LldpPort::get_nborMibPeakSize() const
+{
+	return (nborMibUsage.peak);
+}
+
+void LldpPort::reset_nborMibPeakSize()
+{
+	nborMibUsage.peak = nborMibUsage.size;
+}
+
 /**/
 
+unsigned long long LldpPort::nborKey(const TlvView& chassisID, const TlvView& portID)
+{
+	return (portID.hash(chassisID.hash()));
+}
+
+unsigned int LldpPort::findNbor(const TlvView& chassisID, const TlvView& portID) const
+{
+	auto range = nborIndex.equal_range(nborKey(chassisID, portID));
+	for (auto it = range.first; it != range.second; it++)          // Confirm match, in case of a hash collision
+	{
+		const MibEntry& nbor = nborMIBs[it->second];
+		if ((nbor.chassisID == chassisID) && (nbor.portID == portID))
+			return (it->second);
+	}
+	return ((unsigned int)nborMIBs.size());
+}
+
+void LldpPort::addNbor(const MibEntry& nbor)
+{
+	nborIndex.insert(make_pair(nborKey(nbor.chassisID.view(), nbor.portID.view()), (unsigned int)nborMIBs.size()));
+	nborMIBs.push_back(nbor);
+	nborMIBs.back().totalSize = 0;                                   // Not yet accounted for
+	updateNborSize(nborMIBs.back());
+	stats.increment(STATS_REM_TABLES_INSERTS);
+}
+
+void LldpPort::updateNborSize(MibEntry& nbor)
+{
+	//  Only the change in this neighbor's size is applied to the running totals, so the cost does not depend on
+	//     the number of neighbors.
+	unsigned long size = nbor.computeSize();
+	if (size >= nbor.totalSize)
+	{
+		nborMibUsage.add(size - nbor.totalSize);
+		if (pAgentMibUsage) pAgentMibUsage->add(size - nbor.totalSize);
+	}
+	else
+	{
+		nborMibUsage.remove(nbor.totalSize - size);
+		if (pAgentMibUsage) pAgentMibUsage->remove(nbor.totalSize - size);
+	}
+	nbor.totalSize = size;
+}
+
+void LldpPort::removeNbor(unsigned int index)
+{
+	if (index >= nborMIBs.size())
+		return;
+
+	//  Changes the nborIndex entry that has the given index value, either by removing it or changing the index
+	auto reindex = [this](unsigned int oldIndex, unsigned int newIndex)
+	{
+		const MibEntry& nbor = nborMIBs[oldIndex];
+		auto range = nborIndex.equal_range(nborKey(nbor.chassisID.view(), nbor.portID.view()));
+		for (auto it = range.first; it != range.second; it++)
+			if (it->second == oldIndex)
+			{
+				if (newIndex < nborMIBs.size())
+					it->second = newIndex;
+				else
+					nborIndex.erase(it);
+				break;
+			}
+	};
+
+	unsigned int last = (unsigned int)nborMIBs.size() - 1;
+	reindex(index, (unsigned int)nborMIBs.size());                   // Remove entry for the neighbor being removed
+	nborMibUsage.remove(nborMIBs[index].totalSize);
+	if (pAgentMibUsage) pAgentMibUsage->remove(nborMIBs[index].totalSize);
+	rxTimers.stop(nborMIBs[index].ttlTimer);
+	rxTimers.stop(nborMIBs[index].xreqTimer);
+	if (index != last)
+	{
+		reindex(last, index);                                        // Last neighbor moves into the hole
+		nborMIBs[index] = std::move(nborMIBs[last]);
+		rxTimers.setData(nborMIBs[index].ttlTimer, index);
+		rxTimers.setData(nborMIBs[index].xreqTimer, index);
+	}
+	nborMIBs.pop_back();
+	stats.increment(STATS_REM_TABLES_DELETES);
+}
+
 //TODO:: remove this
 void LldpPort::test_removeNbor()
 {
@@ -284,11 +542,12 @@ void LldpPort::test_removeNbor()
 	{
 		SimLog::logFile << SimLog::Time << ":  first call sets pXpduMap to nullptr" << endl;
 		nborMIBs[0].pXpduMap = nullptr;       //     remove xpdu map at the start of the list
+		updateNborSize(nborMIBs[0]);
 	}
 	if (((SimLog::Time == 35) || (SimLog::Time == 50)) && (nborMIBs.size() > 0))       // if there is a neighbor MIB entry
 	{
 		SimLog::logFile << SimLog::Time << ":  second call removes entire nbor" << endl;
-		nborMIBs.pop_back();       //     remove the neighbor at the end of the list
+		removeNbor((unsigned int)nborMIBs.size() - 1);       //     remove the neighbor at the end of the list
 	}
 }
 
@@ -15,50 +15,68 @@ limitations under the License.
 */
 
 #pragma once
+#include <unordered_map>
 #include "Mac.h"
 #include "Lldpdu.h"
+#include "TimingWheel.h"
+#include "XpduTable.h"
+#include "LldpStats.h"
 
 using namespace std;
 
 class Lacpdu;
 
 
-enum RxXpduStatus { CURRENT, NEW, UPDATE, REQUESTED, RETRIED };
-
-class xpduMapEntry
-{
-public:
-	xpduMapEntry();
-	~xpduMapEntry();
-
-	xpduDescriptor xpduDesc;
-	unsigned long sizeXpduTlvs;
-	RxXpduStatus status;
-	vector<shared_ptr<TLV>> pTlvs;
-};
-
 class MibEntry
 {
 public:
 	MibEntry();
 	~MibEntry();
+	MibEntry(const MibEntry& copySource) = default;
+	MibEntry(MibEntry&& moveSource) = default;
+	MibEntry& operator= (const MibEntry& copySource) = default;
+	MibEntry& operator= (MibEntry&& moveSource) = default;      // Moving a neighbor does not copy its TLVs
+
+	unsigned long computeSize() const;  // Size of the TLVs in pXpduMap and pNewXpduMap
 
 	TLV chassisID;
 	TLV portID;
 //	TLV ttl; 
 	unsigned short rxTtl;
-	unsigned short ttlTimer;
-	unsigned short restoreTime;
-	unsigned long totalSize;
+	TimingWheel::Handle ttlTimer;       // Neighbor information ages out when this expires
+	TimingWheel::Handle xreqTimer;      // Running to the earliest deadline of the outstanding requested XPDUs
+	unsigned long totalSize;            // computeSize() when last accounted for in the neighbor MIB size
 	unsigned long long nborAddr;
+	int manifestTime;                   // SimLog::Time the Manifest LLDPDU that started pNewXpduMap was received
+	unsigned int manifestXreqs;         // XREQs sent for pNewXpduMap
+	unsigned int xreqRetries;           // XREQ timeouts since the last XPDU received for pNewXpduMap
+	int convergenceTime;                // Ticks from Manifest LLDPDU to last XPDU for the last completed manifest (-1 if none)
 
-	shared_ptr< map<unsigned char, xpduMapEntry>> pXpduMap;      // XPDU map for completely received Nbor TLVs
-	shared_ptr< map<unsigned char, xpduMapEntry>> pNewXpduMap;   // XPDU map that still needs to receive Extension LLDPDUs
+	shared_ptr<XpduTable> pXpduMap;      // XPDU map for completely received Nbor TLVs
+	shared_ptr<XpduTable> pNewXpduMap;   // XPDU map that still needs to receive Extension LLDPDUs
+};
+
+/*
+*   MibUsage is a running total, and the peak of the running total, of the size of neighbor MIB information.
+*/
+
+class MibUsage
+{
+public:
+	MibUsage();
+
+	unsigned long long size;
+	unsigned long long peak;
+
+	void add(unsigned long long amount);
+	void remove(unsigned long long amount);
 };
 
 class LldpPort : public IssQ
 {
 	friend class LinkLayerDiscovery;
+	friend class Benchmark;
+	friend class LldpBench;           // Microbenchmarks in lldpbench
 
 public:
 	LldpPort(unsigned long long chassis, unsigned long port, unsigned long long dstAddr);
@@ -75,6 +93,8 @@ public:
 	void reset();
 	void timerTick();
 	void run(bool singleStep);
+	void advanceTimers(int ticks);
+	int nextEventTime() const;
 
 
  private:
@@ -85,6 +105,7 @@ public:
 	bool lldpV2Enabled;
 
 	unique_ptr<Frame> pRxLldpFrame;
+	std::vector<TlvView> rxTlvs;        // Views of the TLVs in pRxLldpFrame (reused for each received LLDPDU)
 
 	std::string systemName;
 	std::string systemDescription;
@@ -99,10 +120,46 @@ public:
 	int txFastInit = 4;                // range 1 - 8;    default 4;
 	int reInitDelay = 2;               //                 default 2;
 	int txCreditMax = 5;               // range 1 - 10;   default 5;
+	int xreqWindow = 8;                // range 1 - 255;  XPDUs outstanding per neighbor while fetching a manifest
+	int xreqMaxRetries = 4;            // range 0 - 16;   XREQ timeouts without progress before abandoning a manifest
 
 	MibEntry localMIB;
+	shared_ptr<Lldpdu> pTxNormalLldpdu;      // Normal (or Manifest) LLDPDU encoded from localMIB;  nullptr when stale
+	shared_ptr<Lldpdu> pTxShutdownLldpdu;    // Shutdown LLDPDU encoded from localMIB
+	unsigned long long txLldpduSA;           // Source (and Manifest return) address pTxNormalLldpdu was encoded for
+	std::vector<shared_ptr<Lldpdu>> pTxXpduLldpdus;   // Extension LLDPDU encoded for each local XPDU number;  nullptr when stale
+	std::vector<std::pair<unsigned long long, unsigned char>> txXpduResponses;  // Return address and XPDU number requested this tick
 	std::vector<MibEntry> nborMIBs;
+	std::unordered_multimap<unsigned long long, unsigned int> nborIndex;   // Chassis ID + Port ID hash to nborMIBs index
 	unsigned long long maxSizeNborMIBs;
+	MibUsage nborMibUsage;                   // Sum of totalSize of all nborMIBs
+	MibUsage* pAgentMibUsage;                // Sum for all ports of the LinkLayerDiscovery shim (if any)
+
+	/*
+	*   rxTimers holds the TTL and XREQ timers of every neighbor MIB entry, with the timer data being the index of the
+	*      entry in nborMIBs, so aging costs nothing until a timer actually expires.
+	*/
+	enum RxTimerTypes { TTL_TIMER, XREQ_TIMER };
+	TimingWheel rxTimers;
+
+	/*
+	*   XREQ round trip time estimate (as RFC 6298), in eighths of a tick, from the time between requesting an XPDU
+	*      and receiving it.  xreqSrtt is 0 until the first measurement.
+	*/
+	int xreqSrtt;
+	int xreqRttvar;
+
+	LldpStatsBlock stats;
+
+	/*
+	*   Neighbor MIB entries are only added and removed with addNbor() and removeNbor() so nborIndex stays in step
+	*      with nborMIBs.  removeNbor() moves the last entry into the hole, so removal changes the index of that entry.
+	*/
+	static unsigned long long nborKey(const TlvView& chassisID, const TlvView& portID);
+	unsigned int findNbor(const TlvView& chassisID, const TlvView& portID) const;   // Returns nborMIBs.size() if not found
+	void addNbor(const MibEntry& nbor);
+	void removeNbor(unsigned int index);
+	void updateNborSize(MibEntry& nbor);     // Call after changing the TLVs or XPDU maps of a neighbor
 
 public:
 	/*
@@ -119,6 +176,17 @@ public:
 
 	bool get_lldpV2Enabled();
 	void set_lldpV2Enabled(bool enable);
+	int get_xreqWindow();
+	void set_xreqWindow(int window);
+	int get_xreqMaxRetries();
+	void set_xreqMaxRetries(int retries);
+	unsigned long long get_stat(LldpStatistics stat) const;
+	LldpStatsSnapshot get_stats() const;
+	void clear_stats();
+
+	unsigned long long get_nborMibSize() const;
+	unsigned long long get_nborMibPeakSize() const;
+	void reset_nborMibPeakSize();
 
 	void test_removeNbor();
 
@@ -128,6 +196,8 @@ private:
 //	static class LldpRxSM
 	class LldpRxSM
 	{
+		friend class LldpBench;
+
 	public:
 
 		enum RxSmStates { NO_STATE, WAIT_OPERATIONAL, RX_INITIALIZE, DELETE_AGED_INFO, RX_WAIT_FRAME, 
@@ -135,8 +205,9 @@ private:
 		enum RxTypes { INVALID, NORMAL, SHUTDOWN, MANIFEST, XPDU, XREQ };
 
 		static void reset(LldpPort& port);
-		static void timerTick(LldpPort& port);
+		static void timerTick(LldpPort& port, int ticks = 1);
 		static int run(LldpPort& port, bool singleStep);
+		static void sendXpduResponses(LldpPort& port);
 
 	private:
 		static bool step(LldpPort& port);
@@ -152,21 +223,25 @@ private:
 
 		static void rxCheckTimers(LldpPort& port);
 		static RxTypes rxProcessFrame(LldpPort& port);
-		static void rxNormal(LldpPort& port, Lldpdu& rxLldpdu);
-		static void rxDeleteInfo(LldpPort& port);
-		static void rxUpdateInfo(LldpPort& port);
-
-		static void createNeighbor(LldpPort& port, std::vector<TLV>& tlvs, bool copyTlvs);
+		static void rxNormal(LldpPort& port, std::vector<TlvView>& rxTlvs);
+		static void rxDeleteInfo(LldpPort& port, unsigned int index);
+		static void rxUpdateInfo(LldpPort& port, MibEntry& nbor);
+		static void rxXreqTimeout(LldpPort& port, MibEntry& nbor);
+		static void rxRttSample(LldpPort& port, int rtt);
+		static int xreqTimeLimit(LldpPort& port, MibEntry& nbor, unsigned int xpdus);
+
+		static void createNeighbor(LldpPort& port, std::vector<TlvView>& tlvs, bool copyTlvs);
 	//	static bool runRxExtended(LldpPort& port);
-		static void xRxManifest(LldpPort& port, Lldpdu& rxLldpdu);
-		static void xRxXPDU(LldpPort& port, Lldpdu& rxLldpdu);
+		static void xRxManifest(LldpPort& port, std::vector<TlvView>& rxTlvs);
+		static void xRxXPDU(LldpPort& port, std::vector<TlvView>& rxTlvs);
 		static bool xRxCheckManifest(LldpPort& port, MibEntry& nbor);
 	//	static void generateXREQ(LldpPort& port);
 	//	static bool findNeighbor(LldpPort& port, std::vector<TLV>& tlvs, int index);
-		static unsigned int findNborIndex(LldpPort& port, std::vector<TLV>& tlvs);
+		static unsigned int findNborIndex(LldpPort& port, std::vector<TlvView>& tlvs);
 		static bool roomForNewNeighbor(LldpPort& port, unsigned long newNborSize);
-		static bool compareTlvs(vector<shared_ptr<TLV>>& pTlvs, vector<TLV>& rxTlvs);
-		static void rxXREQ(LldpPort& port, Lldpdu& rxLldpdu);
+		static bool compareTlvs(const xpduMapEntry& xpdu, vector<TlvView>& rxTlvs, unsigned long long rxDigest, unsigned long rxLength);
+		static void rxXREQ(LldpPort& port, std::vector<TlvView>& rxTlvs);
+		static shared_ptr<Lldpdu> getXpduLldpdu(LldpPort& port, const xpduMapEntry& xpdu);
 	
 	};
 
@@ -189,12 +264,14 @@ private:
 //	static class LldpTxSM
 	class LldpTxSM
 	{
+		friend class LldpBench;
+
 	public:
 
 		enum TxSmStates { NO_STATE, TX_LLDP_INITIALIZE, TX_IDLE, TX_SHUTDOWN_FRAME, TX_INFO_FRAME };
 
 		static void reset(LldpPort& port);
-		static void timerTick(LldpPort& port);
+		static void timerTick(LldpPort& port, int ticks = 1);
 		static int run(LldpPort& port, bool singleStep);
 
 	private:
@@ -208,6 +285,7 @@ private:
 		static void mibConstrInfoLldpdu(LldpPort& port);
 		static void mibConstrShutdownLldpdu(LldpPort& port);
 		static bool transmitLldpdu(LldpPort& port, int TTL);
+		static shared_ptr<Lldpdu> getTxLldpdu(LldpPort& port, unsigned short TTL);
 		static void prepareLldpdu(LldpPort& port, Lldpdu& myLldpdu, unsigned short TTL);
 		/**/
 	};
@@ -229,7 +307,7 @@ private:
 		enum TxTimerSmStates { NO_STATE, TX_TIMER_INITIALIZE, TX_TIMER_IDLE, TX_TIMER_EXPIRES, TX_FAST_START, SIGNAL_TX };
 
 		static void reset(LldpPort& port);
-		static void timerTick(LldpPort& port);
+		static void timerTick(LldpPort& port, int ticks = 1);
 		static int run(LldpPort& port, bool singleStep);
 
 	private:
@@ -16,6 +16,10 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "LldpPort.h"
+#include "Trace.h"
+
+const unsigned int MaxXreqXpdus = 82;          // XPDU descriptors that fit in an XREQ TLV:  (511 - 14) / 6
+const size_t MaxXpduOctets = 1500;             // Largest Extension LLDPDU
 
 
 void LldpPort::LldpRxSM::reset(LldpPort& port)
@@ -23,12 +27,15 @@ void LldpPort::LldpRxSM::reset(LldpPort& port)
 //	port.currentWhileTimer = 0;
 	port.RxSmState = enterWaitOperational(port);
 	port.pRxLldpFrame = nullptr;
+	port.txXpduResponses.clear();
 }
 
 /**/
-void LldpPort::LldpRxSM::timerTick(LldpPort& dr)
+void LldpPort::LldpRxSM::timerTick(LldpPort& port, int ticks)
 {
-//	if (dr.currentWhileTimer > 0) dr.currentWhileTimer--;
+	port.rxTimers.advance(ticks);              // Neighbor timers that expire are handled by rxCheckTimers()
+	if (port.rxTimers.hasExpired())
+		port.rxInfoAge = true;
 }
 /**/
 
@@ -83,6 +90,7 @@ break;
 
 	if (nextRxSmState != RxSmStates::NO_STATE)
 	{
+		Trace::record(TRACE_LLDP_RX_STATE, port.chassisId, (uint16_t)port.portId, 0, port.RxSmState, nextRxSmState);
 		port.RxSmState = nextRxSmState;
 		transitionTaken = true;
 	}
@@ -101,7 +109,7 @@ LldpPort::LldpRxSM::RxSmStates LldpPort::LldpRxSM::enterWaitOperational(LldpPort
 
 LldpPort::LldpRxSM::RxSmStates LldpPort::LldpRxSM::enterDeleteAgedInfo(LldpPort& port)
 {
-	//TODO:  delete any neighbors that timed out
+	rxCheckTimers(port);                       // Deletes any neighbors that timed out
 	//TODO:  set somethingChangedRemote
 	port.rxInfoAge = false;
 
@@ -118,7 +126,7 @@ LldpPort::LldpRxSM::RxSmStates LldpPort::LldpRxSM::enterRxInitialize(LldpPort& p
 
 LldpPort::LldpRxSM::RxSmStates LldpPort::LldpRxSM::enterRxWaitFrame(LldpPort& port)
 {
-	port.rxInfoAge = false;
+	port.rxInfoAge = port.rxTimers.hasExpired();
 
 	return (RxSmStates::RX_WAIT_FRAME);
 }
@@ -127,55 +135,63 @@ LldpPort::LldpRxSM::RxTypes LldpPort::LldpRxSM::rxProcessFrame(LldpPort& port)
 {
 	//TODO: rxProcessFrame 
 	RxTypes rxType = RxTypes::INVALID;
-	Lldpdu& rxLldpdu = (Lldpdu&)(port.pRxLldpFrame->getNextSdu());
-	int nborIndex = 0;
+	const Lldpdu& rxLldpdu = Lldpdu::getLldpdu(*port.pRxLldpFrame);
+	std::vector<TlvView>& rxTlvs = port.rxTlvs;
 
-	for (auto& tlv : rxLldpdu.tlvs)
+	size_t ignoredTlvs = 0;
+	if (!rxLldpdu.decode(rxTlvs, &ignoredTlvs))                      // Get a view of each TLV in the LLDPDU
 	{
-		SimLog::logFile << "    Received TLV type = " << (unsigned short)tlv.getType();
-		SimLog::logFile << " and length = " << tlv.getLength() << " : ";
-		tlv.printBytes();
-		if (tlv.getType() == TLVtypes::SYSTEM_NAME)
+		SIM_LOG(LOG_EVENT, LOG_LLDP_RX) << "Time " << SimLog::Time << ":  Received LLDPDU with TLV overrunning end of LLDPDU" << endl;
+		rxTlvs.clear();                                              // Will be INVALID
+	}
+
+	if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_RX))
+		for (auto& tlv : rxTlvs)
 		{
-			SimLog::logFile << "  : ";
-			tlv.printString(2);
+			SimLog::logFile << "    Received TLV type = " << (unsigned short)tlv.getType();
+			SimLog::logFile << " and length = " << tlv.getLength() << " : ";
+			tlv.printBytes();
+			if (tlv.getType() == TLVtypes::SYSTEM_NAME)
+			{
+				SimLog::logFile << "  : ";
+				tlv.printString(2);
+			}
+			SimLog::logFile << endl;
 		}
-		SimLog::logFile << endl;
-	}
 
 
-	if (rxLldpdu.tlvs.size() > 2)      // If received LLDPDU has at least 3 TLVs
+	if (rxTlvs.size() > 2)      // If received LLDPDU has at least 3 TLVs
 	{
-		if ((rxLldpdu.tlvs[0].getType() == TLVtypes::CHASSIS_ID) &&  // If first 2 TLVs are Chassis ID and Port ID
-			(rxLldpdu.tlvs[0].getLength() >= 2) &&                   //    with valid lengths
-			(rxLldpdu.tlvs[0].getLength() <= 256) &&
-			(rxLldpdu.tlvs[1].getType() == TLVtypes::PORT_ID) &&
-			(rxLldpdu.tlvs[1].getLength() >= 2) &&
-			(rxLldpdu.tlvs[1].getLength() <= 256))
+		if ((rxTlvs[0].getType() == TLVtypes::CHASSIS_ID) &&  // If first 2 TLVs are Chassis ID and Port ID
+			(rxTlvs[0].getLength() >= 2) &&                   //    with valid lengths
+			(rxTlvs[0].getLength() <= 256) &&
+			(rxTlvs[1].getType() == TLVtypes::PORT_ID) &&
+			(rxTlvs[1].getLength() >= 2) &&
+			(rxTlvs[1].getLength() <= 256))
 		{
-			if ((rxLldpdu.tlvs[2].getType() == TLVtypes::TTL) &&           // If third TLV is TTL
-				(rxLldpdu.tlvs[2].getLength() >= 2))                       //    with valid length
+			if ((rxTlvs[2].getType() == TLVtypes::TTL) &&           // If third TLV is TTL
+				(rxTlvs[2].getLength() >= 2))                       //    with valid length
 			{
-				if ((static_cast<TlvTtl&>(rxLldpdu.tlvs[2])).getTtl())     //    If TTL value is > 0
+				if (TtlView(rxTlvs[2]).getTtl())     //    If TTL value is > 0
 					rxType = RxTypes::NORMAL;                              //        then Normal LLDPDU
 				else
 					rxType = RxTypes::SHUTDOWN;                            //    else Shutdown LLDPDU
 			}
-			if ((rxLldpdu.tlvs[2].getType() == TLVtypes::XID) &&           // If third TLV is Extension Identifier
-				(rxLldpdu.tlvs[2].getLength() >= 8) &&                     //    with valid length
+			if ((rxTlvs[2].getType() == TLVtypes::XID) &&           // If third TLV is Extension Identifier
+				(rxTlvs[2].getLength() >= 8) &&                     //    with valid length
 				(port.lldpV2Enabled) &&                                    //    and LLDPv2 supported
-				(port.lldpScopeAddress == rxLldpdu.tlvs[2].getAddr(2)) &&  //    and matching scope address
-				(findNborIndex(port, rxLldpdu.tlvs) < rxLldpdu.tlvs.size()))  //    and from a known neighbor
+				(port.lldpScopeAddress == rxTlvs[2].getAddr(2)) &&  //    and matching scope address
+				(findNborIndex(port, rxTlvs) < rxTlvs.size()))  //    and from a known neighbor
 				// Later will verify Scope and that the chassis ID and Port ID match a known neighbor
 			{
 				rxType = RxTypes::XPDU;                                    //    then Extension LLDPDU
 			}
-			if ((rxLldpdu.tlvs[2].getType() == TLVtypes::XREQ) &&          // If third TLV is Extension Request
-				(rxLldpdu.tlvs[2].getLength() >= 14) &&                    //    with valid length
+			if ((rxTlvs[2].getType() == TLVtypes::XREQ) &&          // If third TLV is Extension Request
+				(rxTlvs[2].getLength() >= 14) &&                    //    with valid length
 				(port.lldpV2Enabled) &&                                    //    and LLDPv2 supported
-				(port.lldpScopeAddress == rxLldpdu.tlvs[2].getAddr(8)) &&  //    and matching scope address
-				(rxLldpdu.tlvs[0] == port.localMIB.chassisID) &&           //    and Chassis ID and Port ID match 
-				(rxLldpdu.tlvs[1] == port.localMIB.portID))                //        this LLDP agent
+				(port.lldpScopeAddress == rxTlvs[2].getAddr(8)) &&  //    and matching scope address
+				(rxTlvs[0] == port.localMIB.chassisID.view()) &&           //    and Chassis ID and Port ID match 
+				(rxTlvs[1] == port.localMIB.portID.view()))                //        this LLDP agent
 				// Later will verify that the chassis ID and Port ID match this LLDP agent
 				//TODO:  check returnAddress != 0 ?
 			{
@@ -188,9 +204,11 @@ LldpPort::LldpRxSM::RxTypes LldpPort::LldpRxSM::rxProcessFrame(LldpPort& port)
 	//    Should these validations be done here?
 	if ((rxType != RxTypes::SHUTDOWN) && (rxType != RxTypes::XREQ))
 	{
-		for (size_t i = 3; i < rxLldpdu.tlvs.size(); i++)           // Walk through TLVs
+		if (ignoredTlvs)
+			port.stats.increment(STATS_TLVS_DISCARDED_TOTAL, ignoredTlvs);   // TLVs after an End TLV are ignored
+		for (size_t i = 3; i < rxTlvs.size(); i++)           // Walk through TLVs
 		{
-			unsigned short type = rxLldpdu.tlvs[i].getType();    // Check TLV type
+			unsigned short type = rxTlvs[i].getType();    // Check TLV type
 			if (((type == TLVtypes::CHASSIS_ID) ||               // If find out of place
 				(type == TLVtypes::PORT_ID) ||                  //    Chassis ID, Port ID, or TTL TLV
 				(type == TLVtypes::TTL)) ||
@@ -201,16 +219,14 @@ LldpPort::LldpRxSM::RxTypes LldpPort::LldpRxSM::rxProcessFrame(LldpPort& port)
 			{
 				rxType = RxTypes::INVALID;                       // Mark frame as invalid
 			}
-			else if (type == TLVtypes::END)                      // If termination TLV
-			{
-				i = rxLldpdu.tlvs.size();                        //    then don't processs any more TLVs
-				//TODO::  If were real frame (char string) rather than vector of TLVs would have to check to make sure
-				//     sum of TLV lengths not longer than the frame.
-			}
 			else if (port.lldpV2Enabled && (type == TLVtypes::MANIFEST) && (rxType == RxTypes::NORMAL))  // If Normal LLDPDU has a manifest TLV
 			{
 				rxType = RxTypes::MANIFEST;                      //    then change LLDPDU type to Manifest
 			}
+			else if ((type > TLVtypes::XID) && (type != TLVtypes::ORG_SPECIFIC))   // If reserved TLV type
+			{
+				port.stats.increment(STATS_TLVS_UNRECOGNIZED_TOTAL);
+			}
 			//TODO:  For all recognized TLV types: check min length and other TLV-specific constraints
 			//TODO:  So far this only does checks that would invalidate LLDPDU.  Still need to do checks that invalidate individual TLVs.
 		}
@@ -218,19 +234,29 @@ LldpPort::LldpRxSM::RxTypes LldpPort::LldpRxSM::rxProcessFrame(LldpPort& port)
 
 	if (rxType == RxTypes::INVALID)          // if type is invalid
 	{
-		SimLog::logFile << "Time " << SimLog::Time << ":  Received INVALID LLDPDU !!!!!!!!!!!!!!!" << endl;
-		//TODO:  increment error counters
+		SIM_LOG(LOG_EVENT, LOG_LLDP_RX) << "Time " << SimLog::Time << ":  Received INVALID LLDPDU !!!!!!!!!!!!!!!" << endl;
+		port.stats.increment(STATS_FRAMES_IN_ERRORS_TOTAL);
+		port.stats.increment(STATS_FRAMES_DISCARDED_TOTAL);
 	}
 	else if ((rxType != XREQ) && (port.adminStatus == adminStatusVals::ENABLED_TX_ONLY))
 	{     // if LLDP agent is transmit only, then discard all valid LLDPDUs except XREQ without incrementing error counters
 		  //TODO: this currenlty doesn't match standard because won't increment counters for poorly formatted LLDPDUs
 		  //     since it doesn't necessarily even implement the rx machine
 		rxType = RxTypes::INVALID;  // change type to invalid so LLDPDU will be discarded
+		port.stats.increment(STATS_FRAMES_DISCARDED_TOTAL);
+	}
+	else
+	{
+		port.stats.increment(STATS_FRAMES_IN_TOTAL);
+		if (rxType == RxTypes::XREQ)
+			port.stats.increment(STATS_XREQ_IN);
+		else if (rxType == RxTypes::XPDU)
+			port.stats.increment(STATS_XPDU_IN);
 	}
 	/*
 	SimLog::logFile << "Received LLDPDU of type " << (unsigned short)rxType << endl;
-	bool matchlocal = (rxLldpdu.tlvs[0] == port.localMIB.chassisID);
-	bool matchremote = (rxLldpdu.tlvs[0] == rxLldpdu.tlvs[0]);
+	bool matchlocal = (rxTlvs[0] == port.localMIB.chassisID.view());
+	bool matchremote = (rxTlvs[0] == rxTlvs[0]);
 	SimLog::logFile << "   Match local Chassis ID is ";
 	if (matchlocal) SimLog::logFile << "true ";
 	else SimLog::logFile << "false ";
@@ -245,28 +271,31 @@ LldpPort::LldpRxSM::RxTypes LldpPort::LldpRxSM::rxProcessFrame(LldpPort& port)
 
 LldpPort::LldpRxSM::RxSmStates LldpPort::LldpRxSM::enterRxFrame(LldpPort& port)
 {
-	Lldpdu& rxLldpdu = (Lldpdu&)(port.pRxLldpFrame->getNextSdu());
-
 	RxTypes rxType = rxProcessFrame(port);
+	std::vector<TlvView>& rxTlvs = port.rxTlvs;
 	switch (rxType)
 	{
 	//TODO: verify if multiple commands within a case-break sequence need to be enclosed in {}
 	case RxTypes::SHUTDOWN:
-		rxDeleteInfo(port);
+		{
+			unsigned int index = findNborIndex(port, rxTlvs);
+			if (index < port.nborMIBs.size())
+				rxDeleteInfo(port, index);
+		}
 		break;
 	case RxTypes::XREQ:
-		rxXREQ(port, rxLldpdu);
+		rxXREQ(port, rxTlvs);
 		break;
 	case RxTypes::NORMAL:
-		rxNormal(port, rxLldpdu);
+		rxNormal(port, rxTlvs);
 //		rxUpdateInfo(port);
 		break;
 	case RxTypes::MANIFEST:
-		xRxManifest(port, rxLldpdu);
+		xRxManifest(port, rxTlvs);
 //		if (xRxManifest(port, rxLldpdu)) rxUpdateInfo(port);
 		break;
 	case RxTypes::XPDU:
-		xRxXPDU(port, rxLldpdu);
+		xRxXPDU(port, rxTlvs);
 //		if (xRxXPDU(port, rxLldpdu)) rxUpdateInfo(port);
 		break;
 	case RxTypes::INVALID:
@@ -292,81 +321,116 @@ bool LldpPort::LldpRxSM::runRxExtended(LldpPort& port)  // returns true if manif
 
 void LldpPort::LldpRxSM::rxCheckTimers(LldpPort& port)
 {
-	//TODO: check timers for all neighbors
-	//TODO:     handle XREQ timeout, calling generateXREQ()
-	//TODO:     handle RXTTL timeout, calling rxDeleteInfo()
-
+	//  Only neighbors with an expired timer are visited.  The timer data is the neighbor's index in nborMIBs,
+	//     which removeNbor() keeps current as neighbors are deleted.
+	unsigned int type = 0;
+	unsigned int index = 0;
+	while (port.rxTimers.popExpired(type, index))
+	{
+		if (index >= port.nborMIBs.size())
+			continue;
+		MibEntry& nbor = port.nborMIBs[index];
+		if (type == TTL_TIMER)
+		{
+			nbor.ttlTimer = TimingWheel::NoTimer;
+			SIM_LOG(LOG_EVENT, LOG_LLDP_MIB) << "Time " << SimLog::Time << ":    TTL expired for nbor " << index << endl;
+			port.stats.increment(STATS_AGEOUTS_TOTAL);
+			rxDeleteInfo(port, index);
+		}
+		else if (type == XREQ_TIMER)
+		{
+			nbor.xreqTimer = TimingWheel::NoTimer;
+			rxXreqTimeout(port, nbor);
+		}
+	}
+	port.rxInfoAge = false;
 }
 
-void LldpPort::LldpRxSM::rxNormal(LldpPort& port, Lldpdu& rxLldpdu)
+void LldpPort::LldpRxSM::rxNormal(LldpPort& port, std::vector<TlvView>& rxTlvs)
 {
 	bool nborChanged = false;
-	std::vector<TLV>& rxTlvs = rxLldpdu.tlvs;
 	unsigned int index = findNborIndex(port, rxTlvs);
 	if (index == port.nborMIBs.size())                             // if didn't find nbor
 	{
 		unsigned long size = 0;                                    // then find size of new neighbor
 		for (auto& tlv : rxTlvs)
-			size += tlv.getLength();
+			size += tlv.size();
 		if (roomForNewNeighbor(port, size))                        //    and if have room
 		{
 			createNeighbor(port, rxTlvs, true);                    //    then create new neighbor MIB entry (with tlvs) at index value
-			port.nborMIBs[index].ttlTimer = port.nborMIBs[index].rxTtl;     //       and restart timer
 			nborChanged = true; 
 		}
+		else
+			port.stats.increment(STATS_REM_TABLES_DROPS);
 	}
 	else
 	{
-		map<unsigned char, xpduMapEntry>& nborMap = *(port.nborMIBs[index].pXpduMap);
+		XpduTable& nborMap = *(port.nborMIBs[index].pXpduMap);
 
+		bool mapCleared = false;
 		if (nborMap.size() != 1)           // if previously received Manifest and XPDU LLDPDUs
 		{
 			xpduMapEntry normalLldpduMapEntry = nborMap.at(0);   // save old map entry for Normal LLDPDU
 			nborMap.clear();                                     // clear out old xpdu entries
 			nborMap.insert(make_pair(0, normalLldpduMapEntry));  // restore old map entry for Normal LLDPDU
+			mapCleared = true;
 		}
-		bool tlvsMatch = compareTlvs( nborMap.at(0).pTlvs, rxTlvs);
+		unsigned long rxLength = 0;
+		unsigned long long rxDigest = hashTlvs(rxTlvs, 3, rxLength);
+		bool tlvsMatch = compareTlvs(nborMap.at(0), rxTlvs, rxDigest, rxLength);
 		if (!tlvsMatch)                                                            // if new TLVs don't match old
 		{
-			nborMap.at(0).pTlvs.clear();                                           //    then clear old TLVs      
-			for (unsigned int i = 0; i < (rxTlvs.size() - 3); i++)                 //    and for each new TLV
-				nborMap.at(0).pTlvs[i] = make_shared<TLV>(rxTlvs[i + 3]);          //        copy TLV and put pointer in map
+			xpduMapEntry& normalEntry = nborMap.at(0);
+			normalEntry.pTlvs.clear();                                             //    then clear old TLVs      
+			normalEntry.sizeXpduTlvs = 6 + port.nborMIBs[index].chassisID.getLength() + port.nborMIBs[index].portID.getLength();
+			for (unsigned int i = 3; i < rxTlvs.size(); i++)                       //    and for each new TLV
+			{
+				normalEntry.sizeXpduTlvs += (2 + rxTlvs[i].getLength());           //        update cumulative size of tlvs
+				normalEntry.pTlvs.push_back(make_shared<TLV>(rxTlvs[i]));          //        copy TLV and put pointer in map
+			}
+			normalEntry.tlvsDigest = rxDigest;
+			normalEntry.tlvsLength = rxLength;
 			nborChanged = true;                                                    //    Note that something changed 
 		}
-		port.nborMIBs[index].rxTtl = (static_cast<TlvTtl&>(rxTlvs[2])).getTtl();       //       Save received TTL value
-		port.nborMIBs[index].ttlTimer = port.nborMIBs[index].rxTtl;                    //       and restart timer
+		if (nborChanged || mapCleared)                                             // Unchanged refresh leaves the size alone
+			port.updateNborSize(port.nborMIBs[index]);
+		port.nborMIBs[index].rxTtl = TtlView(rxTlvs[2]).getTtl();                      //       Save received TTL value
+		port.rxTimers.restart(port.nborMIBs[index].ttlTimer, port.nborMIBs[index].rxTtl, TTL_TIMER, index);  //       and restart timer
 	}
 	
-	SimLog::logFile << "    After rxNormal size of nbors is " << port.nborMIBs.size();
-	if (port.nborMIBs.size() > 0)
+	if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_MIB))
 	{
-		SimLog::logFile << " and entry " << (unsigned short)port.nborMIBs[0].pXpduMap->begin()->first;
-		SimLog::logFile << " has " << port.nborMIBs[0].pXpduMap->begin()->second.pTlvs.size() << " TLVs ";
+		SimLog::logFile << "    After rxNormal size of nbors is " << port.nborMIBs.size();
+		if (port.nborMIBs.size() > 0)
+		{
+			SimLog::logFile << " and entry " << (unsigned short)port.nborMIBs[0].pXpduMap->begin()->first;
+			SimLog::logFile << " has " << port.nborMIBs[0].pXpduMap->begin()->second.pTlvs.size() << " TLVs ";
+		}
+		SimLog::logFile << " with change = " << nborChanged << endl;
 	}
-	SimLog::logFile << " with change = " << nborChanged << endl;
 
 	//TODO: init neighbor specific timers
 
 }
 
-void LldpPort::LldpRxSM::xRxManifest(LldpPort& port, Lldpdu& rxLldpdu) // returns true if manifest is complete
+void LldpPort::LldpRxSM::xRxManifest(LldpPort& port, std::vector<TlvView>& rxTlvs) // returns true if manifest is complete
 {
 	bool manifestComplete = false;
 
 	bool nborChanged = false;
-	std::vector<TLV>& rxTlvs = rxLldpdu.tlvs;
+	unsigned int index = 0;
 	unsigned int manifestTlvIndex = 0;
 	for (unsigned int i = 3; ((i < rxTlvs.size()) && (manifestTlvIndex == 0)); i++) // Find manifest TLV
 		if (rxTlvs[i].getType() == TLVtypes::MANIFEST)
 			manifestTlvIndex = i;
 	if (manifestTlvIndex == 0)
 	{
-		SimLog::logFile << "(" << SimLog::Time << ") in xRxManifest but cannot find manifest TLV" << endl;
+		SIM_LOG(LOG_EVENT, LOG_LLDP_RX) << "(" << SimLog::Time << ") in xRxManifest but cannot find manifest TLV" << endl;
 	}
 	else
 	{
-		tlvManifest& rxManTLV = static_cast<tlvManifest&>(rxTlvs[manifestTlvIndex]);   // If got here, there must be manifest TLV
-		unsigned int index = findNborIndex(port, rxTlvs);
+		ManifestView rxManTLV(rxTlvs[manifestTlvIndex]);                 // If got here, there must be manifest TLV
+		index = findNborIndex(port, rxTlvs);
 		if (index == port.nborMIBs.size())                             // if didn't find nbor
 		{
 			unsigned long size = rxManTLV.getTotalSize();              // then find size of new neighbor
@@ -377,22 +441,26 @@ void LldpPort::LldpRxSM::xRxManifest(LldpPort& port, Lldpdu& rxLldpdu) // return
 			}
 			else
 			{
-				// TODO:  If no room then discard frame (and increment counters?)
+				port.stats.increment(STATS_REM_TABLES_DROPS);      // No room, so frame is discarded
 			}
 		}
 		if (index < port.nborMIBs.size())   // unless discarded frame because no room, will now have index to neighbor MIB entry
 		{
 			MibEntry& nbor = port.nborMIBs[index];
 			nbor.nborAddr = rxManTLV.getReturnAddr();                          // Save return address for XREQs
+			nbor.rxTtl = TtlView(rxTlvs[2]).getTtl();                          // Save received TTL value
+			port.rxTimers.restart(nbor.ttlTimer, nbor.rxTtl, TTL_TIMER, index);   //    and restart timer
 
-			SimLog::logFile << "               Saving return address from manifest TLV: " << hex << nbor.nborAddr << dec << endl;
+			SIM_LOG(LOG_TRACE, LOG_LLDP_MIB) << "               Saving return address from manifest TLV: " << hex << nbor.nborAddr << dec << endl;
 
-			bool tlvsMatch = compareTlvs(nbor.pXpduMap->at(0).pTlvs, rxTlvs);  // Compare current TLVs for XPDU0, including Manifest TLV, to new LLDPDU
+			unsigned long rxLength = 0;
+			unsigned long long rxDigest = hashTlvs(rxTlvs, 3, rxLength);
+			bool tlvsMatch = compareTlvs(nbor.pXpduMap->at(0), rxTlvs, rxDigest, rxLength);  // Compare current TLVs for XPDU0, including Manifest TLV, to new LLDPDU
 			if (tlvsMatch)                                                     // If they match then no change to neighbor
 			{
-				nbor.rxTtl = (static_cast<TlvTtl&>(rxTlvs[2])).getTtl();       //       so just save received TTL value
-				nbor.ttlTimer = nbor.rxTtl;                                    //       and restart timer
-				nbor.pNewXpduMap = nullptr;                                    //       and discard any partially completed manifest
+				nbor.pNewXpduMap = nullptr;                                    //       so discard any partially completed manifest
+				port.rxTimers.stop(nbor.xreqTimer);
+				port.updateNborSize(nbor);
 			}
 			else                  // If new TLVs are different then need to create a new XPDU Map from the received Manifest TLV
 			// TODO: Could optimize(?) my comparing received Manifest TLV to current.  If the same then only XPDU0 tlvs changed so could update
@@ -402,7 +470,8 @@ void LldpPort::LldpRxSM::xRxManifest(LldpPort& port, Lldpdu& rxLldpdu) // return
 			// TODO: Somewhere handle case of Manifest TLV with no XPDU Descriptors
 			// TODO:  handle case where just enabled LLDPV2 so have manifest TLV in XPDU 0 but no other manifest entries
 			{
-				shared_ptr<map<unsigned char, xpduMapEntry>> pManXpduMap = make_shared<map<unsigned char, xpduMapEntry>>(); 
+				shared_ptr<XpduTable> pManXpduMap = make_shared<XpduTable>(); 
+				pManXpduMap->reserve(rxManTLV.getNumXpdus() + 1);      // XPDU 0 plus one entry per descriptor
 				xpduMapEntry newNborMapEntry;                        // Create xpdu map entry for Normal LLDPDU
 				newNborMapEntry.sizeXpduTlvs = 6 + nbor.chassisID.getLength() + nbor.portID.getLength(); // in this entry include first 3 tlv lengths
 				//TODO:  Think the cumulative size of TLVs is really only needed on localMIB (for transmitting a manifest)
@@ -413,6 +482,8 @@ void LldpPort::LldpRxSM::xRxManifest(LldpPort& port, Lldpdu& rxLldpdu) // return
 						newNborMapEntry.sizeXpduTlvs += (2 + rxTlvs[i].getLength());   // update cumulative size of tlvs
 						newNborMapEntry.pTlvs.push_back(make_shared<TLV>(rxTlvs[i]));  // copy TLVs and put pointers in map
 					}
+				newNborMapEntry.tlvsDigest = rxDigest;
+				newNborMapEntry.tlvsLength = rxLength;
 				pManXpduMap->insert(make_pair(0, newNborMapEntry));  // Put xpdu map entry in map with key=0
 
 				for (unsigned int i = 0; i < rxManTLV.getNumXpdus(); i++)              // For each xpdu descriptor in manifest TLV
@@ -421,10 +492,14 @@ void LldpPort::LldpRxSM::xRxManifest(LldpPort& port, Lldpdu& rxLldpdu) // return
 					newNborMapEntry.xpduDesc = rxManTLV.getXpduDescriptor(i);          //     Copy the xpdu descriptor from the manifest TLV
 					newNborMapEntry.status = RxXpduStatus::UPDATE;                     //     Assume need to request XPDU in Extension LLDPDU
 					newNborMapEntry.pTlvs.clear();                                     //     No TLVs yet
+					newNborMapEntry.tlvsDigest = hashBytes(nullptr, 0);
+					newNborMapEntry.tlvsLength = 0;
+					newNborMapEntry.requestTime = -1;
+					newNborMapEntry.deadline = -1;
 					auto oldXpdu = nbor.pXpduMap->find(newNborMapEntry.xpduDesc.num);  //     Search current XPDU map for this XPDU number
 					if ((oldXpdu != nbor.pXpduMap->end()) && 
-						(oldXpdu->second.xpduDesc == newNborMapEntry.xpduDesc))        //     If found and descriptors match
-					{
+						(oldXpdu->second.xpduDesc.check == newNborMapEntry.xpduDesc.check))  //     If found and check values match
+					{                                                                  //        (the TLVs are unchanged even if revision is not)
 						newNborMapEntry.pTlvs = oldXpdu->second.pTlvs;                 //          then copy pointers to tlvs in current XPDU map to new map
 						newNborMapEntry.sizeXpduTlvs = oldXpdu->second.sizeXpduTlvs;   //          and copy size
 						newNborMapEntry.status = RxXpduStatus::CURRENT;                //          and set status to current so don't request Extension LLDPDU
@@ -440,66 +515,86 @@ void LldpPort::LldpRxSM::xRxManifest(LldpPort& port, Lldpdu& rxLldpdu) // return
 							newNborMapEntry.sizeXpduTlvs = oldXpdu->second.sizeXpduTlvs;   //          and copy size
 							newNborMapEntry.status = RxXpduStatus::NEW;                    //          and set status to new so don't request Extension LLDPDU
 						}
+						else if ((oldXpdu != nbor.pNewXpduMap->end()) &&
+							(oldXpdu->second.xpduDesc == newNborMapEntry.xpduDesc) &&
+							((oldXpdu->second.status == RxXpduStatus::REQUESTED) ||
+							 (oldXpdu->second.status == RxXpduStatus::RETRIED)))           //     If found and descriptors match and already requested
+						{
+							newNborMapEntry.status = oldXpdu->second.status;               //          then request is still outstanding (and XREQ timer running)
+							newNborMapEntry.requestTime = oldXpdu->second.requestTime;
+							newNborMapEntry.deadline = oldXpdu->second.deadline;
+						}
 					}
 					pManXpduMap->insert(make_pair(newNborMapEntry.xpduDesc.num, newNborMapEntry));  //     Put xpdu map entry in map with key = xpdu number
 				}
+				if (!nbor.pNewXpduMap)                   // Convergence time runs from the first manifest not yet completed
+				{
+					nbor.manifestTime = SimLog::Time;
+					nbor.manifestXreqs = 0;
+					nbor.xreqRetries = 0;
+				}
 				nbor.pNewXpduMap = pManXpduMap;          // Store pointer to new XPDU map (overwriting pointer to any partially completed manifest
+				port.updateNborSize(nbor);
 
 				manifestComplete = xRxCheckManifest(port, nbor);
 			}
 		}
 
-		SimLog::logFile << "    After xRxManifest size of nbors is " << port.nborMIBs.size();
-		if ((port.nborMIBs.size() > 0) && (port.nborMIBs[0].pNewXpduMap))
+		if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_MIB))
 		{
-			SimLog::logFile << " and first nbor has XPDUs: ";
-			for (auto& mapEntry : (*port.nborMIBs[0].pNewXpduMap))
+			SimLog::logFile << "    After xRxManifest size of nbors is " << port.nborMIBs.size();
+			if ((port.nborMIBs.size() > 0) && (port.nborMIBs[0].pNewXpduMap))
 			{
-				SimLog::logFile << " xpdu " << (unsigned short)mapEntry.first;
-				SimLog::logFile << " has " << mapEntry.second.pTlvs.size() << " TLVs w/ status ";
-				SimLog::logFile << " status " << mapEntry.second.status << "; ";
+				SimLog::logFile << " and first nbor has XPDUs: ";
+				for (auto& mapEntry : (*port.nborMIBs[0].pNewXpduMap))
+				{
+					SimLog::logFile << " xpdu " << (unsigned short)mapEntry.first;
+					SimLog::logFile << " has " << mapEntry.second.pTlvs.size() << " TLVs w/ status ";
+					SimLog::logFile << " status " << mapEntry.second.status << "; ";
+				}
 			}
+			SimLog::logFile << " manifestComplete = " << manifestComplete << endl;
 		}
-		SimLog::logFile << " manifestComplete = " << manifestComplete << endl;
 
 		//TODO: init neighbor specific timers
 
 	}
 
 	// Store new neighbor MIB entry if have received all XPDUs
-	if (manifestComplete) rxUpdateInfo(port);
+	if (manifestComplete) rxUpdateInfo(port, port.nborMIBs[index]);
 
 //	return(manifestComplete);
 }
 
-void LldpPort::LldpRxSM::xRxXPDU(LldpPort& port, Lldpdu& rxLldpdu)  // returns true if manifest is complete
+void LldpPort::LldpRxSM::xRxXPDU(LldpPort& port, std::vector<TlvView>& rxTlvs)  // returns true if manifest is complete
 {
 	bool unexpectedXPDU = true;
 	bool manifestComplete = false;
 
-	std::vector<TLV>& rxTlvs = rxLldpdu.tlvs;
-
 	unsigned int index = findNborIndex(port, rxTlvs);
 	if ((index != port.nborMIBs.size()) && (port.nborMIBs[index].pNewXpduMap != nullptr)) // if found nbor and nbor has a new XPDU map
 	{
 		MibEntry& nbor = port.nborMIBs[index];
-		map<unsigned char, xpduMapEntry>& newXpduMap = *(nbor.pNewXpduMap);
-		tlvXID& rxXidTLV = static_cast<tlvXID&>(rxTlvs[2]);   // If got here, there must be XID TLV
+		XpduTable& newXpduMap = *(nbor.pNewXpduMap);
+		XidView rxXidTLV(rxTlvs[2]);                          // If got here, there must be XID TLV
 		xpduDescriptor rxDesc = rxXidTLV.getXpduDescriptor();
 
-		SimLog::logFile << "    Trying to find nbor new map entry for XPDU number " << (unsigned short)rxDesc.num << " rev " << (unsigned short)rxDesc.rev ;
-
 		auto mapEntry = newXpduMap.find(rxDesc.num);                    //     Search new XPDU map for this XPDU number
-	
-		if (mapEntry != newXpduMap.end())
-			SimLog::logFile << " success" << endl;
-		else
-			SimLog::logFile << " WITHOUT SUCCESS !!" << endl;
+
+		SIM_LOG(LOG_TRACE, LOG_LLDP_MIB) << "    Trying to find nbor new map entry for XPDU number " << (unsigned short)rxDesc.num
+			<< " rev " << (unsigned short)rxDesc.rev << ((mapEntry != newXpduMap.end()) ? " success" : " WITHOUT SUCCESS !!") << endl;
+
+		bool checkValid = (mapEntry != newXpduMap.end()) &&
+			(computeXpduCheck(rxTlvs, 3) == mapEntry->second.xpduDesc.check);   // Check value from the manifest
+		if ((mapEntry != newXpduMap.end()) && !checkValid)
+		{
+			SIM_LOG(LOG_EVENT, LOG_LLDP_MIB) << "    XPDU number " << (unsigned short)rxDesc.num << " failed check value" << endl;
+		}
 
 		if ((mapEntry != newXpduMap.end()) &&                       //     If found
 			((mapEntry->second.xpduDesc).rev == rxDesc.rev) &&            //        and revision matches
-			(port.lldpScopeAddress == rxXidTLV.getScopeAddr())         //        and scope address match
-			//TODO:  also need to calculate checksum and validate
+			(port.lldpScopeAddress == rxXidTLV.getScopeAddr()) &&      //        and scope address match
+			checkValid                                                 //        and TLVs match the check value
 			//TODO:  check that rxDesc.num > 0
 			)
 		{
@@ -511,118 +606,224 @@ void LldpPort::LldpRxSM::xRxXPDU(LldpPort& port, Lldpdu& rxLldpdu)  // returns t
 					mapEntry->second.sizeXpduTlvs += (2 + rxTlvs[i].getLength());   // update cumulative size of tlvs
 					mapEntry->second.pTlvs.push_back(make_shared<TLV>(rxTlvs[i]));  // copy TLVs and put pointers in map
 				}
+			if (mapEntry->second.requestTime >= 0)                      //          Measured from the first request, so an XPDU
+				rxRttSample(port, SimLog::Time - mapEntry->second.requestTime);   //  answering a retry overestimates (not underestimates) RTT
 			mapEntry->second.status = RxXpduStatus::NEW;                //          and set status
+			nbor.xreqRetries = 0;                                       //          Progress, so restart the backoff
 			unexpectedXPDU = false;
+			port.updateNborSize(nbor);
 
 			manifestComplete = xRxCheckManifest(port, nbor);
 		}
 
 	}
 
-	SimLog::logFile << "    After xRxXPDU for nbor " << index;
-	if ((port.nborMIBs.size() > 0) && (port.nborMIBs[index].pNewXpduMap))
+	if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_MIB))
 	{
-		SimLog::logFile << " and nbor has XPDUs: ";
-		for (auto& mapEntry : (*port.nborMIBs[index].pNewXpduMap))
+		SimLog::logFile << "    After xRxXPDU for nbor " << index;
+		if ((index < port.nborMIBs.size()) && (port.nborMIBs[index].pNewXpduMap))
 		{
-			SimLog::logFile << " xpdu " << (unsigned short)mapEntry.first;
-			SimLog::logFile << " has " << mapEntry.second.pTlvs.size() << " TLVs w/ status ";
-			SimLog::logFile << mapEntry.second.status << ";";
+			SimLog::logFile << " and nbor has XPDUs: ";
+			for (auto& mapEntry : (*port.nborMIBs[index].pNewXpduMap))
+			{
+				SimLog::logFile << " xpdu " << (unsigned short)mapEntry.first;
+				SimLog::logFile << " has " << mapEntry.second.pTlvs.size() << " TLVs w/ status ";
+				SimLog::logFile << mapEntry.second.status << ";";
+			}
 		}
+		SimLog::logFile << " with unexpected XPDU = " << unexpectedXPDU << endl;
 	}
-	SimLog::logFile << " with unexpected XPDU = " << unexpectedXPDU << endl;
 
 	// Store new neighbor MIB entry if have received all XPDUs
-	if (manifestComplete) rxUpdateInfo(port);
+	if (manifestComplete) rxUpdateInfo(port, port.nborMIBs[index]);
 
 //	return(manifestComplete);
 }
 
 bool LldpPort::LldpRxSM::xRxCheckManifest(LldpPort& port, MibEntry& nbor)  // returns true if manifest is complete
 {
+	//  Up to xreqWindow XPDUs may be outstanding (status REQUESTED or RETRIED) at once.  Each time this is called
+	//     (new manifest, XPDU received, or XREQ timeout) any free places in the window are filled by requesting
+	//     XPDUs with status UPDATE, in XPDU number order, with one XREQ.  Each requested XPDU has its own deadline, and
+	//     the XREQ timer runs to the earliest deadline of those outstanding, so refilling the window never pushes back
+	//     the time limit of an XPDU that was requested earlier.
 	bool manifestComplete = true;
-	bool xReqComplete = true;
-	xpduDescriptor first;
-	xpduDescriptor second;
-	unsigned char xpduCount = 0;
+	unsigned int outstanding = 0;
+	int earliest = SimTimeNever;
+	xpduDescriptor reqDescs[MaxXreqXpdus];
+	unsigned int xpduCount = 0;
 
 	for (auto& mapEntry : *nbor.pNewXpduMap)
-	{   // Search in order.  Important that request in order, so any with status Requested or Retried are before Update
+	{
 		RxXpduStatus xpduStatus = mapEntry.second.status;
 		if ((xpduStatus == RxXpduStatus::REQUESTED) || (xpduStatus == RxXpduStatus::RETRIED))
 		{
-			xReqComplete = false;
 			manifestComplete = false;
-			break;
+			outstanding++;
+			earliest = std::min(earliest, mapEntry.second.deadline);
 		}
-		if (xpduStatus == RxXpduStatus::UPDATE)
+		else if (xpduStatus == RxXpduStatus::UPDATE)
 		{
 			manifestComplete = false;
-			if (xpduCount < 2)
-			{
-				xpduCount++;
-				mapEntry.second.status = RxXpduStatus::REQUESTED;
-				if (xpduCount == 1)
-				{
-					first = mapEntry.second.xpduDesc;
-				}
-				else
-				{
-					second = mapEntry.second.xpduDesc;
-					break;
-				}
-			}
+			if (xpduCount < MaxXreqXpdus)
+				reqDescs[xpduCount++] = mapEntry.second.xpduDesc;
 		}
 	}
 
-	// Transmit XREQ if no outstanding requests, and more XPDUs to be updated, and attached to a MAC
-	if (xReqComplete && !manifestComplete && port.pIss && nbor.nborAddr)  
+	unsigned int window = (unsigned int)port.xreqWindow;
+	xpduCount = (outstanding >= window) ? 0 : std::min(xpduCount, window - outstanding);
+
+	// Transmit XREQ if room in the window, and more XPDUs to be updated, and attached to a MAC
+	if ((xpduCount > 0) && port.pIss && nbor.nborAddr)  
 	{
-		tlvREQ newReq(port.pIss->getMacAddress(), port.lldpScopeAddress, xpduCount);
-		newReq.putXpduDescriptor(0, first);
-		if (xpduCount > 1)
-			newReq.putXpduDescriptor(1, second);
-
-		shared_ptr<Lldpdu> pMyLldpdu = std::make_shared<Lldpdu>();      // Create LLDPDU
-		pMyLldpdu->tlvs.push_back(nbor.chassisID);                      // Add Chassis ID of nbor sourcing info
-		pMyLldpdu->tlvs.push_back(nbor.portID);                         // Add Port ID
-		pMyLldpdu->tlvs.push_back(newReq);                              // Copy XREQ TLV to LLDPDU
+		int requestTime = xreqTimeLimit(port, nbor, outstanding + xpduCount);
+		tlvREQ newReq(port.pIss->getMacAddress(), port.lldpScopeAddress, (unsigned char)xpduCount);
+		for (unsigned int i = 0; i < xpduCount; i++)
+		{
+			newReq.putXpduDescriptor(i, reqDescs[i]);
+			xpduMapEntry& reqEntry = nbor.pNewXpduMap->find(reqDescs[i].num)->second;
+			reqEntry.status = (reqEntry.requestTime < 0) ? RxXpduStatus::REQUESTED : RxXpduStatus::RETRIED;
+			if (reqEntry.requestTime < 0)
+				reqEntry.requestTime = SimLog::Time;
+			reqEntry.deadline = SimLog::Time + requestTime;
+		}
+		earliest = std::min(earliest, SimLog::Time + requestTime);
+
+		shared_ptr<Lldpdu> pMyLldpdu = FramePool::makeSdu<Lldpdu>();      // Create LLDPDU
+		pMyLldpdu->reserve(nbor.chassisID.view().size() + nbor.portID.view().size() + newReq.view().size());
+		pMyLldpdu->putTlv(nbor.chassisID);                              // Add Chassis ID of nbor sourcing info
+		pMyLldpdu->putTlv(nbor.portID);                                 // Add Port ID
+		pMyLldpdu->putTlv(newReq);                                      // Copy XREQ TLV to LLDPDU
 		unique_ptr<Frame> myFrame = make_unique<Frame>(nbor.nborAddr, port.pIss->getMacAddress(), (shared_ptr<Sdu>)pMyLldpdu);
 		port.pIss->Request(move(myFrame));                              // Transmit frame
+		nbor.manifestXreqs++;
+		port.stats.increment(STATS_FRAMES_OUT_TOTAL);
+		port.stats.increment(STATS_XREQ_OUT);
 
-		unsigned short requestTime = (nbor.rxTtl + 63) >> 5;            // Round up rxTTL/32, and add 1 (in case next timer tick comes immediately)
-		if (nbor.ttlTimer > requestTime)
+		if (SIM_LOG_ENABLED(LOG_EVENT, LOG_LLDP_MIB))
 		{
-			nbor.restoreTime = nbor.ttlTimer - requestTime;
-			nbor.ttlTimer = requestTime;
+			SimLog::logFile << "Time " << SimLog::Time << ": xRxCheckManifest transmitting XREQ to " << hex << nbor.nborAddr << dec << " for " << (unsigned short)newReq.getNumXpdus();
+			SimLog::logFile << ": xpdu num";
+			for (unsigned int i = 0; i < xpduCount; i++)
+				SimLog::logFile << " " << (unsigned short)reqDescs[i].num << " rev " << (unsigned short)reqDescs[i].rev << ((i + 1 < xpduCount) ? "," : "");
+			SimLog::logFile << " (" << outstanding << " outstanding) time limit " << requestTime << endl;
 		}
-		else
-			nbor.restoreTime = 0;
+	}
 
-		SimLog::logFile << "Time " << SimLog::Time << ": xRxCheckManifest transmitting XREQ to " << hex << nbor.nborAddr << dec << " for " << (unsigned short)newReq.getNumXpdus();
-		SimLog::logFile << ": xpdu num " << (unsigned short)newReq.getXpduDescriptor(0).num << " rev " << (unsigned short)newReq.getXpduDescriptor(0).rev;
-		if (xpduCount > 1)
-			SimLog::logFile << " and xpdu num " << (unsigned short)newReq.getXpduDescriptor(1).num << " rev " << (unsigned short)newReq.getXpduDescriptor(1).rev;
-		SimLog::logFile << " time limit " << requestTime << endl;
+	if (earliest == SimTimeNever)                    // Nothing outstanding
+		port.rxTimers.stop(nbor.xreqTimer);
+	else
+	{
+		unsigned int index = (unsigned int)(&nbor - port.nborMIBs.data());   // nbor is always an entry in nborMIBs
+		port.rxTimers.restart(nbor.xreqTimer, std::max(earliest - SimLog::Time, 1), XREQ_TIMER, index);
 	}
 
 	return (manifestComplete);
 }
 
-void LldpPort::LldpRxSM::rxUpdateInfo(LldpPort& port) 
+void LldpPort::LldpRxSM::rxUpdateInfo(LldpPort& port, MibEntry& nbor) 
 {
-	//TODO: update remote LLDP MIB entry for this neighbor
+	port.rxTimers.stop(nbor.xreqTimer);              // Have all requested XPDUs
+	if (nbor.pNewXpduMap)
+	{
+		if (nbor.manifestXreqs > 0)
+		{
+			nbor.convergenceTime = SimLog::Time - nbor.manifestTime;
+			SIM_LOG(LOG_EVENT, LOG_LLDP_MIB) << "Time " << SimLog::Time << ":    nbor " << hex << nbor.nborAddr << dec << " manifest converged in "
+				<< nbor.convergenceTime << " ticks with " << nbor.manifestXreqs << " XREQs" << endl;
+		}
+		nbor.pXpduMap = nbor.pNewXpduMap;            // Completed manifest becomes the current neighbor information
+		nbor.pNewXpduMap = nullptr;
+		port.updateNborSize(nbor);
+	}
 	//TODO: set something changed remote
 
 }
 
-void LldpPort::LldpRxSM::rxDeleteInfo(LldpPort& port)
+void LldpPort::LldpRxSM::rxDeleteInfo(LldpPort& port, unsigned int index)
 {
-	//TODO: delete remote LLDP MIB entry for this neighbor
+	SIM_LOG(LOG_EVENT, LOG_LLDP_MIB) << "Time " << SimLog::Time << ":    Deleting nbor " << index << " of " << port.nborMIBs.size() << endl;
+	port.removeNbor(index);                          // Also stops the neighbor's timers
 	//TODO: set something changed remote
 
 }
 
+void LldpPort::LldpRxSM::rxXreqTimeout(LldpPort& port, MibEntry& nbor)
+{
+	//  An outstanding XPDU has passed its deadline, so request the overdue XPDUs again (status RETRIED) with a
+	//     doubled time limit;  XPDUs still within their deadline stay outstanding.  After xreqMaxRetries timeouts with no XPDU received the new manifest is discarded,
+	//     so the next Manifest LLDPDU from the neighbor starts a fresh fetch rather than the neighbor information
+	//     waiting for the TTL to expire.  XPDUs answering an earlier request are still accepted.
+	if (!nbor.pNewXpduMap)
+		return;
+
+	for (auto& mapEntry : *nbor.pNewXpduMap)
+		if (((mapEntry.second.status == RxXpduStatus::REQUESTED) || (mapEntry.second.status == RxXpduStatus::RETRIED)) &&
+			(mapEntry.second.deadline <= SimLog::Time))
+			mapEntry.second.status = RxXpduStatus::UPDATE;
+
+	SIM_LOG(LOG_EVENT, LOG_LLDP_MIB) << "Time " << SimLog::Time << ":    XREQ timed out to " << hex << nbor.nborAddr << dec;
+	if (!(port.pIss && port.pIss->getOperational()))
+	{
+		SIM_LOG(LOG_EVENT, LOG_LLDP_MIB) << " so discarding new manifest" << endl;
+		nbor.pNewXpduMap = nullptr;
+		port.updateNborSize(nbor);
+	}
+	else if (nbor.xreqRetries >= (unsigned int)port.xreqMaxRetries)
+	{
+		SIM_LOG(LOG_EVENT, LOG_LLDP_MIB) << " after " << nbor.xreqRetries << " retries so discarding new manifest" << endl;
+		port.stats.increment(STATS_XREQ_ABANDONED);
+		nbor.pNewXpduMap = nullptr;
+		port.updateNborSize(nbor);
+	}
+	else
+	{
+		nbor.xreqRetries++;
+		port.stats.increment(STATS_XREQ_RETRIES);
+		SIM_LOG(LOG_EVENT, LOG_LLDP_MIB) << " so retrying (" << nbor.xreqRetries << ")" << endl;
+		xRxCheckManifest(port, nbor);
+	}
+}
+
+void LldpPort::LldpRxSM::rxRttSample(LldpPort& port, int rtt)
+{
+	int sample = rtt << 3;                           // In eighths of a tick
+	if (port.xreqSrtt == 0)                          // First measurement
+	{
+		port.xreqSrtt = std::max(sample, 1);
+		port.xreqRttvar = sample >> 1;
+	}
+	else
+	{
+		int err = sample - port.xreqSrtt;
+		port.xreqSrtt = std::max(port.xreqSrtt + (err >> 3), 1);           // srtt = 7/8 srtt + 1/8 rtt
+		port.xreqRttvar += ((err < 0 ? -err : err) - port.xreqRttvar) >> 2; // rttvar = 3/4 rttvar + 1/4 |err|
+	}
+}
+
+int LldpPort::LldpRxSM::xreqTimeLimit(LldpPort& port, MibEntry& nbor, unsigned int xpdus)
+{
+	//  Ticks to wait for requested XPDUs:  srtt + 4 * rttvar (at least one tick) once the round trip time has been
+	//     measured.  Before that it is estimated from the link:  the XREQ and the XPDUs each cross the link (taken as
+	//     full size frames, so the estimate errs long) and are received a tick later, with the xpdus outstanding
+	//     arriving no faster than one a tick.  rxTTL/32 rounded up is used only when the ISS does not know its link.
+	//     One tick is added in case the next timer tick comes immediately, and the result is doubled for each retry,
+	//     up to the neighbor's TTL.
+	int limit;
+	int transit = port.pIss ? port.pIss->getTransitTime(MaxXpduOctets) : -1;
+	if ((port.xreqSrtt == 0) && (transit < 0))
+		limit = (nbor.rxTtl + 63) >> 5;
+	else if (port.xreqSrtt == 0)
+	{
+		int serialization = std::max(transit - port.pIss->getTransitTime(0), 1);
+		limit = (2 * (transit + 1)) + (int)(xpdus * serialization) + 1;
+	}
+	else
+		limit = ((port.xreqSrtt + std::max(4 * port.xreqRttvar, 8) + 7) >> 3) + 1;
+	long long backoff = (long long)limit << std::min(nbor.xreqRetries, 16u);   // Shifted in 64 bits so it cannot overflow
+	return ((int)std::max(std::min(backoff, (long long)nbor.rxTtl), 1LL));
+}
+
 /*
 void LldpPort::LldpRxSM::generateXREQ(LldpPort& port)
 {
@@ -649,21 +850,13 @@ void LldpPort::LldpRxSM::generateXREQ(LldpPort& port)
 }
  /**/
 
-unsigned int LldpPort::LldpRxSM::findNborIndex(LldpPort& port, std::vector<TLV>& tlvs)
+unsigned int LldpPort::LldpRxSM::findNborIndex(LldpPort& port, std::vector<TlvView>& tlvs)
 {
-	unsigned int index = 0;
-	bool foundNbor = false;
-	for (index = 0; !foundNbor && index < port.nborMIBs.size(); index++)
-	{
-		foundNbor = ((port.nborMIBs[index].chassisID == tlvs[0]) &&
-			(port.nborMIBs[index].portID == tlvs[1]));
-	}
-	if (foundNbor) index--;
+	unsigned int index = port.findNbor(tlvs[0], tlvs[1]);
+	bool foundNbor = (index < port.nborMIBs.size());
 
-	SimLog::logFile << "    LLDPDU is from a known neighbor is ";
-	if (foundNbor) SimLog::logFile << "true ";
-	else SimLog::logFile << "false ";
-	SimLog::logFile << " and index is " << index << endl;
+	SIM_LOG(LOG_TRACE, LOG_LLDP_RX) << "    LLDPDU is from a known neighbor is " << (foundNbor ? "true " : "false ")
+		<< " and index is " << index << endl;
 
 	return (index);        // index will equal nborMIBs.size if no matching neighbor found
 }
@@ -671,20 +864,16 @@ unsigned int LldpPort::LldpRxSM::findNborIndex(LldpPort& port, std::vector<TLV>&
 
  bool LldpPort::LldpRxSM::roomForNewNeighbor(LldpPort& port, unsigned long newNborSize)
  {
-	 unsigned long long currentSize = 0;
-	 for (auto& entry : port.nborMIBs)
-		 currentSize += entry.totalSize;
-	 return (currentSize + newNborSize < port.maxSizeNborMIBs);
+	 return (port.nborMibUsage.size + newNborSize < port.maxSizeNborMIBs);
  }
 /**/
 
- void LldpPort::LldpRxSM::createNeighbor(LldpPort& port, std::vector<TLV>& tlvs, bool copyTlvs)
+ void LldpPort::LldpRxSM::createNeighbor(LldpPort& port, std::vector<TlvView>& tlvs, bool copyTlvs)
  {
 	 MibEntry newNbor;                   // Create a MIB entry for new neighbor
 	 newNbor.chassisID = tlvs[0];        // Fill in Chassis ID, Port ID, and TTL
 	 newNbor.portID = tlvs[1];
-	 newNbor.rxTtl = (static_cast<TlvTtl&>(tlvs[2])).getTtl();
-	 newNbor.ttlTimer = 0;               // Initialize timer to zero, in case just received Manifest LLDPDU
+	 newNbor.rxTtl = TtlView(tlvs[2]).getTtl();
 
 	 xpduMapEntry newNborMapEntry;        // Create xpdu map entry for Normal LLDPDU
 	 newNborMapEntry.sizeXpduTlvs = 6+ newNbor.chassisID.getLength() + newNbor.portID.getLength(); // in this entry include first 3 tlv lengths
@@ -696,13 +885,23 @@ unsigned int LldpPort::LldpRxSM::findNborIndex(LldpPort& port, std::vector<TLV>&
 			 newNborMapEntry.sizeXpduTlvs += (2 + tlvs[i].getLength());   // update cumulative size of tlvs
 			 newNborMapEntry.pTlvs.push_back(make_shared<TLV>(tlvs[i]));  // copy TLVs and put pointers in map
 		 }
+	 if (copyTlvs)
+		 newNborMapEntry.tlvsDigest = hashTlvs(tlvs, 3, newNborMapEntry.tlvsLength);
 	 newNbor.pXpduMap->insert(make_pair(0, newNborMapEntry));  // Put xpdu map entry in map with key=0
 
-	 port.nborMIBs.push_back(newNbor);   // Add MIB entry to list of neighbors
+	 port.addNbor(newNbor);              // Add MIB entry to list of neighbors
+	 MibEntry& nbor = port.nborMIBs.back();
+	 port.rxTimers.restart(nbor.ttlTimer, nbor.rxTtl, TTL_TIMER, (unsigned int)port.nborMIBs.size() - 1);
  }
 
- bool LldpPort::LldpRxSM::compareTlvs(vector<shared_ptr<TLV>>& pTlvs, vector<TLV>& rxTlvs)
+ bool LldpPort::LldpRxSM::compareTlvs(const xpduMapEntry& xpdu, vector<TlvView>& rxTlvs, unsigned long long rxDigest, unsigned long rxLength)
  {
+	 //  rxDigest and rxLength are from hashTlvs(rxTlvs, 3, rxLength).  Different lengths or digests mean the TLVs changed,
+	 //     so the TLVs are only compared octet by octet to confirm a digest match.
+	 if ((rxLength != xpdu.tlvsLength) || (rxDigest != xpdu.tlvsDigest))
+		 return (false);
+
+	 const vector<shared_ptr<TLV>>& pTlvs = xpdu.pTlvs;
 	 bool tlvsMatch = pTlvs.size() == (rxTlvs.size() - 3);            // potential match if have the same number of TLVs
 	 if (tlvsMatch && (rxTlvs.size() > 3))                            // see if new TLVs match old
 		 for (unsigned int i = 0; i < (rxTlvs.size() - 3); i++)
@@ -711,36 +910,78 @@ unsigned int LldpPort::LldpRxSM::findNborIndex(LldpPort& port, std::vector<TLV>&
 	 return (tlvsMatch);  // Note returns true if no TLVs as well as if all TLVs are the same
  }
 
- void LldpPort::LldpRxSM::rxXREQ(LldpPort& port, Lldpdu& rxLldpdu)
+ void LldpPort::LldpRxSM::rxXREQ(LldpPort& port, std::vector<TlvView>& rxTlvs)
  {
-	 // Think have already done all necessary validation.  Just send XPDU
+	 // Think have already done all necessary validation.  Just queue the XPDUs for sendXpduResponses()
 
-	 tlvREQ& rxXreqTLV = static_cast<tlvREQ&>(rxLldpdu.tlvs[2]);   // If got here, there must be XREQ TLV
+	 XreqView rxXreqTLV(rxTlvs[2]);                                // If got here, there must be XREQ TLV
 	 unsigned short numReq = rxXreqTLV.getNumXpdus();
-	 SimLog::logFile << "Time " << SimLog::Time << ":        Receiving XREQ for " << numReq << " XPDUs" << endl;
+	 unsigned long long returnAddr = rxXreqTLV.getReturnAddr();
+	 SIM_LOG(LOG_EVENT, LOG_LLDP_RX) << "Time " << SimLog::Time << ":        Receiving XREQ for " << numReq << " XPDUs" << endl;
 	 for (unsigned short i = 0; i < numReq; i++)
 	 {
 		 xpduDescriptor desc = rxXreqTLV.getXpduDescriptor(i);     // Get the requested XPDU descriptor
 		 auto xpdu = port.localMIB.pXpduMap->find(desc.num);       // Search local MIB for that XPDU number
 		 if ((xpdu != port.localMIB.pXpduMap->end()) &&            //     If found
-			 (xpdu->second.xpduDesc == desc) && port.pIss)         //        and descriptor matches and attached to sublayer
+			 (xpdu->second.xpduDesc == desc))                      //        and descriptor matches
 		 {
-			 shared_ptr<Lldpdu> pMyLldpdu = std::make_shared<Lldpdu>();                 // Create LLDPDU
-			 pMyLldpdu->tlvs.push_back(port.localMIB.chassisID);                        // Add Chassis ID 
-			 pMyLldpdu->tlvs.push_back(port.localMIB.portID);                           // Add Port ID
-			 pMyLldpdu->tlvs.push_back(tlvXID(port.lldpScopeAddress, desc));            // Create XID TLV
-			 for (auto& pInfoTLV : xpdu->second.pTlvs)                                // append information TLVs
-				 pMyLldpdu->tlvs.push_back(*pInfoTLV);
-			 unique_ptr<Frame> myFrame = make_unique<Frame>(rxXreqTLV.getReturnAddr(),  // Wrap it in a frame
-				 port.pIss->getMacAddress(), (shared_ptr<Sdu>)pMyLldpdu);
-			 port.pIss->Request(move(myFrame));                                         // Transmit the XPDU
-
-			 SimLog::logFile << "             Sending XPDU frame for num " << (unsigned short)desc.num << " rev " << (unsigned short)desc.rev << endl;
-			 tlvXID& newXid = static_cast<tlvXID&>(pMyLldpdu->tlvs[2]);
+			 auto response = std::make_pair(returnAddr, desc.num);
+			 if (std::find(port.txXpduResponses.begin(), port.txXpduResponses.end(), response) == port.txXpduResponses.end())
+				 port.txXpduResponses.push_back(response);         //     then queue it, unless already queued this tick
 		 }
 	 }
  }
 
+ void LldpPort::LldpRxSM::sendXpduResponses(LldpPort& port)
+ {
+	 //  Called once per run after the receive state machine, so repeated requests for an XPDU from the same
+	 //     requester in a tick get one response.  Each response shares the cached Extension LLDPDU for the XPDU.
+	 if (port.pIss)                                                // If attached to sublayer
+	 {
+		 for (auto& response : port.txXpduResponses)
+		 {
+			 auto xpdu = port.localMIB.pXpduMap->find(response.second);
+			 if (xpdu == port.localMIB.pXpduMap->end())
+				 continue;
+			 unique_ptr<Frame> myFrame = make_unique<Frame>(response.first,   // Wrap it in a frame
+				 port.pIss->getMacAddress(), (shared_ptr<Sdu>)getXpduLldpdu(port, xpdu->second));
+			 port.pIss->Request(move(myFrame));                                 // Transmit the XPDU
+			 port.stats.increment(STATS_FRAMES_OUT_TOTAL);
+			 port.stats.increment(STATS_XPDU_OUT);
+
+			 SIM_LOG(LOG_EVENT, LOG_LLDP_TX) << "             Sending XPDU frame for num " << (unsigned short)xpdu->second.xpduDesc.num
+				 << " rev " << (unsigned short)xpdu->second.xpduDesc.rev << endl;
+		 }
+	 }
+	 port.txXpduResponses.clear();
+ }
+
+ shared_ptr<Lldpdu> LldpPort::LldpRxSM::getXpduLldpdu(LldpPort& port, const xpduMapEntry& xpdu)
+ {
+	 //  The Extension LLDPDU for an XPDU is encoded when first requested after the XPDU revision changes
+	 //     (updateManifest() discards the encoded LLDPDU), and is otherwise shared by every response.
+	 unsigned char num = xpdu.xpduDesc.num;
+	 if (num >= port.pTxXpduLldpdus.size())
+		 port.pTxXpduLldpdus.resize(num + 1);
+	 shared_ptr<Lldpdu>& pCached = port.pTxXpduLldpdus[num];
+
+	 if (!pCached)
+	 {
+		 pCached = FramePool::makeSdu<Lldpdu>();                                   // Create LLDPDU
+		 tlvXID xid(port.lldpScopeAddress, xpdu.xpduDesc);                         // Create XID TLV
+		 size_t pduSize = port.localMIB.chassisID.view().size() + port.localMIB.portID.view().size() + xid.view().size();
+		 for (auto& pInfoTLV : xpdu.pTlvs)
+			 pduSize += pInfoTLV->view().size();
+		 pCached->reserve(pduSize);
+		 pCached->putTlv(port.localMIB.chassisID);                                // Add Chassis ID 
+		 pCached->putTlv(port.localMIB.portID);                                   // Add Port ID
+		 pCached->putTlv(xid);                                                    // Add XID TLV
+		 for (auto& pInfoTLV : xpdu.pTlvs)                                        // append information TLVs
+			 pCached->putTlv(*pInfoTLV);
+	 }
+	 return (pCached);
+ }
+
 
 
 
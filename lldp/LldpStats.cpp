@@ -0,0 +1,62 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "LldpStats.h"
+
+
+const char* lldpStatisticName(LldpStatistics stat)
+{
+	static const char* names[LLDP_STATS_COUNT] = { "statsFramesOutTotal", "statsFramesInTotal", "statsFramesDiscardedTotal",
+		"statsFramesInErrorsTotal", "statsTLVsDiscardedTotal", "statsTLVsUnrecognizedTotal", "statsAgeoutsTotal",
+		"remTablesInserts", "remTablesDeletes", "remTablesDrops", "xreqOut", "xreqIn", "xpduOut", "xpduIn",
+		"xreqRetries", "xreqAbandoned" };
+	return ((stat < LLDP_STATS_COUNT) ? names[stat] : "unknown");
+}
+
+
+LldpStatsSnapshot::LldpStatsSnapshot()
+{
+	for (auto& counter : counters)
+		counter = 0;
+}
+
+LldpStatsSnapshot& LldpStatsSnapshot::operator+= (const LldpStatsSnapshot& other)
+{
+	for (int i = 0; i < LLDP_STATS_COUNT; i++)
+		counters[i] += other.counters[i];
+	return (*this);
+}
+
+
+LldpStatsBlock::LldpStatsBlock()
+{
+	clear();
+}
+
+LldpStatsSnapshot LldpStatsBlock::snapshot() const
+{
+	LldpStatsSnapshot copy;
+	for (int i = 0; i < LLDP_STATS_COUNT; i++)
+		copy.counters[i] = counters[i].load(std::memory_order_relaxed);
+	return (copy);
+}
+
+void LldpStatsBlock::clear()
+{
+	for (auto& counter : counters)
+		counter.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,94 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <atomic>
+
+/*
+*   LLDP agent statistics:  the IEEE Std 802.1AB statistics of a port (frames, TLVs, ageouts), the remote systems
+*      table statistics (inserts, deletes, drops, ageouts), and counters for the LLDPv2 Extension LLDPDU exchange.
+*/
+
+enum LldpStatistics {
+	STATS_FRAMES_OUT_TOTAL,           // statsFramesOutTotal:  all LLDPDUs transmitted (including XREQ and XPDU)
+	STATS_FRAMES_IN_TOTAL,            // statsFramesInTotal:  valid LLDPDUs received
+	STATS_FRAMES_DISCARDED_TOTAL,     // statsFramesDiscardedTotal
+	STATS_FRAMES_IN_ERRORS_TOTAL,     // statsFramesInErrorsTotal:  invalid LLDPDUs received
+	STATS_TLVS_DISCARDED_TOTAL,       // statsTLVsDiscardedTotal:  TLVs ignored after the End Of LLDPDU TLV
+	STATS_TLVS_UNRECOGNIZED_TOTAL,    // statsTLVsUnrecognizedTotal:  TLVs of a reserved type
+	STATS_AGEOUTS_TOTAL,              // statsAgeoutsTotal:  neighbors deleted because their TTL expired
+	STATS_REM_TABLES_INSERTS,         // remTablesInserts:  neighbors added
+	STATS_REM_TABLES_DELETES,         // remTablesDeletes:  neighbors deleted (for any reason)
+	STATS_REM_TABLES_DROPS,           // remTablesDrops:  new neighbors not added for lack of room
+	STATS_XREQ_OUT,                   // XREQ LLDPDUs transmitted
+	STATS_XREQ_IN,                    // XREQ LLDPDUs received
+	STATS_XPDU_OUT,                   // Extension LLDPDUs transmitted
+	STATS_XPDU_IN,                    // Extension LLDPDUs received
+	STATS_XREQ_RETRIES,               // XREQ timeouts followed by a retry
+	STATS_XREQ_ABANDONED,             // New manifests discarded after xreqMaxRetries timeouts
+	LLDP_STATS_COUNT
+};
+
+const char* lldpStatisticName(LldpStatistics stat);
+
+
+/*
+*   LldpStatsSnapshot is a copy of a set of counters at one time, and can be summed over ports.
+*/
+
+class LldpStatsSnapshot
+{
+public:
+	LldpStatsSnapshot();
+
+	unsigned long long counters[LLDP_STATS_COUNT];
+
+	unsigned long long get(LldpStatistics stat) const { return (counters[stat]); }
+	LldpStatsSnapshot& operator+= (const LldpStatsSnapshot& other);
+};
+
+
+/*
+*   LldpStatsBlock holds the counters of one port.
+*   Counters are only written by the thread running the port, so increment() is a relaxed load and store (no locked
+*      read-modify-write), while any other thread can take a snapshot() at any time.  The block is padded so
+*      counters of ports run on different threads never share a cache line.
+*/
+
+class LldpStatsBlock
+{
+public:
+	LldpStatsBlock();
+	~LldpStatsBlock() {}
+	LldpStatsBlock(LldpStatsBlock& copySource) = delete;             // Disable copy constructor
+	LldpStatsBlock& operator= (const LldpStatsBlock&) = delete;      // Disable assignment operator
+
+	void increment(LldpStatistics stat, unsigned long long amount = 1)
+	{
+		counters[stat].store(counters[stat].load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+	unsigned long long get(LldpStatistics stat) const
+	{
+		return (counters[stat].load(std::memory_order_relaxed));
+	}
+	LldpStatsSnapshot snapshot() const;
+	void clear();                          // Not thread safe with increment()
+
+private:
+	char pad0[CacheLineSize];
+	std::atomic<unsigned long long> counters[LLDP_STATS_COUNT];
+	char pad1[CacheLineSize];
+};
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "LldpPort.h"
+#include "Trace.h"
 
 /**/
 void LldpPort::LldpTxSM::reset(LldpPort& port)
@@ -24,9 +25,9 @@ void LldpPort::LldpTxSM::reset(LldpPort& port)
 }
 
 /**/
-void LldpPort::LldpTxSM::timerTick(LldpPort& port)
+void LldpPort::LldpTxSM::timerTick(LldpPort& port, int ticks)
 {
-	if (port.LLDP_txShutdownWhile > 0) port.LLDP_txShutdownWhile--;
+	port.LLDP_txShutdownWhile = std::max(port.LLDP_txShutdownWhile - ticks, 0);
 }
 /**/
 
@@ -75,6 +76,7 @@ bool LldpPort::LldpTxSM::stepTxSM(LldpPort& port)
 	}
 	if (nextTxSmState != TxSmStates::NO_STATE)
 	{
+		Trace::record(TRACE_LLDP_TX_STATE, port.chassisId, (uint16_t)port.portId, 0, port.TxSmState, nextTxSmState);
 		port.TxSmState = nextTxSmState;
 		transitionTaken = true;
 	}
@@ -139,13 +141,13 @@ bool LldpPort::LldpTxSM::transmitLldpdu(LldpPort& port, int TTL)
     if (port.pIss && port.pIss->getOperational())  // Transmit frame only if MAC won't immediately discard
 	{
 		unsigned long long mySA = port.pIss->getMacAddress();
-		shared_ptr<Lldpdu> pMyLldpdu = std::make_shared<Lldpdu>();
-		prepareLldpdu(port, *pMyLldpdu, TTL);
+		shared_ptr<Lldpdu> pMyLldpdu = getTxLldpdu(port, TTL);
 		unique_ptr<Frame> myFrame = make_unique<Frame>(port.lldpScopeAddress, mySA, (shared_ptr<Sdu>)pMyLldpdu);
 		port.pIss->Request(move(myFrame));
+		port.stats.increment(STATS_FRAMES_OUT_TOTAL);
 		success = true;
 
-		if ((SimLog::Debug > 4))
+		if (SIM_LOG_ENABLED(LOG_EVENT, LOG_LLDP_TX))
 		{
 			// SimLog::logFile << "Time " << SimLog::Time << ":  Transmit LACPDU" 
 			SimLog::logFile << "Time " << SimLog::Time << ":  Transmit LLDPDU from" 
@@ -157,7 +159,7 @@ bool LldpPort::LldpTxSM::transmitLldpdu(LldpPort& port, int TTL)
 	} 
 	else 
 	{
-		if ((SimLog::Debug > 9))
+		if (SIM_LOG_ENABLED(LOG_DETAIL, LOG_LLDP_TX))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":  Can't transmit LLDPDU from down port " << hex << port.pIss->getMacAddress() << dec << endl;
 		}
@@ -168,6 +170,44 @@ bool LldpPort::LldpTxSM::transmitLldpdu(LldpPort& port, int TTL)
 }
 
 
+shared_ptr<Lldpdu> LldpPort::LldpTxSM::getTxLldpdu(LldpPort& port, unsigned short TTL)
+{
+	//  The LLDPDU is encoded from the local MIB only when the local MIB changes (updateManifest() discards the
+	//     encoded LLDPDU), and is otherwise shared by every Frame transmitted.  If only the TTL differs, a copy
+	//     is made with the new TTL, since the LLDPDU may still be in Frames in flight.
+	unsigned long long mySA = port.pIss->getMacAddress();
+	shared_ptr<Lldpdu>& pCached = (TTL > 0) ? port.pTxNormalLldpdu : port.pTxShutdownLldpdu;
+
+	if (!pCached || ((TTL > 0) && (port.txLldpduSA != mySA)))
+	{
+		pCached = FramePool::makeSdu<Lldpdu>();
+		prepareLldpdu(port, *pCached, TTL);
+		if (TTL > 0)
+			port.txLldpduSA = mySA;
+	}
+	else if (pCached->rxTTL != TTL)
+	{
+		shared_ptr<Lldpdu> pPatched = FramePool::makeSdu<Lldpdu>();
+		pPatched->copyPdu(*pCached);
+		pPatched->putTtl(TTL);
+		pCached = pPatched;
+	}
+
+	unsigned char ttlTlv[4] = { (unsigned char)(TLVtypes::TTL << 1), 2, (unsigned char)(TTL >> 8), (unsigned char)(TTL & 0xFF) };
+	if (SIM_LOG_ENABLED(LOG_TRACE, LOG_LLDP_TX))
+	{
+		SimLog::logFile << "1st TLV: ";
+		port.localMIB.chassisID.printBytes();
+		SimLog::logFile << endl << "2nd TLV: ";
+		port.localMIB.portID.printBytes();
+		SimLog::logFile << endl << "3rd TLV: ";
+		TlvView(ttlTlv).printBytes();
+		SimLog::logFile << endl;
+	}
+
+	return (pCached);
+}
+
 void LldpPort::LldpTxSM::prepareLldpdu(LldpPort& port, Lldpdu& myLldpdu, unsigned short TTL)
 {
 	myLldpdu.TimeStamp = SimLog::Time;
@@ -177,35 +217,36 @@ void LldpPort::LldpTxSM::prepareLldpdu(LldpPort& port, Lldpdu& myLldpdu, unsigne
 	myLldpdu.rxTTL = TTL;
 	/**/
 
-	myLldpdu.tlvs.push_back(port.localMIB.chassisID);     // Copy Chassis ID TLV
-	myLldpdu.tlvs.push_back(port.localMIB.portID);        // Copy Port ID TLV
-//	myLldpdu.tlvs.push_back(port.localMIB.ttl);           // Copy TTL TLV
-	myLldpdu.tlvs.push_back(TlvTtl(TTL));                 // Create TTL TLV on tlvs vector
+	TlvTtl ttl(TTL);                                      // Create TTL TLV
+	size_t pduSize = port.localMIB.chassisID.view().size() + port.localMIB.portID.view().size() + ttl.view().size();
+	auto xpdu0 = port.localMIB.pXpduMap->find(0);         // Get xpdu Map entry pair for XPDU 0 (Normal LLDPDU)
+	if ((TTL > 0) && (xpdu0 != port.localMIB.pXpduMap->end()))
+	{
+		for (auto& pTlv : xpdu0->second.pTlvs)
+			pduSize += pTlv->view().size();
+		pduSize += 12 + (6 * (port.localMIB.pXpduMap->size() - 1));    // Manifest TLV
+	}
+	myLldpdu.reserve(pduSize);                            // Encode into a single buffer
 
-	SimLog::logFile << "1st TLV: ";
-	myLldpdu.tlvs[0].printBytes();
-	SimLog::logFile << endl << "2nd TLV: ";
-	myLldpdu.tlvs[1].printBytes();
-	SimLog::logFile << endl << "3rd TLV: ";
-	myLldpdu.tlvs[2].printBytes();
-	SimLog::logFile << endl ;
+	myLldpdu.putTlv(port.localMIB.chassisID);             // Copy Chassis ID TLV
+	myLldpdu.putTlv(port.localMIB.portID);                // Copy Port ID TLV
+	myLldpdu.putTlv(ttl);                                 // Copy TTL TLV
 
 	if (TTL > 0)               // if not shutdown then add TLVs (else done)
 	{
-		auto xpdu0 = port.localMIB.pXpduMap->find(0);     // Get xpdu Map entry pair for XPDU 0 (Normal LLDPDU)
 		if (xpdu0 != port.localMIB.pXpduMap->end())
 		{
-			for (auto pTlv : xpdu0->second.pTlvs)       // Copy all TLVs to LLDPDU
+			for (auto& pTlv : xpdu0->second.pTlvs)      // Copy all TLVs to LLDPDU
 			{
-				myLldpdu.tlvs.push_back(*pTlv);
+				myLldpdu.putTlv(*pTlv);
 			}
 		}
 		else
-			SimLog::logFile << "local MIB entry has invalid first pManXpdu" << endl;
+			SIM_LOG(LOG_EVENT, LOG_LLDP_TX) << "local MIB entry has invalid first pManXpdu" << endl;
 		/**/
 
 
-		map<unsigned char, xpduMapEntry>& myMap = *(port.localMIB.pXpduMap);
+		XpduTable& myMap = *(port.localMIB.pXpduMap);
 		//	if (port.lldpV2Enabled && (myMap.size() > 1))       // If LLDPV2 and have xpdus in manifest
 		if ((myMap.size() > 1))       // If  have xpdus in manifest   // send even if not v2 for testing
 		{
@@ -214,26 +255,26 @@ void LldpPort::LldpTxSM::prepareLldpdu(LldpPort& port, Lldpdu& myLldpdu, unsigne
 			unsigned long totalSize = myMap.at(0).sizeXpduTlvs;  // Init total size with size of Normal LLDPDU
 			tlvManifest manifest(port.pIss->getMacAddress(), numXpdus);
 
-			SimLog::logFile << "    Creating manifest for " << (unsigned short)manifest.getNumXpdus() << " XPDUs" 
+			SIM_LOG(LOG_DETAIL, LOG_LLDP_TX) << "    Creating manifest for " << (unsigned short)manifest.getNumXpdus() << " XPDUs" 
 				<< hex << " return " << manifest.getReturnAddr() << " : " << (unsigned short)manifest.getChar(2) << dec << endl;
 
 			unsigned short position = 0;
 			for (auto& xpduMapPair : myMap)
 			{
-				SimLog::logFile << "        myMap XPDU " << (unsigned short)xpduMapPair.first;
+				SIM_LOG(LOG_DETAIL, LOG_LLDP_TX) << "        myMap XPDU " << (unsigned short)xpduMapPair.first;
 				if (xpduMapPair.first != 0)                          //  For all map entries except the Normal LLDPDU entry
 				{
 					totalSize += xpduMapPair.second.sizeXpduTlvs;                        // update the total MIB size
 					manifest.putXpduDescriptor(position, xpduMapPair.second.xpduDesc);   // put XPDU descriptor in manifest TLV
 					xpduDescriptor myDesc = xpduMapPair.second.xpduDesc;
-					SimLog::logFile << "    Pushing manifest XPDU " << (unsigned short)myDesc.num << " / " << (unsigned short)myDesc.rev 
+					SIM_LOG(LOG_DETAIL, LOG_LLDP_TX) << "    Pushing manifest XPDU " << (unsigned short)myDesc.num << " / " << (unsigned short)myDesc.rev 
 						<< " / " << hex << myDesc.check << " at position " << position << dec << endl;
 					position++;                                                          // increment position in manifest TLV
 				}
 				else 
-					SimLog::logFile << "    Gets no entry in the manifest at position " << position << endl;
+					SIM_LOG(LOG_DETAIL, LOG_LLDP_TX) << "    Gets no entry in the manifest at position " << position << endl;
 			}
-			myLldpdu.tlvs.push_back(manifest);
+			myLldpdu.putTlv(manifest);
 		}
 
 
@@ -248,10 +289,10 @@ void LldpPort::LldpTxTimerSM::reset(LldpPort& port)
 }
 
 /**/
-void LldpPort::LldpTxTimerSM::timerTick(LldpPort& port)
+void LldpPort::LldpTxTimerSM::timerTick(LldpPort& port, int ticks)
 {
-	if (port.txCredit < port.txCreditMax) port.txCredit++;
-	if (port.LLDP_txTTR > 0) port.LLDP_txTTR--;
+	port.txCredit = std::max(port.txCredit, std::min(port.txCredit + ticks, port.txCreditMax));
+	port.LLDP_txTTR = std::max(port.LLDP_txTTR - ticks, 0);
 }
 /**/
 
@@ -305,6 +346,7 @@ bool LldpPort::LldpTxTimerSM::stepTxSM(LldpPort& port)
 	}
 	if (nextTxTimerSmState != TxTimerSmStates::NO_STATE)
 	{
+		Trace::record(TRACE_LLDP_TX_TIMER_STATE, port.chassisId, (uint16_t)port.portId, 0, port.TxTimerSmState, nextTxTimerSmState);
 		port.TxTimerSmState = nextTxTimerSmState;
 		transitionTaken = true;
 	}
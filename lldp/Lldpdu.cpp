@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include "stdafx.h"
+#include <cstring>
 #include "Lldpdu.h"
 
 xpduDescriptor::xpduDescriptor(unsigned char numIn, unsigned char revIn, unsigned long checkIn)
@@ -35,6 +36,160 @@ bool xpduDescriptor::operator== (xpduDescriptor& desc)
 }
 
 
+static const unsigned char EndTlv[2] = { 0, 0 };      // What a default TlvView looks at
+
+unsigned long long hashBytes(const unsigned char* pBytes, size_t length, unsigned long long seed)
+{
+	//  Takes eight octets at a time, multiplying each word into the hash, then mixes the result (as in the
+	//     MurmurHash3 finalizer) so every input bit affects every output bit.
+	const unsigned long long mult = 0x9E3779B97F4A7C15ULL;
+	unsigned long long h = seed ^ (length * mult);
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8)
+	{
+		unsigned long long word;
+		memcpy(&word, pBytes + i, 8);
+		h = (h ^ (word * mult)) * 0xBF58476D1CE4E5B9ULL;
+		h ^= (h >> 31);
+	}
+	unsigned long long tail = 0;
+	for (size_t j = 0; i + j < length; j++)
+		tail |= (unsigned long long)pBytes[i + j] << (8 * j);
+	h = (h ^ (tail * mult)) * 0xBF58476D1CE4E5B9ULL;
+
+	h ^= (h >> 33);
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= (h >> 33);
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	h ^= (h >> 33);
+	return (h);
+}
+
+TlvView::TlvView(const unsigned char* pTlv)
+	: p(pTlv ? pTlv : EndTlv)
+{
+}
+
+bool TlvView::operator== (const TlvView& tlv) const
+{
+	return ((size() == tlv.size()) && (memcmp(p, tlv.p, size()) == 0));
+}
+
+unsigned long long TlvView::hash(unsigned long long seed) const
+{
+	return (hashBytes(p, size(), seed));
+}
+
+const unsigned char* TlvView::data() const
+{
+	return (p);
+}
+
+unsigned short TlvView::size() const
+{
+	return (getLength() + 2);
+}
+
+unsigned short TlvView::getType() const
+{
+	return (p[0] >> 1);
+}
+
+unsigned short TlvView::getLength() const
+{
+	unsigned short len = (((p[0] & 0x01) << 8) + p[1]);
+	return (len);
+}
+
+unsigned char TlvView::getChar(unsigned short offset) const
+{
+	unsigned char output = 0;
+	if ((offset + 1) <= size())                                  // If valid offset
+		output = p[offset];
+	return (output);                                             //    return data, else return 0
+}
+
+unsigned short TlvView::getShort(unsigned short offset) const
+{
+	unsigned short output = 0;
+	if ((offset + 2) <= size())                                  // If valid offset
+		output = ((p[offset] << 8) + p[offset + 1]); 
+	return (output);                                             //    return data, else return 0
+}
+
+unsigned long TlvView::getLong(unsigned short offset) const
+{
+	unsigned long output = 0;
+	if ((offset + 4) <= size())                                  // If valid offset
+	{
+		output = p[offset];
+		for (int i = 1; i < 4; i++)
+			output = (output << 8) + p[offset + i];
+	}
+	return (output);                                             //    return data, else return 0
+}
+
+unsigned long long TlvView::getAddr(unsigned short offset) const
+{
+	unsigned long long output = 0;
+	if ((offset + 6) <= size())                                  // If valid offset
+	{
+		output = p[offset];
+		for (int i = 1; i < 6; i++)
+			output = (output << 8) + p[offset + i];
+	}
+	return (output);                                             //    return data, else return 0
+}
+
+unsigned long long TlvView::getLongLong(unsigned short offset) const
+{
+	unsigned long long output = 0;
+	if ((offset + 8) <= size())                                  // If valid offset
+	{
+		output = p[offset];
+		for (int i = 1; i < 8; i++)
+			output = (output << 8) + p[offset + i];
+	}
+	return (output);                                             //    return data, else return 0
+}
+
+std::string TlvView::getString(unsigned short offset, unsigned short length) const
+{
+	std::string output = "";
+	if ((offset + length) <= size())                             // If valid offset
+		output.assign((const char*)(p + offset), length);
+	return(output);
+}
+
+void TlvView::printBytes(unsigned short offset, unsigned short length) const
+{
+	unsigned short count = length;
+	if (count == 0) count = size() - offset;
+	if ((offset + count) <= size())
+	{
+		SimLog::logFile << hex;
+		for (int i = offset; i < offset + count; i++)
+		{
+			SimLog::logFile << (unsigned short)p[i] << "  ";
+		}
+		SimLog::logFile << dec;
+	}
+}
+
+void TlvView::printString(unsigned short offset, unsigned short length) const
+{
+	unsigned short count = length;
+	if (count == 0) count = size() - offset;
+	if ((offset + count) <= size())
+	{
+		for (int i = offset; i < offset + count; i++)
+		{
+			SimLog::logFile << p[i];
+		}
+	}
+}
+
+
 TLV::TLV(unsigned char type, unsigned short length)
 {
 	if ((type > 0) && (type < 128) && (length < 512))   // If valid type and length
@@ -74,6 +229,28 @@ TLV::TLV(const TLV& copySource)  // Copy constructor
 	/**/
 }
 
+TLV::TLV(TLV&& moveSource)
+	: v(std::move(moveSource.v))
+{
+}
+
+TLV& TLV::operator= (const TLV& copySource)
+{
+	v = copySource.v;
+	return (*this);
+}
+
+TLV& TLV::operator= (TLV&& moveSource)
+{
+	v = std::move(moveSource.v);
+	return (*this);
+}
+
+TLV::TLV(const TlvView& tlv)
+	: v(tlv.data(), tlv.data() + tlv.size())
+{
+}
+
 TLV::~TLV()
 {
 	/*
@@ -88,78 +265,54 @@ bool TLV::operator== (TLV& tlv)
 	return (v == tlv.v);
 }
 
+bool TLV::operator== (const TlvView& tlv) const
+{
+	return (view() == tlv);
+}
+
+TlvView TLV::view() const
+{
+	return (TlvView(v.data()));
+}
+
 unsigned short TLV::getType() 
 {
-	return (v[0] >> 1);
+	return (view().getType());
 }
 
 unsigned short TLV::getLength() 
 {
-	unsigned short len = (((v[0] & 0x01) << 8) + v[1]);
-	return (len);
+	return (view().getLength());
 }
 
 unsigned char TLV::getChar(unsigned short offset) 
 {
-	unsigned char output = 0;
-	if ((offset + 1) <= (unsigned short)v.size())                // If valid offset
-		output = v[offset];
-	return (output);                                             //    return data, else return 0
+	return (view().getChar(offset));
 }
 
 unsigned short TLV::getShort(unsigned short offset)
 {
-	unsigned short output = 0;
-	if ((offset + 2) <= (unsigned short)v.size())                // If valid offset
-		output = ((v[offset] << 8) + v[offset + 1]); 
-	return (output);                                             //    return data, else return 0
+	return (view().getShort(offset));
 }
 
 unsigned long TLV::getLong(unsigned short offset)
 {
-	unsigned long output = 0;
-	if ((offset + 4) <= (unsigned short)v.size())                // If valid offset
-	{
-		output = v[offset];
-		for (int i = 1; i < 4; i++)
-			output = (output << 8) + v[offset + i];
-	}
-	return (output);                                             //    return data, else return 0
+	return (view().getLong(offset));
 }
 
 unsigned long long TLV::getAddr(unsigned short offset)
 {
-	unsigned long long output = 0;
-	if ((offset + 6) <= (unsigned short)v.size())                // If valid offset
-	{
-		output = v[offset];
-		for (int i = 1; i < 6; i++)
-			output = (output << 8) + v[offset + i];
-	}
-	return (output);                                             //    return data, else return 0
+	return (view().getAddr(offset));
 }
 
 unsigned long long TLV::getLongLong(unsigned short offset)
 {
-	unsigned long long output = 0;
-	if ((offset + 8) <= (unsigned short)v.size())                // If valid offset
-	{
-		output = v[offset];
-		for (int i = 1; i < 8; i++)
-			output = (output << 8) + v[offset + i];
-	}
-	return (output);                                             //    return data, else return 0
+	return (view().getLongLong(offset));
 }
 
 std::string TLV::getString(unsigned short offset, unsigned short length)
 {
-	std::string output = "";
-	if ((offset + length) <= (unsigned short)v.size())                // If valid offset
-	{
-		for (int i = offset; i < (offset + length); i++)
-			output += v[i];
-	}
-	return(output);
+	return (view().getString(offset, length));
 }
 
 bool TLV::putChar(unsigned short offset, unsigned char input)
@@ -255,34 +408,12 @@ bool TLV::putString(unsigned short offset, std::string input)
 
 void TLV::printBytes(unsigned short offset, unsigned short length)
 {
-	unsigned short count = length;
-	if (count == 0) count = (unsigned short)v.size() - offset;
-	if ((offset + count) <= (unsigned short)v.size())
-	{
-		SimLog::logFile << hex;
-	//	for (auto entry : v)
-		for (int i = offset; i < offset + count; i++)
-		{
-			SimLog::logFile << (unsigned short)v[i] << "  ";
-		//	SimLog::logFile << (unsigned short)entry << "  ";
-		}
-		SimLog::logFile << dec;
-	}
+	view().printBytes(offset, length);
 }
 
 void TLV::printString(unsigned short offset, unsigned short length)
 {
-	unsigned short count = length;
-	if (count == 0) count = (unsigned short)v.size() - offset;
-	if ((offset + count) <= (unsigned short)v.size())
-	{
-//		for (auto entry : v) 
-		for (int i = offset; i < offset + count; i++)
-		{
-			SimLog::logFile << v[i];
-		//	SimLog::logFile << entry;
-		}
-	}
+	view().printString(offset, length);
 }
 
 
@@ -299,7 +430,7 @@ TlvTtl::~TlvTtl()
 
 unsigned short TlvTtl::getTtl() 
 {
-	return (getShort(2));
+	return (TtlView(view()).getTtl());
 }
 
 bool TlvTtl::putTtl(unsigned short input) 
@@ -310,12 +441,11 @@ bool TlvTtl::putTtl(unsigned short input)
 TlvOui::TlvOui(unsigned long OUItype, unsigned short length)
 	: TLV(TLVtypes::ORG_SPECIFIC, length)
 {
-	putLong(2, OUItype);
-	if (putLong(2, OUItype))
-		cout << " Created tlv with type " << (unsigned short)getType() << " and OUI type "
-		<< hex << getLong(2) << " and length " << getLength() << dec << endl;
-	else
+	if (!putLong(2, OUItype))
 		cout << " Can't put oui type " << hex << OUItype << "in TLV of length " << dec << length << endl;
+//	else
+//		cout << " Created tlv with type " << (unsigned short)getType() << " and OUI type "
+//		<< hex << getLong(2) << " and length " << getLength() << dec << endl;
 }
 
 TlvOui::~TlvOui()
@@ -342,7 +472,7 @@ tlvManifest::tlvManifest(unsigned long long returnAddr, unsigned char numXpdus,
 	putAddr(2, returnAddr);
 	puttotalSize(size);
 	putChar(11, numXpdus);
-	SimLog::logFile << "Creating manifest TLV with return " << hex << returnAddr << dec << " : "
+	SIM_LOG(LOG_DETAIL, LOG_LLDP_TX) << "Creating manifest TLV with return " << hex << returnAddr << dec << " : "
 		<< (unsigned short)numXpdus << " XPDUs, total size = "
 		<< size << ", TLV length = " << v.size() - 2 << endl;
 }
@@ -352,30 +482,22 @@ tlvManifest::~tlvManifest()
 
 unsigned long long tlvManifest::getReturnAddr()
 {
-	return(getAddr(2));
+	return(ManifestView(view()).getReturnAddr());
 }
 
 unsigned long tlvManifest::getTotalSize()
 {
-	unsigned long size = getChar(8);
-	size = (size << 8) + getChar(9);
-	size = (size << 16) + getChar(10);
-	return(size);
+	return(ManifestView(view()).getTotalSize());
 }
 
 unsigned char tlvManifest::getNumXpdus()
 {
-	return(getChar(11));
+	return(ManifestView(view()).getNumXpdus());
 }
 
 xpduDescriptor tlvManifest::getXpduDescriptor(unsigned short position)
 {
-	unsigned short index = 12 + (position * 6);
-	xpduDescriptor desc;
-	desc.num = getChar(index);
-	desc.rev = getChar(index + 1);
-	desc.check = getLong(index + 2);
-	return(desc);
+	return(ManifestView(view()).getXpduDescriptor(position));
 }
 
 bool tlvManifest::putReturnAddr(unsigned long long returnAddr)
@@ -389,8 +511,8 @@ bool tlvManifest::puttotalSize(unsigned long size)
 	if (success)
 	{
 		success &= putChar(8, ((size >> 16) & 0xFF));
-		success &= putChar(8, ((size >> 8) & 0xFF));
-		success &= putChar(8, (size & 0xFF));
+		success &= putChar(9, ((size >> 8) & 0xFF));
+		success &= putChar(10, (size & 0xFF));
 	}
 	return (success);
 }
@@ -431,27 +553,22 @@ tlvREQ::~tlvREQ()
 
 unsigned long long tlvREQ::getReturnAddr()
 {
-	return(getAddr(2));
+	return(XreqView(view()).getReturnAddr());
 }
 
 unsigned long long tlvREQ::getScopeAddr()
 {
-	return(getAddr(8));
+	return(XreqView(view()).getScopeAddr());
 }
 
 unsigned char tlvREQ::getNumXpdus()
 {
-	return(getChar(15));
+	return(XreqView(view()).getNumXpdus());
 }
 
 xpduDescriptor tlvREQ::getXpduDescriptor(unsigned short position)
 {
-	unsigned short index = 16 + (position * 6);
-	xpduDescriptor desc;
-	desc.num = getChar(index);
-	desc.rev = getChar(index + 1);
-	desc.check = getLong(index + 2);
-	return(desc);
+	return(XreqView(view()).getXpduDescriptor(position));
 }
 
 bool tlvREQ::putXpduDescriptor(unsigned short position, xpduDescriptor desc)
@@ -478,10 +595,79 @@ tlvXID::~tlvXID()
 
 unsigned long long tlvXID::getScopeAddr()
 {
-	return (getAddr(2));
+	return (XidView(view()).getScopeAddr());
 }
 
 xpduDescriptor tlvXID::getXpduDescriptor()
+{
+	return (XidView(view()).getXpduDescriptor());
+}
+
+
+unsigned short TtlView::getTtl() const
+{
+	return (getShort(2));
+}
+
+unsigned long long ManifestView::getReturnAddr() const
+{
+	return(getAddr(2));
+}
+
+unsigned long ManifestView::getTotalSize() const
+{
+	unsigned long size = getChar(8);
+	size = (size << 8) + getChar(9);
+	size = (size << 8) + getChar(10);
+	return(size);
+}
+
+unsigned char ManifestView::getNumXpdus() const
+{
+	return(getChar(11));
+}
+
+xpduDescriptor ManifestView::getXpduDescriptor(unsigned short position) const
+{
+	unsigned short index = 12 + (position * 6);
+	xpduDescriptor desc;
+	desc.num = getChar(index);
+	desc.rev = getChar(index + 1);
+	desc.check = getLong(index + 2);
+	return(desc);
+}
+
+unsigned long long XreqView::getReturnAddr() const
+{
+	return(getAddr(2));
+}
+
+unsigned long long XreqView::getScopeAddr() const
+{
+	return(getAddr(8));
+}
+
+unsigned char XreqView::getNumXpdus() const
+{
+	return(getChar(15));
+}
+
+xpduDescriptor XreqView::getXpduDescriptor(unsigned short position) const
+{
+	unsigned short index = 16 + (position * 6);
+	xpduDescriptor desc;
+	desc.num = getChar(index);
+	desc.rev = getChar(index + 1);
+	desc.check = getLong(index + 2);
+	return(desc);
+}
+
+unsigned long long XidView::getScopeAddr() const
+{
+	return (getAddr(2));
+}
+
+xpduDescriptor XidView::getXpduDescriptor() const
 {
 	xpduDescriptor output;
 	output.num = getChar(8);
@@ -532,3 +718,98 @@ const Lldpdu& Lldpdu::getLldpdu(Frame& LldpFrame)        // Returns a constant r
 
 	return((const Lldpdu&)LldpFrame.getNextSdu());
 }
+
+void Lldpdu::reserve(size_t octets)
+{
+	pdu.reserve(octets);
+}
+
+void Lldpdu::putTlv(const TLV& tlv)
+{
+	putTlv(tlv.view());
+}
+
+void Lldpdu::putTlv(const TlvView& tlv)
+{
+	pdu.insert(pdu.end(), tlv.data(), tlv.data() + tlv.size());
+}
+
+size_t Lldpdu::size() const
+{
+	return (pdu.size());
+}
+
+size_t Lldpdu::getLength() const
+{
+	return (2 + pdu.size());
+}
+
+shared_ptr<Sdu> Lldpdu::copyCorrupted(size_t offset, unsigned char mask) const
+{
+	shared_ptr<Lldpdu> pCopy = FramePool::makeSdu<Lldpdu>();
+	pCopy->copyPdu(*this);
+	pCopy->TimeStamp = TimeStamp;
+	if (offset < 2)
+		pCopy->etherType ^= (unsigned short)(mask << (8 * (1 - offset)));
+	else if ((offset - 2) < pCopy->pdu.size())
+		pCopy->pdu[offset - 2] ^= mask;
+	return (pCopy);
+}
+
+const unsigned char* Lldpdu::data() const
+{
+	return (pdu.data());
+}
+
+void Lldpdu::copyPdu(const Lldpdu& source)
+{
+	chassisId = source.chassisId;
+	portId = source.portId;
+	rxTTL = source.rxTTL;
+	pdu = source.pdu;
+}
+
+bool Lldpdu::putTtl(unsigned short ttl)
+{
+	size_t offset = 0;
+	for (int i = 0; i < 2; i++)                        // Skip Chassis ID and Port ID TLVs
+	{
+		if (offset + 2 > pdu.size())
+			return (false);
+		offset += TlvView(&pdu[offset]).size();
+	}
+	if ((offset + 4 > pdu.size()) || (TlvView(&pdu[offset]).getType() != TLVtypes::TTL))
+		return (false);
+	pdu[offset + 2] = (ttl >> 8);
+	pdu[offset + 3] = (ttl & 0xFF);
+	rxTTL = ttl;
+	return (true);
+}
+
+bool Lldpdu::decode(std::vector<TlvView>& tlvs, size_t* pIgnored) const
+{
+	tlvs.clear();
+	if (pIgnored)
+		*pIgnored = 0;
+	size_t offset = 0;
+	while (offset + 2 <= pdu.size())                   // While there is room for a TLV header
+	{
+		TlvView tlv(&pdu[offset]);
+		if (tlv.getType() == TLVtypes::END)             // End Of LLDPDU TLV ends the LLDPDU
+		{
+			offset += tlv.size();
+			while (pIgnored && (offset + 2 <= pdu.size()))     // Count the (whole) TLVs after it
+			{
+				offset += TlvView(&pdu[offset]).size();
+				if (offset <= pdu.size())
+					(*pIgnored)++;
+			}
+			return (true);
+		}
+		if (offset + tlv.size() > pdu.size())          // TLV runs past the end of the LLDPDU
+			return (false);
+		tlvs.push_back(tlv);
+		offset += tlv.size();
+	}
+	return (offset == pdu.size());                     // False if a partial TLV header left over
+}
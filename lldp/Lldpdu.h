@@ -36,6 +36,46 @@ union lldpduTlvTypeLength
 enum TLVtypes { END, CHASSIS_ID, PORT_ID, TTL, PORT_DESC, SYSTEM_NAME, SYSTEM_DESC,
 	SYSTEM_CAPABILITIES, MGMT_ADDR, MANIFEST, XREQ, XID, ORG_SPECIFIC=127 };
 
+unsigned long long hashBytes(const unsigned char* pBytes, size_t length, unsigned long long seed = 0);
+
+/*
+*   TlvView is a read-only view of one TLV in IEEE Std 802.1AB wire format (a 2 octet type/length header followed by
+*      length octets of value).  It does not own the octets it looks at, so it is cheap to create and copy, but it
+*      is only valid while the buffer it points into (e.g. the Lldpdu in a received Frame) exists and is unchanged.
+*   Offsets passed to the get routines count from the start of the header, the same as for TLV.
+*   A default constructed TlvView looks at an End Of LLDPDU TLV.
+*/
+
+class TlvView
+{
+public:
+	TlvView(const unsigned char* pTlv = nullptr);
+	bool operator== (const TlvView& tlv) const;
+	unsigned long long hash(unsigned long long seed = 0) const;     // Hash of all octets, including the header
+
+	const unsigned char* data() const;
+	unsigned short size() const;                // Octets in the TLV, including the header
+	unsigned short getType() const;
+	unsigned short getLength() const;
+	unsigned char getChar(unsigned short offset) const;
+	unsigned short getShort(unsigned short offset) const;
+	unsigned long getLong(unsigned short offset) const;
+	unsigned long long getAddr(unsigned short offset) const;
+	unsigned long long getLongLong(unsigned short offset) const;
+	std::string getString(unsigned short offset, unsigned short length) const;
+
+	void printBytes(unsigned short offset = 0, unsigned short length = 0) const;
+	void printString(unsigned short offset = 0, unsigned short length = 0) const;
+
+protected:
+	const unsigned char* p;
+};
+
+/*
+*   TLV owns a copy of a TLV in wire format.  It is used to build TLVs and to hold TLVs in the local and neighbor MIBs.
+*      The get routines are those of TlvView (see view()).
+*/
+
 class TLV
 {
 protected:
@@ -44,8 +84,15 @@ protected:
 public:
 	TLV(unsigned char type = 0, unsigned short length = 0);
 	TLV(const TLV& copySource);      // copy constructor
+	TLV(TLV&& moveSource);           // move constructor
+	TLV(const TlvView& tlv);         // Copy a TLV out of a (received) LLDPDU
 	~TLV();
+	TLV& operator= (const TLV& copySource);
+	TLV& operator= (TLV&& moveSource);
 	bool operator== (TLV& tlv);
+	bool operator== (const TlvView& tlv) const;
+
+	TlvView view() const;
 
 	unsigned short getType();
 	unsigned short getLength();
@@ -106,6 +153,46 @@ public:
 	unsigned long check;
 };
 
+/*
+*   Views of specific TLV types in a received LLDPDU.  The TLV type and length must be validated before use.
+*/
+
+class TtlView : public TlvView
+{
+public:
+	TtlView(const TlvView& tlv) : TlvView(tlv) {}
+	unsigned short getTtl() const;
+};
+
+class ManifestView : public TlvView
+{
+public:
+	ManifestView(const TlvView& tlv) : TlvView(tlv) {}
+	unsigned long long getReturnAddr() const;
+	unsigned long getTotalSize() const;
+	unsigned char getNumXpdus() const;
+	xpduDescriptor getXpduDescriptor(unsigned short position) const;
+};
+
+class XreqView : public TlvView
+{
+public:
+	XreqView(const TlvView& tlv) : TlvView(tlv) {}
+	unsigned long long getReturnAddr() const;
+	unsigned long long getScopeAddr() const;
+	unsigned char getNumXpdus() const;
+	xpduDescriptor getXpduDescriptor(unsigned short position) const;
+};
+
+class XidView : public TlvView
+{
+public:
+	XidView(const TlvView& tlv) : TlvView(tlv) {}
+	unsigned long long getScopeAddr() const;
+	xpduDescriptor getXpduDescriptor() const;
+};
+
+
 class tlvManifest : public TLV
 {
 public:
@@ -168,6 +255,14 @@ public:
 };
 /**/
 
+/*
+*   An Lldpdu holds the LLDPDU as a single buffer in IEEE Std 802.1AB wire format:  the TLVs one after the other,
+*      each with its type/length header.  It is built by appending TLVs with putTlv(), and read by decode() which
+*      returns a TlvView of each TLV without copying anything.
+*   An End Of LLDPDU TLV is optional (as in IEEE Std 802.1AB-2016) and is not added by putTlv();  decode() stops at one.
+*   Like any Sdu, an Lldpdu must not be changed once it is in a Frame.  putTtl() is for a new Lldpdu made with copyPdu().
+*/
+
 class Lldpdu : public Sdu
 {
 public:
@@ -176,6 +271,18 @@ public:
 	
 	static const Lldpdu& getLldpdu(Frame& LldpFrame);      // Returns a constant reference to the LLDPDU
 
+	void reserve(size_t octets);
+	void putTlv(const TLV& tlv);
+	void putTlv(const TlvView& tlv);
+	size_t size() const;
+	const unsigned char* data() const;
+	virtual size_t getLength() const override;           // EtherType plus the encoded LLDPDU
+	virtual shared_ptr<Sdu> copyCorrupted(size_t offset, unsigned char mask) const override;
+	bool decode(std::vector<TlvView>& tlvs, size_t* pIgnored = nullptr) const;   // Replaces tlvs with a view of each TLV;
+	                                                      //    false if TLVs overrun the buffer.  pIgnored gets the TLVs after an End TLV
+	void copyPdu(const Lldpdu& source);                   // Copies the encoded LLDPDU (and identifiers) from another Lldpdu
+	bool putTtl(unsigned short ttl);                      // Overwrites the value of the TTL TLV (the third TLV)
+
 	/**/
 	// For initial testing just pass Chassis ID and Port ID outside of any TLV structure
 	unsigned long long chassisId;
@@ -183,6 +290,7 @@ public:
 	unsigned short rxTTL;
 	/**/
 
-	std::vector<TLV> tlvs;
+protected:
+	std::vector<unsigned char> pdu;
 };
 
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "Mac.h"
+#include "Trace.h"
 
 /**/
 Iss::Iss()
@@ -45,6 +46,11 @@ bool Iss::getOperational() const
 {
 	return enabled;
 }
+
+int Iss::getTransitTime(size_t /* octets */) const
+{
+	return (-1);
+}
 /**/
 
 
@@ -71,6 +77,22 @@ void IssQ::Request(unique_ptr<Frame> pFrameIn)
 		requests.push(std::move(pFrameIn));  // A request sent to a non-operational ISS will be discarded.
 }
 
+void IssQ::setQueueDepth(size_t depth)
+{
+	requests.setDepth(depth);
+	indications.setDepth(depth);
+}
+
+size_t IssQ::getQueueDepth() const
+{
+	return (requests.capacity());
+}
+
+unsigned long long IssQ::getQueueDrops() const
+{
+	return (requests.getDrops() + indications.getDrops());
+}
+
 unique_ptr<Frame> IssQ::Indication() 
 {
 //		if (getOperational() && !indications.empty())   // Disallow indications from a non-operational ISS?
@@ -84,7 +106,7 @@ unique_ptr<Frame> IssQ::Indication()
 		}
 }
 
-iLinkHalf::iLinkHalf(std::queue<unique_ptr<Frame>>& req, std::queue<unique_ptr<Frame>>& ind, unsigned long long addr)
+iLinkHalf::iLinkHalf(FrameQueue& req, FrameQueue& ind, unsigned long long addr)
 	: requests(req), indications(ind), macAddress(addr)
 {
 	std::cout << "    iLinkHalf Constructor called." << std::endl;
@@ -132,8 +154,8 @@ iLink::iLink(unsigned long long EastAddr, unsigned long long WestAddr)
 	if (!WestAddr)
 		WestAddr = EastAddr;
 
-	pEastToWestQueue = make_unique<std::queue<unique_ptr<Frame>>>();
-	pWestToEastQueue = make_unique<std::queue<unique_ptr<Frame>>>();
+	pEastToWestQueue = make_unique<FrameQueue>();
+	pWestToEastQueue = make_unique<FrameQueue>();
 
 	pEast = make_shared<iLinkHalf>(*pEastToWestQueue, *pWestToEastQueue, EastAddr);
 	pWest = make_shared<iLinkHalf>(*pWestToEastQueue, *pEastToWestQueue, WestAddr);
@@ -183,6 +205,17 @@ void Component::setSuspended(bool val)
 	suspended = val;
 }
 
+void Component::advanceTimers(int ticks)
+{
+	for (int i = 0; i < ticks; i++)
+		timerTick();
+}
+
+int Component::nextEventTime() const
+{
+	return (SimLog::Time + 1);      // Unless the derived class knows better, assume there is always something to do
+}
+
 /**/
 
 
@@ -192,17 +225,30 @@ Mac::Mac()
 	enabled = true;
 	macAddress = defaultOUI;
 //	macId.id = 0;
+	devNum = 0;
 	linkPartner = nullptr;
+	linkDelay = 0;
+	linkBandwidth = 0;
+	txFreeOctet = 0;
+	connectTime = 0;
+	clearLinkStats();
 //	std::cout << "Mac Constructor called" << std::endl;
 };
 
-Mac::Mac(unsigned short dev, unsigned short sap)
+Mac::Mac(unsigned int dev, unsigned short sap)
 	: Component(ComponentTypes::MAC)
 {
 	enabled = true;
-	macAddress = defaultOUI + (dev * 0x10000) + sap;
-	macId.dev = dev;
+	macAddress = deviceAddress(defaultOUI, dev) + sap;
+	devNum = dev;
+	macId.dev = (unsigned short)dev;
 	macId.sap = sap;
+	linkPartner = nullptr;
+	linkDelay = 0;
+	linkBandwidth = 0;
+	txFreeOctet = 0;
+	connectTime = 0;
+	clearLinkStats();
 //	std::cout << "Mac Constructor called:  device = " << macId.dev << "  sapId = " << macId.sap << std::endl;
 }
 
@@ -237,7 +283,10 @@ void Mac::Request(unique_ptr<Frame> pFrameIn)
 {
 	pFrameIn->TimeStamp = SimLog::Time;   // Use frame time stamp to measure residence time in queue
 	if (getOperational() && !suspended)
+	{
 		requests.push(std::move(pFrameIn));  // A request sent to a non-operational ISS will be discarded.
+		linkStats.peakQueueDepth = std::max(linkStats.peakQueueDepth, requests.size());
+	}
 }
 
 unique_ptr<Frame> Mac::Indication()
@@ -292,9 +341,9 @@ void Mac::updateMacSystemId(unsigned long long value)
 	macAddress = (macAddress & 0xfffff0ff0fff) | (value & 0x000000f0f000);  // replace device type and sysNum portion of MAC address
 }
 
-unsigned short Mac::getDevNum() const
+unsigned int Mac::getDevNum() const
 {
-	return macId.dev;
+	return devNum;
 }
 
 unsigned long Mac::getMacId() const
@@ -308,6 +357,8 @@ void Mac::reset()
 		requests.pop();
 	while (!indications.empty())     // Flush all frames already delivered 
 		indications.pop();
+	if (pImpairments)
+		pImpairments->clear();
 }
 
 void Mac::timerTick()
@@ -326,36 +377,183 @@ void Mac::run(bool singleStep)
 	}
 }
 
+void Mac::advanceTimers(int /* ticks */)
+{
+	// No timers
+}
 
-void Mac::Transmit()
+int Mac::nextEventTime() const
 {
-	if (!requests.empty() && !suspended)
+	int next = SimTimeNever;
+	if (!suspended)
+	{
+		if (!indications.empty())                                 // Client has a frame to pick up
+			next = SimLog::Time + 1;
+		else if (!requests.empty())                               // Frame waiting to cross the link
+		{
+			const Frame& frame = *requests.front();
+			unsigned long long txDone = 0;
+			next = deliveryTime(frame, frame.getLength() + FrameOverhead, txDone);
+			if (!getOperational() || (next <= SimLog::Time))      //    (or to be flushed)
+				next = SimLog::Time + 1;
+		}
+		if (pImpairments && pImpairments->isHolding())            // Frame held back by an impaired link
+			next = std::min(next, std::max(pImpairments->nextReleaseTime(), SimLog::Time + 1));
+	}
+	return (next);
+}
+
+
+int Mac::deliveryTime(const Frame& frame, size_t octets, unsigned long long& txDone) const
+{
+	if (linkBandwidth == 0)
+	{
+		txDone = txFreeOctet;
+		return (frame.TimeStamp + linkDelay);
+	}
+	txDone = std::max(txFreeOctet, (unsigned long long)frame.TimeStamp * linkBandwidth) + octets;
+	return ((int)((txDone + linkBandwidth - 1) / linkBandwidth) + linkDelay);
+}
+
+bool Mac::Transmit()
+{
+	bool delivered = false;
+
+	if ((!requests.empty() || (pImpairments && pImpairments->isHolding())) && !suspended)
 	{
 		if (getOperational())
 		{
-			unsigned short txTime = (requests.front())->TimeStamp;
-			if (SimLog::Time >= (txTime + linkDelay))
+			while (!requests.empty())                                           // Deliver every Frame that has arrived
 			{
+				size_t octets = requests.front()->getLength() + FrameOverhead;
+				unsigned long long txDone = 0;
+				int arrival = deliveryTime(*requests.front(), octets, txDone);
+				if (SimLog::Time < arrival)
+					break;
+
 				unique_ptr<Frame> pTempFrame = std::move(requests.front());     // move the pointer to the frame from the requests queue to the temp variable
 				requests.pop();                                                 // pop the null pointer left on the queue after the move
-				if (linkPartner && linkPartner->enabled && !(linkPartner->suspended))
+				txFreeOctet = txDone;
+				linkStats.octets += octets;
+				if (pImpairments)
 				{
-					linkPartner->indications.push(std::move(pTempFrame));       // push the pointer to the frame onto the other MAC indications queue
+					pImpairments->apply(std::move(pTempFrame), impaired);      // Zero or more Frames to deliver now
+					for (auto& pFrame : impaired)
+						delivered |= deliver(std::move(pFrame));
+					impaired.clear();
 				}
+				else
+					delivered |= deliver(std::move(pTempFrame));
+			}
+			if (pImpairments && pImpairments->isHolding())                     // Held Frames whose time is up
+			{
+				pImpairments->release(impaired);
+				for (auto& pFrame : impaired)
+					delivered |= deliver(std::move(pFrame));
+				impaired.clear();
 			}
 		}
 		else  // can get here if this Mac or its Partner were disabled without disconnecting
 		{
 			while (!requests.empty())        // Flush all frames in flight
+			{
 				requests.pop();
+				linkStats.drops++;
+			}
+			if (pImpairments)
+				pImpairments->clear();
 //			while (!indications.empty())     // Flush all frames already delivered (is this desirable?)
 //				indications.pop();
 		}
 	}
+	return (delivered);
 }
 
+bool Mac::deliver(unique_ptr<Frame> pFrame)
+{
+	unsigned long long traceDA = 0;
+	unsigned short traceEtherType = 0;
+	if (Trace::isActive())
+	{
+		traceDA = pFrame->MacDA;
+		traceEtherType = pFrame->getNextEtherType();
+	}
+	int requested = pFrame->TimeStamp;
+	bool accepted = false;
+	if (linkPartner && linkPartner->enabled && !(linkPartner->suspended))
+	{
+		accepted = linkPartner->indications.push(std::move(pFrame));   // push the pointer to the frame onto the other MAC indications queue
+	}
+	if (accepted)
+	{
+		linkStats.frames++;
+		linkStats.latency += SimLog::Time - requested;
+	}
+	else
+		linkStats.drops++;
+	Trace::record(TRACE_MAC_TRANSMIT, macAddress, getSapId(), traceDA, traceEtherType, accepted);
+	return (accepted);
+}
+
+void Mac::setImpairments(const ImpairmentProfile& profile, unsigned long long seed)
+{
+	pImpairments = make_unique<LinkImpairments>(profile, seed);
+}
+
+void Mac::clearImpairments()
+{
+	pImpairments = nullptr;
+}
+
+const LinkImpairments* Mac::getImpairments() const
+{
+	return (pImpairments.get());
+}
+
+shared_ptr<Mac> Mac::getLinkPartner() const
+{
+	return (linkPartner);
+}
+
+int Mac::getTransitTime(size_t octets) const
+{
+	//  Propagation delay plus serialization delay, ignoring any frames already waiting to be transmitted
+	if (linkBandwidth == 0)
+		return (linkDelay);
+	return ((int)((octets + linkBandwidth - 1) / linkBandwidth) + linkDelay);
+}
+
+unsigned short Mac::getLinkDelay() const
+{
+	return (linkDelay);
+}
 
-void Mac::Connect(shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short delay)
+unsigned long Mac::getLinkBandwidth() const
+{
+	return (linkBandwidth);
+}
+
+const LinkStats& Mac::getLinkStats() const
+{
+	return (linkStats);
+}
+
+double Mac::getLinkUtilization() const
+{
+	long long upTicks = linkStats.linkUpTicks + (linkPartner ? (SimLog::Time - connectTime) : 0);
+	if ((linkBandwidth == 0) || (upTicks <= 0))
+		return (0.0);
+	return ((double)linkStats.octets / ((double)linkBandwidth * upTicks));
+}
+
+void Mac::clearLinkStats()
+{
+	linkStats = LinkStats();
+	connectTime = SimLog::Time;
+}
+
+
+void Mac::Connect(shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short delay, unsigned long bandwidth)
 {
 	if (macA->linkPartner) Disconnect(macA);
 	if (macB->linkPartner) Disconnect(macB);
@@ -363,7 +561,7 @@ void Mac::Connect(shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short del
 	if (SimLog::Debug > 0) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Connecting  "
 		<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 		<< macB->macId.dev << ":" << macB->macId.sap << " *****" << dec << endl;
-	cout << endl << "Time " << SimLog::Time << ":    ***** Connecting  " 
+	if (SimLog::Debug > LOG_RESULT) cout << endl << "Time " << SimLog::Time << ":    ***** Connecting  " 
 		<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 		<< macB->macId.dev << ":" << macB->macId.sap << " *****" << dec << endl;
 
@@ -371,6 +569,12 @@ void Mac::Connect(shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short del
 	macB->linkPartner = macA;
 	macA->linkDelay = delay;
 	macB->linkDelay = delay;
+	macA->linkBandwidth = bandwidth;
+	macB->linkBandwidth = bandwidth;
+	macA->txFreeOctet = 0;
+	macB->txFreeOctet = 0;
+	macA->connectTime = SimLog::Time;
+	macB->connectTime = SimLog::Time;
 }
 
 void Mac::Disconnect(shared_ptr<Mac> macA)
@@ -380,22 +584,34 @@ void Mac::Disconnect(shared_ptr<Mac> macA)
 		if (SimLog::Debug > 0) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
 			<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 			<< macA->linkPartner->macId.dev << ":" << macA->linkPartner->macId.sap << " *****" << dec << endl;
-		cout << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
+		if (SimLog::Debug > LOG_RESULT) cout << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
 			<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 			<< macA->linkPartner->macId.dev << ":" << macA->linkPartner->macId.sap << " *****" << dec << endl;
 
 		if (macA->linkPartner->linkPartner == macA)    // if Partner's Partner is this Mac
 		{
 			while (!(macA->linkPartner->requests.empty()))        // Flush all Partner's frames in flight
+			{
 				macA->linkPartner->requests.pop();
+				macA->linkPartner->linkStats.drops++;
+			}
+			if (macA->linkPartner->pImpairments)
+				macA->linkPartner->pImpairments->clear();
 //			while (!(macA->linkPartner->indications.empty()))     // Flush all frames already delivered to Partner (is this desirable?)
 //				macA->linkPartner->indications.pop();
+			macA->linkPartner->linkStats.linkUpTicks += SimLog::Time - macA->linkPartner->connectTime;
 			macA->linkPartner->linkPartner = nullptr;             // then clear linkPartner's link
 		}
 		while (!(macA->requests.empty()))        // Flush all frames in flight
+		{
 			macA->requests.pop();
+			macA->linkStats.drops++;
+		}
+		if (macA->pImpairments)
+			macA->pImpairments->clear();
 //		while (!(macA->indications.empty()))     // Flush all frames already delivered (is this desirable?)
 //			macA->indications.pop();
+		macA->linkStats.linkUpTicks += SimLog::Time - macA->connectTime;
 		macA->linkPartner = nullptr;             // clear this Mac's link
 	}
 }
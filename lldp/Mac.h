@@ -16,8 +16,12 @@ limitations under the License.
 
 #pragma once
 #include "Frame.h"
+#include "SpscRing.h"
+#include "LinkImpairments.h"
 // #include "queue.h"
 
+typedef SpscRing<unique_ptr<Frame>> FrameQueue;     // Request or indication queue at a SAP
+
 
 /*
 *  Iss is an interface between the client of a service and the provider of that service.  
@@ -44,6 +48,7 @@ public:
 	virtual bool getEnabled() const;                       // Allows client to determine if the interface is enabled.
 	virtual bool getPointToPoint() const;                  // Allows client to determine if the service connects to only one other SAP.
 	virtual bool getOperational() const;                   // Allows client to determine if the interface is operational.
+	virtual int getTransitTime(size_t octets) const;       // Ticks for a frame of octets to cross the link;  -1 if not known.
 	
 	// Pure virtual functions must be provided by the derived class
 	virtual unsigned long long getMacAddress() const = 0;  // Allows client to determine the MAC address of the interface.
@@ -59,6 +64,8 @@ protected:
 
 /*
 *  IssQ is a variant of an Iss that provides indication and request queues at the SAP.
+*    The queues are fixed depth single-producer/single-consumer rings:  a request or indication that finds its
+*    queue full is discarded and counted in getQueueDrops().
 */
 
 class IssQ : public Iss
@@ -72,9 +79,13 @@ public:
 	virtual void Request(unique_ptr<Frame> pFrameIn) override;
 	virtual unique_ptr<Frame> Indication() override;
 
+	void setQueueDepth(size_t depth);                    // Depth of request and indication queues (default 64)
+	size_t getQueueDepth() const;
+	unsigned long long getQueueDrops() const;            // Frames discarded because a queue was full
+
 protected:         
-	std::queue<unique_ptr<Frame>> requests;     
-	std::queue<unique_ptr<Frame>> indications;
+	FrameQueue requests;     
+	FrameQueue indications;
 };
 
 class iLinkHalf : public Iss
@@ -82,7 +93,7 @@ class iLinkHalf : public Iss
 	friend class iLink;
 
 public:
-	iLinkHalf(std::queue<unique_ptr<Frame>>& req, std::queue<unique_ptr<Frame>>& ind, unsigned long long addr = 0);
+	iLinkHalf(FrameQueue& req, FrameQueue& ind, unsigned long long addr = 0);
 	~iLinkHalf();
 	iLinkHalf(iLinkHalf& copySource) = delete;             // Disable copy constructor
 	iLinkHalf& operator= (const iLinkHalf&) = delete;      // Disable assignment operator
@@ -93,8 +104,8 @@ public:
 
 
 protected:
-	std::queue<unique_ptr<Frame>>& requests;
-	std::queue<unique_ptr<Frame>>& indications;
+	FrameQueue& requests;
+	FrameQueue& indications;
 	unsigned long long macAddress;
 
 };
@@ -107,8 +118,8 @@ public:
 	iLink(iLink& copySource) = delete;             // Disable copy constructor
 	iLink& operator= (const iLink&) = delete;      // Disable assignment operator
 
-	unique_ptr<std::queue<unique_ptr<Frame>>> pEastToWestQueue;
-	unique_ptr<std::queue<unique_ptr<Frame>>> pWestToEastQueue;
+	unique_ptr<FrameQueue> pEastToWestQueue;
+	unique_ptr<FrameQueue> pWestToEastQueue;
 
 	shared_ptr<iLinkHalf> pEast;
 	shared_ptr<iLinkHalf> pWest;
@@ -148,6 +159,10 @@ public:
 	virtual void timerTick() = 0;              // Decrements any timers associated with this component (when not suspended).
 	virtual void run(bool singleStep) = 0;     // Executes operational methods of the component (when not suspended).
 
+	virtual void advanceTimers(int ticks);     // Equivalent to calling timerTick() the given number of times.
+	virtual int nextEventTime() const;         // Earliest Time at which timerTick() and run() could do more than decrement timers,
+	//     assuming no new frames or administrative changes arrive.  Returns SimTimeNever if idle until then.
+
 protected:
 	ComponentTypes type;      // Read-only by the simulation;  set by the constructor
 	bool suspended;           // Read-write by the simulation;  inhibits timerTick() and run() operations
@@ -156,6 +171,20 @@ protected:
 
 
 
+/*
+*   LinkStats counts what a Mac has sent across its Links (i.e. one direction of each Link).
+*/
+struct LinkStats
+{
+	unsigned long long frames;      // Frames delivered to the link partner
+	unsigned long long octets;      // Octets put on the Link, including preamble and inter-frame gap
+	unsigned long long latency;     // Sum over delivered Frames of ticks from request to delivery
+	unsigned long long drops;       // Frames lost in flight (partner not receiving, indication queue full, or link down)
+	size_t peakQueueDepth;          // Most Frames waiting in the request queue at one time
+	int linkUpTicks;                // Ticks connected, not counting the current connection
+};
+
+
 /*
 *   A Mac provides means of sending Frames between Devices.
 *   By inheriting IssQ, a Mac object provides an ISS SAP (with request and indication queues) to its client (e.g. a 
@@ -164,6 +193,14 @@ protected:
 *      Frames across those Links.  Per the IEEE 802 Client/Service model, a service request from a client at the SAP
 *      of one MAC results in a service indication (with identical parameters) provided to the client at the SAP of the
 *      connected MAC after a Link specific time delay.
+*   A Link has a propagation delay (ticks) and a bandwidth (octets per tick, the same in both directions).
+*      Each Frame occupies the transmitter for its encoded length plus FrameOverhead octets, starting when it is
+*      requested or when the previous Frame finishes, whichever is later.  It is delivered on the first tick after
+*      its last octet is sent, plus the propagation delay.  Every Frame that has arrived is delivered on each tick,
+*      so throughput is limited only by the bandwidth.  A bandwidth of zero means Frames take no time to send,
+*      and arrive the propagation delay after they are requested.
+*   A Mac can impair the Frames it sends (loss, duplication, reordering, corruption) with setImpairments();
+*      see LinkImpairments.  Each direction of a Link has its own profile, seed, and counters.
 *   The Mac class inherits both an enabled (from IssQ) and suspended (from Component) variable.  
 *      A Mac will not transmit or receive while suspended (however it may continue to receive when in a suspended Device).
 *          Being suspended does not automatically make a Mac non-operational.
@@ -175,7 +212,7 @@ class Mac : public Component, public IssQ
 {
 public:
 	Mac();
-	Mac(unsigned short dev, unsigned short sap);
+	Mac(unsigned int dev, unsigned short sap);
 	~Mac();    
 	Mac(Mac& copySource) = delete;             // Disable copy constructor
 	Mac& operator= (const Mac&) = delete;      // Disable assignment operator
@@ -183,29 +220,53 @@ public:
 	virtual void Request(unique_ptr<Frame> pFrameIn) override;
 	virtual unique_ptr<Frame> Indication() override;
 	virtual bool getOperational() const override;
+	virtual int getTransitTime(size_t octets) const override;
 	virtual void setEnabled(bool val);                    // Provides administrative control over the enabled parameter
 	virtual void setAdminPointToPoint(adminValues val);   // Provides administrative control over the operPointToPoint parameter
 	virtual adminValues getAdminPointToPoint() const;
 	virtual unsigned long long getMacAddress() const;
 	virtual unsigned short getSapId() const;              // Identifies this SAP (unique within a Device)
-	virtual unsigned short getDevNum() const;             // Identifies the Device containing this MAC
+	virtual unsigned int getDevNum() const;               // Identifies the Device containing this MAC
 	virtual unsigned long getMacId() const;               // Union of the Device Number and SAP Identifier
 	virtual void updateMacSystemId(unsigned long long value);
 
 	virtual void reset() override;
 	virtual void timerTick() override;
 	virtual void run(bool singleStep) override;
-
-	virtual void Transmit();       
+	virtual void advanceTimers(int ticks) override;
+	virtual int nextEventTime() const override;
+
+	virtual bool Transmit();                              // Returns true if a Frame was delivered to the link partner
+	shared_ptr<Mac> getLinkPartner() const;
+	unsigned short getLinkDelay() const;
+	unsigned long getLinkBandwidth() const;
+	const LinkStats& getLinkStats() const;
+	double getLinkUtilization() const;                    // Fraction of the bandwidth used while connected
+	void clearLinkStats();
+	void setImpairments(const ImpairmentProfile& profile, unsigned long long seed);   // Impairs Frames sent by this Mac
+	void clearImpairments();
+	const LinkImpairments* getImpairments() const;      // nullptr if the link is not impaired in this direction
 	  
-	static void Connect(shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short delay = 0);
+	static void Connect(shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short delay = 0, unsigned long bandwidth = 0);
 	static void Disconnect(shared_ptr<Mac> macA);
 
+	static const unsigned int FrameOverhead = 20;          // Preamble, start of frame delimiter, and inter-frame gap
+
 protected:
 	unsigned long long macAddress;
-	macIdentifier macId;
+	macIdentifier macId;               // Holds only the low 16 bits of the Device Number
+	unsigned int devNum;
 
 	shared_ptr<Mac> linkPartner;
-	unsigned short linkDelay;
+	unsigned short linkDelay;          // Propagation delay in ticks
+	unsigned long linkBandwidth;       // Octets per tick;  zero for no serialization delay
+	unsigned long long txFreeOctet;    // Time (in octets, i.e. ticks * linkBandwidth) when the transmitter is next free
+	int connectTime;
+	LinkStats linkStats;
+	unique_ptr<LinkImpairments> pImpairments;
+	std::vector<unique_ptr<Frame>> impaired;    // Frames from pImpairments to deliver now (kept to reuse its storage)
+
+	int deliveryTime(const Frame& frame, size_t octets, unsigned long long& txDone) const;
+	bool deliver(unique_ptr<Frame> pFrame);    // Pushes a Frame onto the partner's indication queue, and counts it
 };
 
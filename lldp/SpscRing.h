@@ -0,0 +1,173 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <atomic>
+#include <memory>
+
+/*
+*   Class SpscRing is a fixed capacity FIFO for one producer thread and one consumer thread.
+*   It supports the subset of the std::queue interface used for SAP queues (push, front, pop, empty, size)
+*      without allocating after the first push.  The capacity is the requested depth rounded up to a power of two.
+*   A push to a full ring is refused (drop tail):  push() returns false, the item is left with the caller, and
+*      the drop counter is incremented.
+*   The producer only writes tail, the consumer only writes head, and each publishes with a release store, so an item
+*      pushed in one thread can be popped in another with no lock.  Head and tail are padded onto separate cache lines.
+*      Each side keeps a cached copy of the other side's index so it only reads the shared index when the cache
+*      says the ring is full (producer) or empty (consumer).
+*   The slots are not allocated until the first push, so rings that never carry anything (e.g. the queues of an
+*      unconnected Mac) cost only the ring object itself.  The consumer only touches the slots after it has seen
+*      the tail published by that first push.
+*   setDepth() and clear() are not thread safe, and are for use when no other thread is using the ring.
+*/
+
+template <class T>
+class SpscRing
+{
+public:
+	explicit SpscRing(size_t depth = 64)
+	{
+		head = 0;
+		tail = 0;
+		headCache = 0;
+		tailCache = 0;
+		drops = 0;
+		mask = roundUp(depth) - 1;
+	}
+	~SpscRing() {}
+	SpscRing(SpscRing& copySource) = delete;             // Disable copy constructor
+	SpscRing& operator= (const SpscRing&) = delete;      // Disable assignment operator
+
+	//  Producer side
+	bool push(T&& item)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - headCache > mask)                                  // Looks full, so refresh cached head
+		{
+			headCache = head.load(std::memory_order_acquire);
+			if (t - headCache > mask)
+			{
+				drops.store(drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);   // Written only by producer
+				return (false);
+			}
+		}
+		if (!slots)
+			allocate(mask + 1);
+		slots[t & mask] = std::move(item);
+		tail.store(t + 1, std::memory_order_release);
+		return (true);
+	}
+
+	//  Consumer side
+	bool empty() const
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == tailCache)                                        // Looks empty, so refresh cached tail
+			tailCache = tail.load(std::memory_order_acquire);
+		return (h == tailCache);
+	}
+
+	T& front()                                                     // Ring must not be empty
+	{
+		return (slots[head.load(std::memory_order_relaxed) & mask]);
+	}
+
+	const T& front() const
+	{
+		return (slots[head.load(std::memory_order_relaxed) & mask]);
+	}
+
+	void pop()                                                     // Ring must not be empty
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		slots[h & mask] = T();                                     // Release whatever is left in the slot
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	//  Either side
+	size_t size() const
+	{
+		return (tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+	}
+
+	size_t capacity() const
+	{
+		return (mask + 1);
+	}
+
+	unsigned long long getDrops() const
+	{
+		return (drops.load(std::memory_order_relaxed));   // Safe to read from any thread
+	}
+
+	//  Not thread safe
+	void clear()
+	{
+		while (!empty())
+			pop();
+	}
+
+	void setDepth(size_t depth)                                    // Keeps current contents (up to the new capacity)
+	{
+		size_t oldMask = mask;
+		std::unique_ptr<T[]> oldSlots = std::move(slots);
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t t = tail.load(std::memory_order_relaxed);
+
+		mask = roundUp(depth) - 1;
+		if (h != t)
+			allocate(mask + 1);
+		size_t count = 0;
+		for (size_t i = h; i != t; i++)
+		{
+			if (count <= mask)
+				slots[count++] = std::move(oldSlots[i & oldMask]);
+			else
+				drops.store(drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+		head = 0;
+		tail = count;
+		headCache = 0;
+		tailCache = count;
+	}
+
+private:
+	std::unique_ptr<T[]> slots;
+	size_t mask;                                 // Capacity - 1
+	char pad0[CacheLineSize];
+
+	std::atomic<size_t> head;                    // Index of next item to pop;  written only by consumer
+	mutable size_t tailCache;                    // Consumer's copy of tail
+	char pad1[CacheLineSize];
+
+	std::atomic<size_t> tail;                    // Index of next slot to push;  written only by producer
+	size_t headCache;                            // Producer's copy of head
+	std::atomic<unsigned long long> drops;       // Items refused because the ring was full
+	char pad2[CacheLineSize];
+
+	static size_t roundUp(size_t depth)
+	{
+		size_t capacity = 1;
+		while (capacity < depth)
+			capacity <<= 1;
+		return (capacity);
+	}
+
+	void allocate(size_t capacity)
+	{
+		slots = std::unique_ptr<T[]>(new T[capacity]);
+	}
+};
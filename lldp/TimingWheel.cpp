@@ -0,0 +1,264 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "TimingWheel.h"
+
+
+TimingWheel::TimingWheel()
+{
+	now = 0;
+	freeNodes = -1;
+	for (unsigned int level = 0; level < Levels; level++)
+		occupied[level] = 0;
+	expiredHead = -1;
+	expiredTail = -1;
+	count = 0;
+}
+
+TimingWheel::~TimingWheel()
+{
+}
+
+TimingWheel::Handle TimingWheel::start(unsigned long long ticks, unsigned int type, unsigned int data)
+{
+	int node = freeNodes;
+	if (node >= 0)
+	{
+		freeNodes = nodes[node].next;
+	}
+	else
+	{
+		node = (int)nodes.size();
+		nodes.push_back(Node());
+		nodes[node].generation = 0;
+	}
+	Node& timer = nodes[node];
+	timer.generation++;
+	if (timer.generation == 0)                                 // Generation 0 never used, so a Handle is never NoTimer
+		timer.generation = 1;
+	timer.expiry = now + ((ticks < 1) ? 1 : ((ticks > MaxTicks) ? MaxTicks : ticks));
+	timer.type = type;
+	timer.data = data;
+	insert(node);
+	count++;
+
+	return (((Handle)timer.generation << 32) | (unsigned int)node);
+}
+
+void TimingWheel::restart(Handle& timer, unsigned long long ticks, unsigned int type, unsigned int data)
+{
+	stop(timer);
+	timer = start(ticks, type, data);
+}
+
+void TimingWheel::stop(Handle& timer)
+{
+	int node = nodeIndex(timer);
+	if (node >= 0)
+	{
+		unlink(node);
+		nodes[node].slot = FreeSlot;
+		nodes[node].next = freeNodes;
+		freeNodes = node;
+		count--;
+	}
+	timer = NoTimer;
+}
+
+bool TimingWheel::running(Handle timer) const
+{
+	return (nodeIndex(timer) >= 0);
+}
+
+void TimingWheel::setData(Handle timer, unsigned int data)
+{
+	int node = nodeIndex(timer);
+	if (node >= 0)
+		nodes[node].data = data;
+}
+
+unsigned long long TimingWheel::remaining(Handle timer) const
+{
+	int node = nodeIndex(timer);
+	if ((node < 0) || (nodes[node].slot == ExpiredSlot))
+		return (0);
+	return (nodes[node].expiry - now);
+}
+
+void TimingWheel::advance(unsigned long long ticks)
+{
+	if (count == 0)                                            // Nothing to expire or cascade
+	{
+		now += ticks;
+		return;
+	}
+
+	for (unsigned long long tick = 0; tick < ticks; tick++)
+	{
+		now++;
+		unsigned int slot = now & (SlotsPerLevel - 1);
+		if (slot == 0)                                         // Level 0 wrapped, so cascade from higher levels
+		{
+			unsigned int level = 1;
+			while ((level < Levels - 1) && (((now >> (SlotBits * level)) & (SlotsPerLevel - 1)) == 0))
+				level++;
+			for (; level > 0; level--)                         // Highest level first, so timers can fall more than one level
+				cascade(level);
+		}
+		if (occupied[0] & (1ULL << slot))
+			expire(slot);
+	}
+}
+
+bool TimingWheel::popExpired(unsigned int& type, unsigned int& data)
+{
+	if (expiredHead < 0)
+		return (false);
+
+	Handle timer = ((Handle)nodes[expiredHead].generation << 32) | (unsigned int)expiredHead;
+	type = nodes[expiredHead].type;
+	data = nodes[expiredHead].data;
+	stop(timer);
+	return (true);
+}
+
+bool TimingWheel::hasExpired() const
+{
+	return (expiredHead >= 0);
+}
+
+long long TimingWheel::ticksToNextExpiry() const
+{
+	if (expiredHead >= 0)
+		return (0);
+	if (count == 0)
+		return (-1);
+
+	//  On each level the first occupied slot after the current position holds that level's earliest timers (the slot
+	//     at the current position has been expired or cascaded, so any timers now in it are a full turn away).
+	//     A higher level can hold a timer due before one on a lower level, so check the first slot on every level.
+	unsigned long long earliest = ~0ULL;
+	for (unsigned int level = 0; level < Levels; level++)
+	{
+		if (occupied[level] == 0)
+			continue;
+		unsigned int position = (now >> (SlotBits * level)) & (SlotsPerLevel - 1);
+		unsigned int slot = (position + 1) & (SlotsPerLevel - 1);
+		while (!(occupied[level] & (1ULL << slot)))
+			slot = (slot + 1) & (SlotsPerLevel - 1);
+		for (int node = heads[level][slot]; node >= 0; node = nodes[node].next)
+			earliest = std::min(earliest, nodes[node].expiry);
+	}
+	return ((long long)(earliest - now));
+}
+
+size_t TimingWheel::size() const
+{
+	return (count);
+}
+
+int TimingWheel::nodeIndex(Handle timer) const
+{
+	unsigned int node = (unsigned int)timer;
+	if ((timer == NoTimer) || (node >= nodes.size()) || (nodes[node].generation != (unsigned int)(timer >> 32)) ||
+		(nodes[node].slot == FreeSlot))
+		return (-1);
+	return ((int)node);
+}
+
+void TimingWheel::insert(int node)
+{
+	Node& timer = nodes[node];
+	unsigned long long delta = timer.expiry - now;
+	unsigned int level = 0;
+	while ((level < Levels - 1) && (delta >= (1ULL << (SlotBits * (level + 1)))))
+		level++;
+	unsigned int slot = (timer.expiry >> (SlotBits * level)) & (SlotsPerLevel - 1);
+
+	if (!heads[level])
+	{
+		heads[level] = std::unique_ptr<int[]>(new int[SlotsPerLevel]);
+		for (unsigned int i = 0; i < SlotsPerLevel; i++)
+			heads[level][i] = -1;
+	}
+	int& head = heads[level][slot];
+	timer.slot = (level * SlotsPerLevel) + slot;
+	timer.prev = -1;
+	timer.next = head;
+	if (head >= 0)
+		nodes[head].prev = node;
+	head = node;
+	occupied[level] |= (1ULL << slot);
+}
+
+void TimingWheel::unlink(int node)
+{
+	Node& timer = nodes[node];
+	if (timer.slot == ExpiredSlot)
+	{
+		if (timer.prev >= 0) nodes[timer.prev].next = timer.next;
+		else expiredHead = timer.next;
+		if (timer.next >= 0) nodes[timer.next].prev = timer.prev;
+		else expiredTail = timer.prev;
+	}
+	else
+	{
+		unsigned int level = timer.slot / SlotsPerLevel;
+		unsigned int slot = timer.slot % SlotsPerLevel;
+		if (timer.prev >= 0) nodes[timer.prev].next = timer.next;
+		else heads[level][slot] = timer.next;
+		if (timer.next >= 0) nodes[timer.next].prev = timer.prev;
+		if (heads[level][slot] < 0)
+			occupied[level] &= ~(1ULL << slot);
+	}
+}
+
+void TimingWheel::cascade(unsigned int level)
+{
+	unsigned int slot = (now >> (SlotBits * level)) & (SlotsPerLevel - 1);
+	if (!(occupied[level] & (1ULL << slot)))
+		return;
+
+	int node = heads[level][slot];
+	heads[level][slot] = -1;
+	occupied[level] &= ~(1ULL << slot);
+	while (node >= 0)
+	{
+		int next = nodes[node].next;
+		insert(node);                                          // Now due within range of a lower level
+		node = next;
+	}
+}
+
+void TimingWheel::expire(unsigned int slot)
+{
+	//  Every timer in the current level 0 slot expires now.  Move them to the end of the expired list.
+	int node = heads[0][slot];
+	heads[0][slot] = -1;
+	occupied[0] &= ~(1ULL << slot);
+	while (node >= 0)
+	{
+		int next = nodes[node].next;
+		nodes[node].slot = ExpiredSlot;
+		nodes[node].prev = expiredTail;
+		nodes[node].next = -1;
+		if (expiredTail >= 0) nodes[expiredTail].next = node;
+		else expiredHead = node;
+		expiredTail = node;
+		node = next;
+	}
+}
@@ -0,0 +1,91 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <memory>
+#include <vector>
+
+/*
+*   Class TimingWheel holds any number of one-shot timers, and costs O(1) to start or stop a timer and
+*      O(1 + timers expired) per tick, regardless of how many timers are running.
+*   Timers are kept in a hierarchy of Levels wheels of SlotsPerLevel slots:  a timer due within SlotsPerLevel ticks is in
+*      the slot for its expiry tick on level 0, and a timer due later is in a slot of a higher level covering a range of
+*      ticks.  When level 0 wraps, the next slot of level 1 is "cascaded" by moving its timers down to level 0, and so on.
+*      Slot arrays for a level are allocated when a timer is first put on that level.
+*   Each timer carries a type and a data value chosen by the owner (e.g. timer kind and neighbor index).  Expired timers
+*      are held, in expiry order, until the owner collects them with popExpired().
+*   A Handle identifies a running (or expired but not collected) timer.  Handles include a generation count,
+*      so using a Handle after its timer has been stopped or collected is harmless.
+*/
+
+class TimingWheel
+{
+public:
+	typedef unsigned long long Handle;
+	static const Handle NoTimer = 0;
+
+	static const unsigned int SlotBits = 6;
+	static const unsigned int SlotsPerLevel = 1 << SlotBits;
+	static const unsigned int Levels = 4;
+	static const unsigned long long MaxTicks = (1ULL << (SlotBits * Levels)) - 1;
+
+	TimingWheel();
+	~TimingWheel();
+	TimingWheel(TimingWheel& copySource) = delete;             // Disable copy constructor
+	TimingWheel& operator= (const TimingWheel&) = delete;      // Disable assignment operator
+
+	Handle start(unsigned long long ticks, unsigned int type, unsigned int data);   // Expires after ticks calls to advance
+	void restart(Handle& timer, unsigned long long ticks, unsigned int type, unsigned int data);
+	void stop(Handle& timer);                                  // Sets timer to NoTimer
+	bool running(Handle timer) const;                          // True if running or expired but not collected
+	void setData(Handle timer, unsigned int data);
+	unsigned long long remaining(Handle timer) const;          // Ticks until timer expires (0 if expired or not running)
+
+	void advance(unsigned long long ticks = 1);
+	bool popExpired(unsigned int& type, unsigned int& data);   // Collects the earliest expired timer;  false if none
+	bool hasExpired() const;
+	long long ticksToNextExpiry() const;                       // 0 if any expired timers are waiting;  -1 if no timers
+	size_t size() const;                                       // Timers running or waiting to be collected
+
+private:
+	struct Node
+	{
+		unsigned long long expiry;
+		unsigned int type;
+		unsigned int data;
+		unsigned int generation;
+		int slot;                                              // Slot number, or FreeSlot or ExpiredSlot
+		int prev;
+		int next;
+	};
+	static const int FreeSlot = -1;
+	static const int ExpiredSlot = Levels * SlotsPerLevel;
+
+	unsigned long long now;
+	std::vector<Node> nodes;
+	int freeNodes;                                             // Singly linked through next
+	std::unique_ptr<int[]> heads[Levels];                      // First node in each slot, or -1
+	unsigned long long occupied[Levels];                       // Bit per slot with any nodes
+	int expiredHead;
+	int expiredTail;
+	size_t count;
+
+	int nodeIndex(Handle timer) const;                         // -1 if handle does not name a live timer
+	void insert(int node);
+	void unlink(int node);
+	void cascade(unsigned int level);
+	void expire(unsigned int slot);
+};
@@ -0,0 +1,508 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+#include <fstream>
+#include "Topology.h"
+#include "LinkLayerDiscovery.h"
+
+
+static LinkLayerDiscovery* findLldp(Device& device)
+{
+	for (auto& pComp : device.pComponents)
+		if (pComp->getCompType() == ComponentTypes::LINK_LAYER_DISCOVERY)
+			return (static_cast<LinkLayerDiscovery*>(pComp.get()));
+	return (nullptr);
+}
+
+
+Topology::Topology(std::vector<unique_ptr<Device>>& devices)
+	: Devices(devices)
+{
+	firstDevice = Devices.size();
+	linkCount = 0;
+	impairedLinks = 0;
+	endTime = 1000;
+	fieldCount = 0;
+	lineNumber = 0;
+}
+
+Topology::~Topology()
+{
+}
+
+bool Topology::load(const std::string& fileName)
+{
+	std::ifstream file(fileName);
+	if (!file)
+	{
+		error = fileName + ":  can't open file";
+		return (false);
+	}
+
+	std::string line;
+	lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		if (!parseLine(line))
+		{
+			error = fileName + ":" + error;
+			return (false);
+		}
+	}
+	lineNumber = 0;
+	return (true);
+}
+
+bool Topology::parseLine(const std::string& line)
+{
+	lineNumber++;
+	if (!split(line))
+		return (false);
+	if (fieldCount == 0)
+		return (true);
+
+	const std::string& keyword = fields[0];
+	if (keyword == "bridge")
+		return (parseDevice(true));
+	if (keyword == "endstation")
+		return (parseDevice(false));
+	if (keyword == "link")
+		return (parseConnect(true, 0, 1));
+	if (keyword == "at")
+		return (parseEvent());
+	if (keyword == "end")
+	{
+		if (fieldCount != 2)
+			return (fail("expected end TIME"));
+		return (parseTime(fields[1], endTime));
+	}
+	return (fail("unknown keyword " + keyword));
+}
+
+bool Topology::split(const std::string& line)
+{
+	fieldCount = 0;
+	const char* pos = line.c_str();
+	while (true)
+	{
+		while ((*pos == ' ') || (*pos == '\t') || (*pos == '\r'))
+			pos++;
+		if ((*pos == '\0') || (*pos == '#'))
+			return (true);
+
+		const char* start = pos;
+		if (*pos == '"')                                      // Quoted field runs to the closing quote
+		{
+			start = ++pos;
+			while ((*pos != '"') && (*pos != '\0'))
+				pos++;
+			if (*pos != '"')
+				return (fail("missing closing quote"));
+		}
+		else
+		{
+			while ((*pos != ' ') && (*pos != '\t') && (*pos != '\r') && (*pos != '\0') && (*pos != '#'))
+				pos++;
+		}
+
+		if (fieldCount == fields.size())
+			fields.emplace_back();
+		fields[fieldCount++].assign(start, pos);
+		if (*pos == '"')
+			pos++;
+	}
+}
+
+bool Topology::fail(const std::string& message)
+{
+	error = (lineNumber > 0) ? (std::to_string(lineNumber) + ":  " + message) : message;
+	return (false);
+}
+
+bool Topology::parseDevice(bool bridge)
+{
+	if (fieldCount < 3)
+		return (fail(bridge ? "expected bridge NAME MACS" : "expected endstation NAME MACS"));
+
+	const std::string& name = fields[1];
+	if ((name == "*") || (name.find(':') != std::string::npos))
+		return (fail("device name can't be * or contain :"));
+	if (names.count(name))
+		return (fail("device " + name + " already exists"));
+
+	unsigned long long macs = 0;
+	if (!parseNumber(fields[2].c_str(), macs) || (macs == 0) || (macs > MaxMacs))
+		return (fail("MACS must be from 1 to " + std::to_string(MaxMacs)));
+
+	size_t next = 3;
+	if (bridge)
+	{
+		unsigned short vlanType = CVlanEthertype;
+		if (next < fieldCount)                         // Optional type, otherwise the field is the description
+		{
+			bool typeGiven = true;
+			if (fields[next] == "mac")
+				vlanType = 0;
+			else if (fields[next] == "c-vlan")
+				vlanType = CVlanEthertype;
+			else if (fields[next] == "s-vlan")
+				vlanType = SVlanEthertype;
+			else
+				typeGiven = false;
+			if (typeGiven)
+				next++;
+		}
+		if (next + 1 < fieldCount)
+			return (fail("too many fields"));
+		addBridge(name, (int)macs, vlanType, (next < fieldCount) ? fields[next] : "");
+	}
+	else
+	{
+		if (next + 1 < fieldCount)
+			return (fail("too many fields"));
+		addEndStation(name, (int)macs, (next < fieldCount) ? fields[next] : "");
+	}
+	return (true);
+}
+
+bool Topology::parseConnect(bool atStart, int time, size_t first)
+{
+	if (fieldCount < first + 2)
+		return (fail("expected NAME:MAC NAME:MAC"));
+
+	TopologyEvent event = {};
+	event.time = time;
+	event.action = TOPO_CONNECT;
+	event.impairment = -1;
+	if (!parseMac(fields[first], event.devA, event.macA) || !parseMac(fields[first + 1], event.devB, event.macB))
+		return (false);
+	if ((event.devA == event.devB) && (event.macA == event.macB))
+		return (fail("can't link a MAC to itself"));
+
+	for (size_t i = first + 2; i < fieldCount; i++)
+	{
+		const std::string& option = fields[i];
+		size_t equals = option.find('=');
+		if (equals == std::string::npos)
+			return (fail("expected NAME=VALUE, not " + option));
+		const char* value = option.c_str() + equals + 1;
+		unsigned long long number = 0;
+
+		if (option.compare(0, equals, "delay") == 0)
+		{
+			if (!parseNumber(value, number) || (number > 0xffff))
+				return (fail("delay must be from 0 to 65535"));
+			event.delay = (unsigned short)number;
+		}
+		else if (option.compare(0, equals, "bandwidth") == 0)
+		{
+			if (!parseNumber(value, number) || (number > 0xffffffff))
+				return (fail("bandwidth must be from 0 to 4294967295"));
+			event.bandwidth = (unsigned long)number;
+		}
+		else if (option.compare(0, equals, "impair") == 0)
+		{
+			ImpairmentProfile profile;
+			unsigned long long seed = 1;
+			if (!parseImpairmentProfile(value, profile, seed))
+				return (fail("can't parse impairment profile " + std::string(value)));
+			event.impairment = addImpairment(profile, seed + (2 * impairedLinks++));
+		}
+		else
+			return (fail("unknown link option " + option));
+	}
+
+	if (atStart)
+		addLink(event.devA, event.macA, event.devB, event.macB, event.delay, event.bandwidth, event.impairment);
+	else
+		addEvent(event);
+	return (true);
+}
+
+bool Topology::parseEvent()
+{
+	if (fieldCount < 4)
+		return (fail("expected at TIME ACTION ..."));
+
+	TopologyEvent event = {};
+	event.impairment = -1;
+	if (!parseTime(fields[1], event.time))
+		return (false);
+
+	const std::string& action = fields[2];
+	if (action == "connect")
+		return (parseConnect(false, event.time, 3));
+
+	if (action == "disconnect")
+		event.action = TOPO_DISCONNECT;
+	else if (action == "enable")
+		event.action = TOPO_ENABLE;
+	else if (action == "disable")
+		event.action = TOPO_DISABLE;
+	else if (action == "suspend")
+		event.action = TOPO_SUSPEND;
+	else if (action == "resume")
+		event.action = TOPO_RESUME;
+	else if (action == "lldpv2")
+		event.action = TOPO_LLDPV2;
+	else
+		return (fail("unknown action " + action));
+
+	size_t expected = (event.action == TOPO_LLDPV2) ? 5 : 4;
+	bool wholeDevice = (event.action == TOPO_SUSPEND) || (event.action == TOPO_RESUME) || (event.action == TOPO_LLDPV2);
+
+	if (fieldCount != expected)
+		return (fail("wrong number of fields for " + action));
+	if (!parseTarget(fields[3], event.devA, event.macA))
+		return (false);
+	if (wholeDevice && (event.macA != -1))
+		return (fail(action + " applies to a device, not a MAC"));
+	if (event.action == TOPO_LLDPV2)
+	{
+		if ((fields[4] != "on") && (fields[4] != "off"))
+			return (fail("expected lldpv2 TARGET on|off"));
+		event.enable = (fields[4] == "on");
+	}
+
+	addEvent(event);
+	return (true);
+}
+
+bool Topology::parseNumber(const char* field, unsigned long long& value)
+{
+	if (!isdigit((unsigned char)*field))
+		return (false);
+	char* end = nullptr;
+	value = strtoull(field, &end, 10);
+	return (*end == '\0');
+}
+
+bool Topology::parseTime(const std::string& field, int& time)
+{
+	unsigned long long number = 0;
+	if (!parseNumber(field.c_str(), number) || (number >= (unsigned long long)SimTimeNever / 2))
+		return (fail("bad time " + field));
+	time = (int)number;
+	return (true);
+}
+
+bool Topology::parseMac(const std::string& field, size_t& dev, int& mac)
+{
+	size_t colon = field.rfind(':');
+	if (colon == std::string::npos)
+		return (fail("expected NAME:MAC, not " + field));
+
+	macDevice.assign(field, 0, colon);
+	dev = findDevice(macDevice);
+	if (dev == NoDevice)
+		return (fail("unknown device in " + field));
+	unsigned long long number = 0;
+	if (!parseNumber(field.c_str() + colon + 1, number) || (number >= Devices[dev]->pMacs.size()))
+		return (fail("no such MAC " + field));
+	mac = (int)number;
+	return (true);
+}
+
+bool Topology::parseTarget(const std::string& field, size_t& dev, int& mac)
+{
+	if (field == "*")
+	{
+		dev = AllDevices;
+		mac = -1;
+		return (true);
+	}
+	if (field.find(':') != std::string::npos)
+		return (parseMac(field, dev, mac));
+
+	dev = findDevice(field);
+	mac = -1;
+	if (dev == NoDevice)
+		return (fail("unknown device " + field));
+	return (true);
+}
+
+
+size_t Topology::addBridge(const std::string& name, int macs, unsigned short vlanType, const std::string& desc)
+{
+	unique_ptr<Device> pDev = make_unique<Device>(macs);
+	pDev->createBridge(vlanType, name, desc);
+	Devices.push_back(move(pDev));
+	names.emplace(name, Devices.size() - 1);
+	return (Devices.size() - 1);
+}
+
+size_t Topology::addEndStation(const std::string& name, int macs, const std::string& desc)
+{
+	unique_ptr<Device> pDev = make_unique<Device>(macs);
+	pDev->createEndStation(name, desc);
+	Devices.push_back(move(pDev));
+	names.emplace(name, Devices.size() - 1);
+	return (Devices.size() - 1);
+}
+
+void Topology::addLink(size_t devA, int macA, size_t devB, int macB, unsigned short delay, unsigned long bandwidth,
+	int impairment)
+{
+	TopologyEvent event = {};
+	event.time = 0;
+	event.action = TOPO_CONNECT;
+	event.devA = devA;
+	event.macA = macA;
+	event.devB = devB;
+	event.macB = macB;
+	event.delay = delay;
+	event.bandwidth = bandwidth;
+	event.impairment = impairment;
+	addEvent(event);
+	linkCount++;
+}
+
+int Topology::addImpairment(const ImpairmentProfile& profile, unsigned long long seed)
+{
+	impairments.push_back(Impairment{ profile, seed });
+	return ((int)impairments.size() - 1);
+}
+
+void Topology::addEvent(const TopologyEvent& event)
+{
+	events.push_back(event);
+}
+
+
+void Topology::schedule(EventScheduler& sim, int start)
+{
+	std::stable_sort(events.begin(), events.end(),
+		[](const TopologyEvent& a, const TopologyEvent& b) { return (a.time < b.time); });
+
+	size_t first = 0;
+	while (first < events.size())
+	{
+		size_t last = first + 1;
+		while ((last < events.size()) && (events[last].time == events[first].time))
+			last++;
+		sim.schedule(start + events[first].time, [this, first, last]() {
+			for (size_t i = first; i < last; i++)
+				apply(events[i]);
+			});
+		first = last;
+	}
+}
+
+void Topology::apply(const TopologyEvent& event)
+{
+	if (event.action == TOPO_CONNECT)
+	{
+		shared_ptr<Mac> pMacA = Devices[event.devA]->pMacs[event.macA];
+		shared_ptr<Mac> pMacB = Devices[event.devB]->pMacs[event.macB];
+		Mac::Connect(pMacA, pMacB, event.delay, event.bandwidth);
+		if (event.impairment >= 0)
+		{
+			const Impairment& impairment = impairments[event.impairment];
+			pMacA->setImpairments(impairment.profile, impairment.seed);        // Each direction gets its own seed
+			pMacB->setImpairments(impairment.profile, impairment.seed + 1);
+		}
+		else                                    // Connect does not change impairments, so drop any from an earlier link
+		{
+			pMacA->clearImpairments();
+			pMacB->clearImpairments();
+		}
+		return;
+	}
+
+	size_t first = event.devA;
+	size_t last = event.devA + 1;
+	if (event.devA == AllDevices)
+	{
+		first = firstDevice;
+		last = Devices.size();
+	}
+
+	for (size_t dev = first; dev < last; dev++)
+	{
+		Device& device = *Devices[dev];
+		switch (event.action)
+		{
+		case TOPO_DISCONNECT:
+		case TOPO_ENABLE:
+		case TOPO_DISABLE:
+			applyToMacs(event, device);
+			break;
+		case TOPO_SUSPEND:
+		case TOPO_RESUME:
+			device.setSuspended(event.action == TOPO_SUSPEND);
+			break;
+		case TOPO_LLDPV2:
+			if (LinkLayerDiscovery* pLldp = findLldp(device))
+				for (auto& pPort : pLldp->pLldpPorts)
+					pPort->set_lldpV2Enabled(event.enable);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void Topology::applyToMacs(const TopologyEvent& event, Device& device)
+{
+	size_t first = (event.macA < 0) ? 0 : event.macA;
+	size_t last = (event.macA < 0) ? device.pMacs.size() : event.macA + 1;
+	for (size_t mac = first; mac < last; mac++)
+	{
+		if (event.action == TOPO_DISCONNECT)
+			Mac::Disconnect(device.pMacs[mac]);
+		else
+			device.pMacs[mac]->setEnabled(event.action == TOPO_ENABLE);
+	}
+}
+
+
+size_t Topology::findDevice(const std::string& name) const
+{
+	auto it = names.find(name);
+	return ((it == names.end()) ? NoDevice : it->second);
+}
+
+size_t Topology::getDeviceCount() const
+{
+	return (Devices.size() - firstDevice);
+}
+
+size_t Topology::getLinkCount() const
+{
+	return (linkCount);
+}
+
+size_t Topology::getEventCount() const
+{
+	return (events.size());
+}
+
+int Topology::get_endTime() const
+{
+	return (endTime);
+}
+
+void Topology::set_endTime(int time)
+{
+	endTime = time;
+}
+
+const std::string& Topology::getError() const
+{
+	return (error);
+}
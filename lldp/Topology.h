@@ -0,0 +1,155 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Device.h"
+#include "EventScheduler.h"
+#include "LinkImpairments.h"
+
+/*
+*   Class Topology builds Devices, and the links between their Macs, from a topology description, and schedules the
+*      timed events of the scenario that goes with it on an EventScheduler.
+*   A description is read a line at a time, so Devices are built as the file is read.  Blank lines and anything after
+*      a # are ignored, and a field holding spaces is written in double quotes.  Each line is one of:
+*         bridge NAME MACS [mac|c-vlan|s-vlan] ["description"]     A Device with a Bridge (C-VLAN by default) and LLDP
+*         endstation NAME MACS ["description"]                    A Device with an End Station on its first Mac
+*         link NAME:MAC NAME:MAC [delay=TICKS] [bandwidth=OCTETS] [impair=SPEC]     Connected when the scenario starts
+*         at TIME connect NAME:MAC NAME:MAC [delay=TICKS] [bandwidth=OCTETS] [impair=SPEC]
+*         at TIME disconnect|enable|disable TARGET                 TARGET is NAME:MAC, NAME (all its Macs), or *
+*         at TIME suspend|resume NAME|*
+*         at TIME lldpv2 NAME|* on|off                            Sets lldpV2Enabled on every LLDP port of the Device
+*         end TIME                                                Time the scenario ends (default 1000)
+*      MAC is the index of the Mac in the Device, from 0.  Times are ticks from the start of the scenario.
+*      SPEC is an impairment profile as read by parseImpairmentProfile (without spaces).  The two directions of an
+*         impaired link get the profile's seed plus 2n and 2n+1, where n counts the impaired links before it, so
+*         every direction has a different sequence.
+*   Devices, links and events can also be added with the add methods, or by one of the generators below.
+*   Events are sorted by time (keeping the order they were added within a time) and schedule() gives the
+*      EventScheduler one action for each time, so the Topology must last until the EventScheduler has finished.
+*/
+
+/*
+*   The generators build standard networks of Bridges for scale testing (see TopologyGenerators.cpp):
+*      fattree     k-ary fat tree:  (k/2)^2 core, k pods of k/2 aggregation and k/2 edge Bridges, all with k Macs,
+*                     and (with hosts) k/2 single Mac End Stations on each edge Bridge
+*      torus2d, torus3d    x by y (by z) grid with wrap around;  each Bridge has 2 Macs per dimension longer than 1
+*      ring        n Bridges with 2 Macs each
+*      star        a hub Bridge with n Macs, each linked to a leaf Bridge with 1 Mac
+*      random      Erdos-Renyi G(n, p):  each pair of n Bridges is linked with probability p, and each Bridge has
+*                     a Mac for each of its links
+*   Bridges are named by position (e.g. "core3", "agg1_0", "edge1_1", "host1_1_0", "t2_5_0", "r17", "hub", "leaf9",
+*      "n42"), so a scenario can refer to them.  Link delays are drawn from 1 to maxDelay (1 unless given) with a
+*      SplitMix64 seeded with seed, which also draws the random graph, so the same parameters always give the same network.
+*   generate() takes a name and parameters as "NAME:name=value,...", e.g. "fattree:k=8,hosts=1,seed=3" or
+*      "random:n=10000,degree=4".  Names are k, hosts, x, y, z, n, p, degree, delay (maxDelay), seed, and end
+*      (scenario length).  Sizes not given have defaults that build a few thousand Devices;  a generated network of
+*      more than MaxDeviceAddresses Devices is refused, since past that Mac addresses would repeat.
+*/
+
+enum TopologyActions { TOPO_CONNECT, TOPO_DISCONNECT, TOPO_ENABLE, TOPO_DISABLE, TOPO_SUSPEND, TOPO_RESUME, TOPO_LLDPV2 };
+
+class TopologyEvent
+{
+public:
+	int time;
+	TopologyActions action;
+	size_t devA;                     // Index in Devices, or Topology::AllDevices
+	int macA;                        // Index in pMacs, or -1 for every Mac of the Device
+	size_t devB;
+	int macB;
+	unsigned short delay;
+	unsigned long bandwidth;
+	int impairment;                  // Index in impairments, or -1 for none
+	bool enable;                     // For TOPO_LLDPV2
+};
+
+class Topology
+{
+public:
+	Topology(std::vector<unique_ptr<Device>>& devices);
+	~Topology();
+	Topology(Topology& copySource) = delete;             // Disable copy constructor
+	Topology& operator= (const Topology&) = delete;      // Disable assignment operator
+
+	static const size_t AllDevices = ~(size_t)0;
+	static const size_t NoDevice = ~(size_t)1;
+	static const int MaxMacs = 0xfff;                    // Sap ids above 0xfff would overlap the sysNum
+
+	bool load(const std::string& fileName);              // False if the file can't be read or a line is not valid
+	bool parseLine(const std::string& line);             // False if the line is not valid (see getError())
+
+	size_t addBridge(const std::string& name, int macs, unsigned short vlanType = CVlanEthertype, const std::string& desc = "");
+	size_t addEndStation(const std::string& name, int macs, const std::string& desc = "");
+	void addLink(size_t devA, int macA, size_t devB, int macB, unsigned short delay = 0, unsigned long bandwidth = 0,
+		int impairment = -1);
+	int addImpairment(const ImpairmentProfile& profile, unsigned long long seed);   // Returns index for addLink/addEvent
+	void addEvent(const TopologyEvent& event);
+
+	bool generate(const std::string& spec);              // False if spec is not valid (see getError())
+	bool generateFatTree(unsigned int k, bool hosts, unsigned short maxDelay = 1, unsigned long long seed = 1);
+	bool generateTorus(unsigned int x, unsigned int y, unsigned int z, unsigned short maxDelay = 1, unsigned long long seed = 1);
+	bool generateRing(unsigned int n, unsigned short maxDelay = 1, unsigned long long seed = 1);
+	bool generateStar(unsigned int n, unsigned short maxDelay = 1, unsigned long long seed = 1);
+	bool generateRandom(unsigned int n, double p, unsigned short maxDelay = 1, unsigned long long seed = 1);
+
+	void schedule(EventScheduler& sim, int start);       // Schedules every event at start + its time
+	void apply(const TopologyEvent& event);              // Carries out one event now
+
+	size_t findDevice(const std::string& name) const;    // Returns NoDevice if there is no Device with that name
+	size_t getDeviceCount() const;                       // Devices built by this Topology
+	size_t getLinkCount() const;
+	size_t getEventCount() const;
+	int get_endTime() const;
+	void set_endTime(int time);
+	const std::string& getError() const;
+
+private:
+	struct Impairment
+	{
+		ImpairmentProfile profile;
+		unsigned long long seed;
+	};
+
+	std::vector<unique_ptr<Device>>& Devices;
+	size_t firstDevice;                                  // Index in Devices of the first Device built here
+	std::unordered_map<std::string, size_t> names;
+	std::vector<TopologyEvent> events;
+	std::vector<Impairment> impairments;
+	size_t linkCount;
+	size_t impairedLinks;                                // Impaired links read so far (for their seeds)
+	int endTime;
+
+	std::vector<std::string> fields;                     // Fields of the line being parsed (strings reused for each line)
+	size_t fieldCount;
+	std::string macDevice;                               // Device name of a NAME:MAC field (reused)
+	std::string error;
+	unsigned long lineNumber;
+
+	bool split(const std::string& line);
+	bool fail(const std::string& message);
+	bool parseDevice(bool bridge);
+	bool parseConnect(bool atStart, int time, size_t first);
+	bool parseEvent();
+	bool parseTime(const std::string& field, int& time);
+	static bool parseNumber(const char* field, unsigned long long& value);     // Whole field must be a decimal number
+	bool parseMac(const std::string& field, size_t& dev, int& mac);
+	bool parseTarget(const std::string& field, size_t& dev, int& mac);
+	void applyToMacs(const TopologyEvent& event, Device& device);
+	static unsigned short drawDelay(SplitMix64& rng, unsigned short maxDelay);
+};
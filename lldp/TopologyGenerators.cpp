@@ -0,0 +1,271 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include <cmath>
+#include "Topology.h"
+
+
+bool Topology::generate(const std::string& spec)
+{
+	lineNumber = 0;
+	size_t colon = spec.find(':');
+	std::string name = spec.substr(0, colon);
+
+	unsigned long long k = 16;
+	unsigned long long hosts = 1;
+	unsigned long long x = 0;
+	unsigned long long y = 0;
+	unsigned long long z = 0;
+	unsigned long long n = 4096;
+	double p = -1.0;
+	double degree = 4.0;
+	unsigned long long maxDelay = 1;
+	unsigned long long seed = 1;
+
+	size_t start = (colon == std::string::npos) ? spec.size() : colon + 1;
+	while (start < spec.size())
+	{
+		size_t end = spec.find(',', start);
+		if (end == std::string::npos)
+			end = spec.size();
+		std::string pair = spec.substr(start, end - start);
+		start = end + 1;
+
+		size_t equals = pair.find('=');
+		if (equals == std::string::npos)
+			return (fail("expected name=value, not " + pair));
+		std::string param = pair.substr(0, equals);
+		const char* value = pair.c_str() + equals + 1;
+		unsigned long long number = 0;
+		bool isNumber = parseNumber(value, number);
+
+		if ((param == "p") || (param == "degree"))
+		{
+			char* valueEnd = nullptr;
+			double real = strtod(value, &valueEnd);
+			if ((*valueEnd != '\0') || (real < 0.0))
+				return (fail("bad value for " + param));
+			((param == "p") ? p : degree) = real;
+			continue;
+		}
+		if (!isNumber)
+			return (fail("bad value for " + param));
+		if (param == "k") k = number;
+		else if (param == "hosts") hosts = number;
+		else if (param == "x") x = number;
+		else if (param == "y") y = number;
+		else if (param == "z") z = number;
+		else if (param == "n") n = number;
+		else if (param == "delay") maxDelay = number;
+		else if (param == "seed") seed = number;
+		else if (param == "end")
+		{
+			if (number >= (unsigned long long)SimTimeNever / 2)
+				return (fail("end time out of range"));
+			endTime = (int)number;
+		}
+		else
+			return (fail("unknown parameter " + param));
+	}
+	if ((maxDelay > 0xffff) || (k > MaxMacs) || (x > 0xffff) || (y > 0xffff) || (z > 0xffff) || (n > MaxDeviceAddresses))
+		return (fail("parameter out of range in " + spec));
+
+	if (name == "fattree")
+		return (generateFatTree((unsigned int)k, (hosts != 0), (unsigned short)maxDelay, seed));
+	if (name == "torus2d")
+		return (generateTorus((unsigned int)(x ? x : 64), (unsigned int)(y ? y : 64), 1, (unsigned short)maxDelay, seed));
+	if (name == "torus3d")
+		return (generateTorus((unsigned int)(x ? x : 16), (unsigned int)(y ? y : 16), (unsigned int)(z ? z : 16),
+			(unsigned short)maxDelay, seed));
+	if (name == "ring")
+		return (generateRing((unsigned int)n, (unsigned short)maxDelay, seed));
+	if (name == "star")
+		return (generateStar((unsigned int)std::min(n, (unsigned long long)MaxMacs), (unsigned short)maxDelay, seed));
+	if (name == "random")
+	{
+		if (p < 0.0)
+			p = (n > 1) ? (degree / (double)(n - 1)) : 0.0;
+		return (generateRandom((unsigned int)n, p, (unsigned short)maxDelay, seed));
+	}
+	return (fail("unknown generator " + name));
+}
+
+unsigned short Topology::drawDelay(SplitMix64& rng, unsigned short maxDelay)
+{
+	return ((maxDelay > 1) ? (unsigned short)(1 + rng.below(maxDelay)) : maxDelay);
+}
+
+
+bool Topology::generateFatTree(unsigned int k, bool hosts, unsigned short maxDelay, unsigned long long seed)
+{
+	if ((k < 2) || (k % 2) || (k > MaxMacs - 1))
+		return (fail("fat tree k must be even, from 2 to " + std::to_string(MaxMacs - 1)));
+	if ((5ULL * k * k / 4) + (hosts ? (1ULL * k * k * k / 4) : 0) > MaxDeviceAddresses)
+		return (fail("fat tree needs more than " + std::to_string(MaxDeviceAddresses) + " Devices"));
+
+	//  Core Bridge (i * half) + j connects to aggregation Bridge i of every pod;  port p of a core Bridge goes to pod p.
+	//     In each pod, ports 0 to half - 1 of an aggregation Bridge go to the edge Bridges, and ports half to k - 1 to
+	//     the core.  Ports 0 to half - 1 of an edge Bridge go to hosts, and ports half to k - 1 to the aggregation Bridges.
+	SplitMix64 rng(seed);
+	unsigned int half = k / 2;
+	std::vector<size_t> core;
+	for (unsigned int c = 0; c < half * half; c++)
+		core.push_back(addBridge("core" + std::to_string(c), k));
+
+	for (unsigned int pod = 0; pod < k; pod++)
+	{
+		std::string podName = std::to_string(pod) + "_";
+		std::vector<size_t> agg;
+		for (unsigned int a = 0; a < half; a++)
+			agg.push_back(addBridge("agg" + podName + std::to_string(a), k));
+		for (unsigned int e = 0; e < half; e++)
+		{
+			size_t edge = addBridge("edge" + podName + std::to_string(e), k);
+			for (unsigned int a = 0; a < half; a++)
+				addLink(edge, half + a, agg[a], e, drawDelay(rng, maxDelay));
+			for (unsigned int h = 0; hosts && (h < half); h++)
+			{
+				size_t host = addEndStation("host" + podName + std::to_string(e) + "_" + std::to_string(h), 1);
+				addLink(host, 0, edge, h, drawDelay(rng, maxDelay));
+			}
+		}
+		for (unsigned int a = 0; a < half; a++)
+			for (unsigned int j = 0; j < half; j++)
+				addLink(agg[a], half + j, core[(a * half) + j], pod, drawDelay(rng, maxDelay));
+	}
+	return (true);
+}
+
+bool Topology::generateTorus(unsigned int x, unsigned int y, unsigned int z, unsigned short maxDelay, unsigned long long seed)
+{
+	if ((x == 0) || (y == 0) || (z == 0))
+		return (fail("torus dimensions must be at least 1"));
+	if (1ULL * x * y * z > MaxDeviceAddresses)
+		return (fail("torus needs more than " + std::to_string(MaxDeviceAddresses) + " Devices"));
+
+	//  Mac 2d links to the next Bridge along dimension d (with wrap around) and Mac 2d + 1 to the previous one.
+	//     Dimensions of length 1 have no Macs;  a dimension of length 2 has two links between each pair.
+	SplitMix64 rng(seed);
+	unsigned int dims[3] = { x, y, z };
+	int macIndex[3];
+	int macs = 0;
+	for (int d = 0; d < 3; d++)
+	{
+		macIndex[d] = macs;
+		if (dims[d] > 1)
+			macs += 2;
+	}
+
+	size_t first = Devices.size();
+	for (unsigned int k = 0; k < z; k++)
+		for (unsigned int j = 0; j < y; j++)
+			for (unsigned int i = 0; i < x; i++)
+				addBridge("t" + std::to_string(i) + "_" + std::to_string(j) + "_" + std::to_string(k), std::max(macs, 1));
+
+	for (unsigned int k = 0; k < z; k++)
+		for (unsigned int j = 0; j < y; j++)
+			for (unsigned int i = 0; i < x; i++)
+			{
+				unsigned int pos[3] = { i, j, k };
+				size_t dev = first + i + (x * (j + (y * k)));
+				for (int d = 0; d < 3; d++)
+				{
+					if (dims[d] == 1)
+						continue;
+					unsigned int next[3] = { i, j, k };
+					next[d] = (pos[d] + 1) % dims[d];
+					size_t nextDev = first + next[0] + (x * (next[1] + (y * next[2])));
+					addLink(dev, macIndex[d], nextDev, macIndex[d] + 1, drawDelay(rng, maxDelay));
+				}
+			}
+	return (true);
+}
+
+bool Topology::generateRing(unsigned int n, unsigned short maxDelay, unsigned long long seed)
+{
+	if (n < 2)
+		return (fail("ring needs at least 2 Bridges"));
+
+	SplitMix64 rng(seed);
+	size_t first = Devices.size();
+	for (unsigned int i = 0; i < n; i++)
+		addBridge("r" + std::to_string(i), 2);
+	for (unsigned int i = 0; i < n; i++)
+		addLink(first + i, 0, first + ((i + 1) % n), 1, drawDelay(rng, maxDelay));
+	return (true);
+}
+
+bool Topology::generateStar(unsigned int n, unsigned short maxDelay, unsigned long long seed)
+{
+	if ((n == 0) || (n > MaxMacs))
+		return (fail("star needs from 1 to " + std::to_string(MaxMacs) + " leaves"));
+
+	SplitMix64 rng(seed);
+	size_t hub = addBridge("hub", n);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		size_t leaf = addBridge("leaf" + std::to_string(i), 1);
+		addLink(hub, i, leaf, 0, drawDelay(rng, maxDelay));
+	}
+	return (true);
+}
+
+bool Topology::generateRandom(unsigned int n, double p, unsigned short maxDelay, unsigned long long seed)
+{
+	if ((n == 0) || (p < 0.0) || (p > 1.0))
+		return (fail("random graph needs n of at least 1 and p from 0 to 1"));
+
+	//  Draw the links first (so each Bridge can be built with a Mac per link), visiting only the pairs that are linked:
+	//     the gap to the next linked pair is geometric (Batagelj and Brandes), so the cost is proportional to n plus
+	//     the number of links rather than to n squared.
+	SplitMix64 rng(seed);
+	std::vector<std::pair<unsigned int, unsigned int>> links;
+	std::vector<int> degree(n, 0);
+	if (p > 0.0)
+	{
+		double logOneMinusP = (p < 1.0) ? std::log(1.0 - p) : 0.0;
+		long long v = 1;
+		long long w = -1;
+		while (v < n)
+		{
+			double r = rng.nextDouble();
+			w += 1 + ((p < 1.0) ? (long long)std::floor(std::log(1.0 - r) / logOneMinusP) : 0);
+			while ((w >= v) && (v < n))
+			{
+				w -= v;
+				v++;
+			}
+			if (v < n)
+			{
+				if ((degree[v] == MaxMacs) || (degree[w] == MaxMacs))
+					return (fail("random graph has a Bridge with more than " + std::to_string(MaxMacs) + " links"));
+				links.push_back(std::make_pair((unsigned int)w, (unsigned int)v));
+				degree[v]++;
+				degree[w]++;
+			}
+		}
+	}
+
+	size_t first = Devices.size();
+	for (unsigned int i = 0; i < n; i++)
+		addBridge("n" + std::to_string(i), std::max(degree[i], 1));
+
+	std::vector<int> nextMac(n, 0);
+	for (auto& link : links)
+		addLink(first + link.first, nextMac[link.first]++, first + link.second, nextMac[link.second]++, drawDelay(rng, maxDelay));
+	return (true);
+}
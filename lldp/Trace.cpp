@@ -0,0 +1,206 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include <cstring>
+#include "Trace.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+static HANDLE fileHandle = INVALID_HANDLE_VALUE;
+static HANDLE mappingHandle = NULL;
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+static int fileHandle = -1;
+#endif
+
+static char* pMapped = nullptr;               // Start of the mapped file (the header)
+static size_t mappedSize = 0;
+
+
+std::atomic<bool> Trace::active(false);
+thread_local Trace::ThreadBuffer* Trace::pThreadBuffer = nullptr;
+std::mutex Trace::buffersLock;
+std::vector<Trace::ThreadBuffer*> Trace::buffers;
+TraceRecord* Trace::pFileRecords = nullptr;
+size_t Trace::fileCapacity = 0;
+std::atomic<size_t> Trace::fileCount(0);
+std::atomic<unsigned long long> Trace::dropped(0);
+unsigned long long Trace::lastRecordCount = 0;
+unsigned long long Trace::lastDroppedCount = 0;
+
+
+bool Trace::open(const std::string& fileName, size_t maxRecords)
+{
+	if (active)
+		close();
+
+	if (!mapFile(fileName, sizeof(TraceFileHeader) + (maxRecords * sizeof(TraceRecord))))
+		return (false);
+
+	pFileRecords = reinterpret_cast<TraceRecord*>(pMapped + sizeof(TraceFileHeader));
+	fileCapacity = maxRecords;
+	fileCount = 0;
+	dropped = 0;
+	{
+		std::lock_guard<std::mutex> guard(buffersLock);
+		for (auto pBuffer : buffers)
+			pBuffer->count = 0;
+	}
+	active = true;
+	return (true);
+}
+
+void Trace::close()
+{
+	if (!active)
+		return;
+	active = false;
+
+	{
+		std::lock_guard<std::mutex> guard(buffersLock);
+		for (auto pBuffer : buffers)
+			if (pBuffer->count > 0)
+				flushBuffer(*pBuffer);
+	}
+
+	size_t count = std::min(fileCount.load(), fileCapacity);
+	TraceFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, TraceMagic, sizeof(header.magic));
+	header.version = TraceVersion;
+	header.recordSize = sizeof(TraceRecord);
+	header.recordCount = count;
+	header.droppedCount = dropped;
+	memcpy(pMapped, &header, sizeof(header));
+
+	lastRecordCount = count;
+	lastDroppedCount = dropped;
+	pFileRecords = nullptr;
+	fileCapacity = 0;
+	unmapFile(sizeof(TraceFileHeader) + (count * sizeof(TraceRecord)));
+}
+
+unsigned long long Trace::getRecordCount()
+{
+	return (active ? std::min(fileCount.load(), fileCapacity) : lastRecordCount);
+}
+
+unsigned long long Trace::getDroppedCount()
+{
+	return (active ? dropped.load() : lastDroppedCount);
+}
+
+Trace::ThreadBuffer* Trace::attachThread()
+{
+	pThreadBuffer = new ThreadBuffer;
+	pThreadBuffer->count = 0;
+	std::lock_guard<std::mutex> guard(buffersLock);
+	buffers.push_back(pThreadBuffer);
+	return (pThreadBuffer);
+}
+
+void Trace::flushBuffer(ThreadBuffer& buffer)
+{
+	size_t count = buffer.count;
+	size_t first = fileCount.fetch_add(count, std::memory_order_relaxed);    // Reserve space for the whole buffer
+	size_t fits = (first < fileCapacity) ? std::min(count, fileCapacity - first) : 0;
+
+	if (fits > 0)
+		memcpy(pFileRecords + first, buffer.records, fits * sizeof(TraceRecord));
+	if (fits < count)
+		dropped.fetch_add(count - fits, std::memory_order_relaxed);
+	buffer.count = 0;
+}
+
+
+#ifdef _WIN32
+
+bool Trace::mapFile(const std::string& fileName, size_t size)
+{
+	fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return (false);
+
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)size >> 32), (DWORD)size, NULL);
+	if (mappingHandle != NULL)
+		pMapped = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, size));
+	if (pMapped == nullptr)
+	{
+		if (mappingHandle != NULL)
+			CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		mappingHandle = NULL;
+		fileHandle = INVALID_HANDLE_VALUE;
+		return (false);
+	}
+	mappedSize = size;
+	return (true);
+}
+
+void Trace::unmapFile(size_t usedSize)
+{
+	UnmapViewOfFile(pMapped);
+	CloseHandle(mappingHandle);
+	LARGE_INTEGER end;
+	end.QuadPart = (LONGLONG)usedSize;
+	SetFilePointerEx(fileHandle, end, NULL, FILE_BEGIN);      // Trim the unused capacity
+	SetEndOfFile(fileHandle);
+	CloseHandle(fileHandle);
+	pMapped = nullptr;
+	mappedSize = 0;
+	mappingHandle = NULL;
+	fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool Trace::mapFile(const std::string& fileName, size_t size)
+{
+	fileHandle = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fileHandle < 0)
+		return (false);
+
+	void* pMem = MAP_FAILED;
+	if (ftruncate(fileHandle, (off_t)size) == 0)
+		pMem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileHandle, 0);
+	if (pMem == MAP_FAILED)
+	{
+		::close(fileHandle);
+		fileHandle = -1;
+		return (false);
+	}
+	pMapped = static_cast<char*>(pMem);
+	mappedSize = size;
+	return (true);
+}
+
+void Trace::unmapFile(size_t usedSize)
+{
+	munmap(pMapped, mappedSize);
+	if (ftruncate(fileHandle, (off_t)usedSize) != 0)          // Trim the unused capacity
+		SimLog::logFile << "Trace:  could not trim trace file" << endl;
+	::close(fileHandle);
+	pMapped = nullptr;
+	mappedSize = 0;
+	fileHandle = -1;
+}
+
+#endif
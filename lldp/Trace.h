@@ -0,0 +1,101 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "TraceFormat.h"
+
+/*
+*   Class Trace records simulation events as fixed size binary TraceRecords, for decoding after the run with the
+*      tracedecode tool (to text or to Chrome trace event JSON).  This is much cheaper than formatting the same
+*      events into the log file.
+*   Each thread writes records into its own buffer with no locking.  When a buffer fills, the thread reserves space
+*      for the whole buffer in the trace file with a single atomic add and copies the records into the file, which is
+*      memory mapped, so the cost of a record is a few stores plus an occasional block copy.  The buffer then wraps.
+*   The trace file has a fixed capacity set by open();  records beyond it are counted as dropped.
+*   open() and close() must be called when no other thread is recording (e.g. before and after the simulation runs).
+*      close() flushes the buffers of every thread that recorded anything, writes the header, and truncates the
+*      file to the records written.
+*   Recording is off until open() succeeds, and costs one relaxed load per event while off.
+*/
+
+class Trace
+{
+public:
+	static bool open(const std::string& fileName, size_t maxRecords = 1 << 22);
+	static void close();
+	static bool isActive();
+	static unsigned long long getRecordCount();
+	static unsigned long long getDroppedCount();
+
+	static void record(uint16_t event, uint64_t device, uint16_t port, uint64_t arg0, uint32_t arg1, uint32_t arg2);
+
+	static const size_t BufferRecords = 1024;     // Records per thread buffer
+
+private:
+	struct ThreadBuffer
+	{
+		TraceRecord records[BufferRecords];
+		size_t count;
+	};
+
+	static std::atomic<bool> active;
+	static thread_local ThreadBuffer* pThreadBuffer;
+	static std::mutex buffersLock;
+	static std::vector<ThreadBuffer*> buffers;        // Every thread's buffer;  never freed since threads come and go
+
+	static TraceRecord* pFileRecords;                  // Records area of the mapped file
+	static size_t fileCapacity;                        // Records that fit in the mapped file
+	static std::atomic<size_t> fileCount;              // Records reserved in the file (may exceed fileCapacity)
+	static std::atomic<unsigned long long> dropped;
+	static unsigned long long lastRecordCount;         // Results of the last close()
+	static unsigned long long lastDroppedCount;
+
+	static ThreadBuffer* attachThread();
+	static void flushBuffer(ThreadBuffer& buffer);
+	static bool mapFile(const std::string& fileName, size_t size);
+	static void unmapFile(size_t usedSize);
+};
+
+
+inline bool Trace::isActive()
+{
+	return (active.load(std::memory_order_relaxed));
+}
+
+inline void Trace::record(uint16_t event, uint64_t device, uint16_t port, uint64_t arg0, uint32_t arg1, uint32_t arg2)
+{
+	if (!isActive())
+		return;
+
+	ThreadBuffer* pBuffer = pThreadBuffer;
+	if (pBuffer == nullptr)
+		pBuffer = attachThread();
+
+	TraceRecord& rec = pBuffer->records[pBuffer->count];
+	rec.time = SimLog::Time;
+	rec.event = event;
+	rec.port = port;
+	rec.device = device;
+	rec.arg0 = arg0;
+	rec.arg1 = arg1;
+	rec.arg2 = arg2;
+	if (++pBuffer->count == BufferRecords)
+		flushBuffer(*pBuffer);
+}
@@ -0,0 +1,94 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <cstdint>
+
+/*
+*   Layout of a binary trace file written by class Trace, shared with the tracedecode tool.
+*   The file is a TraceFileHeader followed by recordCount TraceRecords.  Records are written in blocks, one block
+*      per thread buffer flush, so records are in time order within a thread but blocks from different threads can
+*      be interleaved;  the decoder sorts them by time.
+*   Every record has the same size.  What arg0, arg1, and arg2 hold depends on the event:
+*      LLDP state machine events:   device = chassis ID, port = port ID, arg1 = old state, arg2 = new state
+*      TRACE_MAC_TRANSMIT:          device = MAC address, port = SAP ID, arg0 = destination address,
+*                                   arg1 = Ethertype of the frame, arg2 = 1 if delivered to the link partner
+*/
+
+const char TraceMagic[8] = { 'L', 'L', 'D', 'P', 'T', 'R', 'C', '1' };
+const uint32_t TraceVersion = 1;
+
+enum TraceEvents : uint16_t { TRACE_NONE, TRACE_LLDP_RX_STATE, TRACE_LLDP_TX_STATE, TRACE_LLDP_TX_TIMER_STATE,
+	TRACE_MAC_TRANSMIT, TRACE_EVENT_COUNT };
+
+struct TraceRecord
+{
+	int32_t time;                   // SimLog::Time
+	uint16_t event;                 // TraceEvents
+	uint16_t port;
+	uint64_t device;
+	uint64_t arg0;
+	uint32_t arg1;
+	uint32_t arg2;
+};
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord must be 32 octets");
+
+struct TraceFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t recordSize;
+	uint64_t recordCount;           // Records in the file
+	uint64_t droppedCount;          // Records lost because the file was full
+	char reserved[32];
+};
+static_assert(sizeof(TraceFileHeader) == 64, "TraceFileHeader must be 64 octets");
+
+
+/*
+*   Names for the decoder.  The state names must match the state enumerations in LldpPort.h.
+*/
+
+inline const char* traceEventName(uint16_t event)
+{
+	static const char* names[TRACE_EVENT_COUNT] = { "none", "LLDP RxSM", "LLDP TxSM", "LLDP TxTimerSM", "MAC transmit" };
+	return ((event < TRACE_EVENT_COUNT) ? names[event] : "unknown");
+}
+
+inline const char* traceStateName(uint16_t event, uint32_t state)
+{
+	static const char* rxStates[] = { "NO_STATE", "WAIT_OPERATIONAL", "RX_INITIALIZE", "DELETE_AGED_INFO", "RX_WAIT_FRAME",
+		"RX_FRAME", "RX_EXTENDED", "DELETE_INFO", "UPDATE_INFO", "REMOTE_CHANGES", "RX_XPDU_REQUEST" };
+	static const char* txStates[] = { "NO_STATE", "TX_LLDP_INITIALIZE", "TX_IDLE", "TX_SHUTDOWN_FRAME", "TX_INFO_FRAME" };
+	static const char* txTimerStates[] = { "NO_STATE", "TX_TIMER_INITIALIZE", "TX_TIMER_IDLE", "TX_TIMER_EXPIRES",
+		"TX_FAST_START", "SIGNAL_TX" };
+
+	switch (event)
+	{
+	case TRACE_LLDP_RX_STATE:
+		if (state < sizeof(rxStates) / sizeof(rxStates[0])) return (rxStates[state]);
+		break;
+	case TRACE_LLDP_TX_STATE:
+		if (state < sizeof(txStates) / sizeof(txStates[0])) return (txStates[state]);
+		break;
+	case TRACE_LLDP_TX_TIMER_STATE:
+		if (state < sizeof(txTimerStates) / sizeof(txTimerStates[0])) return (txTimerStates[state]);
+		break;
+	default:
+		break;
+	}
+	return ("unknown");
+}
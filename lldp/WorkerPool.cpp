@@ -0,0 +1,116 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "WorkerPool.h"
+
+
+WorkerPool::WorkerPool(unsigned int threads)
+{
+	pTask = nullptr;
+	taskCount = 0;
+	chunkSize = 1;
+	nextIndex = 0;
+	generation = 0;
+	busyWorkers = 0;
+	shutdown = false;
+
+	for (unsigned int i = 1; i < threads; i++)      // Calling thread is the first thread in the pool
+		workers.push_back(std::thread(&WorkerPool::workerLoop, this));
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		shutdown = true;
+	}
+	startWork.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+unsigned int WorkerPool::getThreadCount() const
+{
+	return ((unsigned int)workers.size() + 1);
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+	if (count == 0)
+		return;
+
+	if (workers.empty() || (count == 1))           // Not worth waking anyone
+	{
+		for (size_t i = 0; i < count; i++)
+			task(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		pTask = &task;
+		taskCount = count;
+		chunkSize = std::max((size_t)1, count / (8 * getThreadCount()));   // Several chunks per thread to balance load
+		nextIndex = 0;
+		busyWorkers = (unsigned int)workers.size();
+		generation++;
+	}
+	startWork.notify_all();
+
+	runChunks();
+
+	std::unique_lock<std::mutex> guard(lock);
+	workDone.wait(guard, [this] { return (busyWorkers == 0); });
+	pTask = nullptr;
+}
+
+void WorkerPool::runChunks()
+{
+	while (true)
+	{
+		size_t first = nextIndex.fetch_add(chunkSize);
+		if (first >= taskCount)
+			break;
+		size_t last = std::min(first + chunkSize, taskCount);
+		for (size_t i = first; i < last; i++)
+			(*pTask)(i);
+	}
+}
+
+void WorkerPool::workerLoop()
+{
+	unsigned long long seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			startWork.wait(guard, [this, seenGeneration] { return (shutdown || (generation != seenGeneration)); });
+			if (shutdown)
+				return;
+			seenGeneration = generation;
+		}
+
+		runChunks();
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			busyWorkers--;
+		}
+		workDone.notify_one();
+	}
+}
@@ -0,0 +1,59 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+*   Class WorkerPool is a fixed set of threads that execute a task for each index in a range.
+*   parallelFor() hands the range out in small chunks from a shared counter, so threads that finish early take
+*      work from the rest of the range, and returns only when every index has been processed (i.e. it is a barrier).
+*      The calling thread takes part in the work, so a pool of N threads has N-1 worker threads.
+*   The task must not depend on which thread runs an index or in what order indices are run.
+*/
+
+class WorkerPool
+{
+public:
+	WorkerPool(unsigned int threads);
+	~WorkerPool();
+	WorkerPool(WorkerPool& copySource) = delete;             // Disable copy constructor
+	WorkerPool& operator= (const WorkerPool&) = delete;      // Disable assignment operator
+
+	void parallelFor(size_t count, const std::function<void(size_t)>& task);
+	unsigned int getThreadCount() const;
+
+private:
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable startWork;
+	std::condition_variable workDone;
+	const std::function<void(size_t)>* pTask;
+	size_t taskCount;
+	size_t chunkSize;
+	std::atomic<size_t> nextIndex;
+	unsigned long long generation;       // Incremented for each parallelFor so workers know there is new work
+	unsigned int busyWorkers;
+	bool shutdown;
+
+	void workerLoop();
+	void runChunks();
+};
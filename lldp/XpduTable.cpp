@@ -0,0 +1,139 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+#include <stdexcept>
+#include "Crc32c.h"
+#include "XpduTable.h"
+
+
+xpduMapEntry::xpduMapEntry()
+{
+	sizeXpduTlvs = 0;
+	status = RxXpduStatus::CURRENT;
+	requestTime = -1;
+	deadline = -1;
+	tlvsDigest = hashBytes(nullptr, 0);
+	tlvsLength = 0;
+}
+
+xpduMapEntry::~xpduMapEntry()
+{}
+
+unsigned long xpduMapEntry::computeCheck() const
+{
+	unsigned long check = 0;
+	for (auto& pTlv : pTlvs)
+	{
+		TlvView tlv = pTlv->view();
+		check = Crc32c::compute(tlv.data(), tlv.size(), check);
+	}
+	return (check);
+}
+
+unsigned long long hashTlvs(const std::vector<TlvView>& tlvs, size_t first, unsigned long& length)
+{
+	length = 0;
+	if (first >= tlvs.size())
+		return (hashBytes(nullptr, 0));
+	const unsigned char* pStart = tlvs[first].data();
+	length = (unsigned long)((tlvs.back().data() + tlvs.back().size()) - pStart);
+	return (hashBytes(pStart, length));
+}
+
+unsigned long computeXpduCheck(const std::vector<TlvView>& tlvs, size_t first)
+{
+	unsigned long check = 0;
+	for (size_t i = first; i < tlvs.size(); i++)
+		check = Crc32c::compute(tlvs[i].data(), tlvs[i].size(), check);
+	return (check);
+}
+
+
+XpduTable::XpduTable()
+{
+	for (int i = 0; i < 4; i++)
+		present[i] = 0;
+}
+
+bool XpduTable::contains(unsigned char num) const
+{
+	return ((present[num >> 6] >> (num & 0x3f)) & 1);
+}
+
+XpduTable::iterator XpduTable::find(unsigned char num)
+{
+	if (!contains(num))
+		return (entries.end());
+	return (entries.begin() + position[num]);
+}
+
+XpduTable::const_iterator XpduTable::find(unsigned char num) const
+{
+	if (!contains(num))
+		return (entries.end());
+	return (entries.begin() + position[num]);
+}
+
+xpduMapEntry& XpduTable::at(unsigned char num)
+{
+	if (!contains(num))
+		throw std::out_of_range("XpduTable::at");
+	return (entries[position[num]].second);
+}
+
+const xpduMapEntry& XpduTable::at(unsigned char num) const
+{
+	if (!contains(num))
+		throw std::out_of_range("XpduTable::at");
+	return (entries[position[num]].second);
+}
+
+bool XpduTable::insert(const value_type& entry)
+{
+	unsigned char num = entry.first;
+	if (contains(num))
+		return (false);
+
+	present[num >> 6] |= (1ULL << (num & 0x3f));
+	if (entries.empty() || (entries.back().first < num))           // Appending in order
+	{
+		position[num] = (unsigned char)entries.size();
+		entries.push_back(entry);
+	}
+	else
+	{
+		auto it = std::lower_bound(entries.begin(), entries.end(), num,
+			[](const value_type& e, unsigned char n) { return (e.first < n); });
+		it = entries.insert(it, entry);
+		for (size_t i = it - entries.begin(); i < entries.size(); i++)   // Entries after the new one have moved
+			position[entries[i].first] = (unsigned char)i;
+	}
+	return (true);
+}
+
+void XpduTable::clear()
+{
+	entries.clear();                                                // Keeps capacity for reuse
+	for (int i = 0; i < 4; i++)
+		present[i] = 0;
+}
+
+void XpduTable::reserve(size_t count)
+{
+	entries.reserve(count);
+}
@@ -0,0 +1,92 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <vector>
+#include "Lldpdu.h"
+
+using namespace std;
+
+
+enum RxXpduStatus { CURRENT, NEW, UPDATE, REQUESTED, RETRIED };
+
+class xpduMapEntry
+{
+public:
+	xpduMapEntry();
+	~xpduMapEntry();
+
+	unsigned long computeCheck() const;   // CRC-32C of the encoded TLVs, for xpduDesc.check
+
+	xpduDescriptor xpduDesc;
+	unsigned long sizeXpduTlvs;
+	RxXpduStatus status;
+	int requestTime;                  // SimLog::Time XPDU was first requested for this manifest (-1 if not requested)
+	int deadline;                     // SimLog::Time by which a REQUESTED or RETRIED XPDU should have arrived
+	vector<shared_ptr<TLV>> pTlvs;
+	unsigned long long tlvsDigest;    // hashTlvs() of pTlvs as received (neighbor XPDU 0 only)
+	unsigned long tlvsLength;         // Octets in pTlvs (neighbor XPDU 0 only)
+};
+
+unsigned long computeXpduCheck(const std::vector<TlvView>& tlvs, size_t first);  // Of tlvs[first] onwards
+
+/*
+*   hashTlvs() hashes tlvs[first] onwards in one pass, and returns the number of octets hashed in length.
+*      The views must be of consecutive TLVs in one buffer, as produced by Lldpdu::decode().
+*/
+unsigned long long hashTlvs(const std::vector<TlvView>& tlvs, size_t first, unsigned long& length);
+
+/*
+*   Class XpduTable holds the xpduMapEntry for each XPDU number (0 - 255) of a local or neighbor MIB.
+*   The entries are kept in a vector in ascending XPDU number order, so walking the table (e.g. to build a manifest
+*      or to find XPDUs to request) reads contiguous memory.  A presence bitmap and a 256 octet index from XPDU number
+*      to position in the vector make find() O(1).
+*   The interface is the subset of std::map<unsigned char, xpduMapEntry> used by LLDP, so iterators point to a pair
+*      of XPDU number (first) and xpduMapEntry (second).  The XPDU number of an entry must not be changed.
+*   Inserting in ascending XPDU number order (the usual case) appends;  inserting out of order shifts later entries.
+*   MIB entries hold tables through shared_ptr, and a table that is shared is never changed (copy on write).
+*/
+
+class XpduTable
+{
+public:
+	typedef std::pair<unsigned char, xpduMapEntry> value_type;
+	typedef std::vector<value_type>::iterator iterator;
+	typedef std::vector<value_type>::const_iterator const_iterator;
+
+	XpduTable();
+
+	iterator begin() { return (entries.begin()); }
+	iterator end() { return (entries.end()); }
+	const_iterator begin() const { return (entries.begin()); }
+	const_iterator end() const { return (entries.end()); }
+	size_t size() const { return (entries.size()); }
+	bool empty() const { return (entries.empty()); }
+
+	bool contains(unsigned char num) const;
+	iterator find(unsigned char num);                   // end() if not present
+	const_iterator find(unsigned char num) const;
+	xpduMapEntry& at(unsigned char num);                // Throws out_of_range if not present (as std::map)
+	const xpduMapEntry& at(unsigned char num) const;
+	bool insert(const value_type& entry);               // False (and no change) if XPDU number already present
+	void clear();
+	void reserve(size_t count);
+
+private:
+	std::vector<value_type> entries;                    // In ascending XPDU number order
+	unsigned char position[256];                        // Index in entries, for XPDU numbers that are present
+	unsigned long long present[4];                      // Bit per XPDU number
+};
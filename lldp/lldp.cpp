@@ -16,17 +16,22 @@ limitations under the License.
 //
 
 #include <iostream>
+#include <chrono>
 
 #include "stdafx.h"
 #include "Device.h"
 #include "Mac.h"
 #include "Frame.h"
 #include "LinkLayerDiscovery.h"
+#include "EventScheduler.h"
+#include "Benchmark.h"
+#include "Trace.h"
+#include "Topology.h"
 
 using namespace std;
 
 
-int main()
+int main(int argc, char* argv[])
 {
     std::cout << "Hello World!\n";
 	SimLog::logFile << endl;
@@ -38,7 +43,54 @@ int main()
 	SimLog::logFile << "Testing a negative result to unsigned short arithmetic:  5 - 3 = " << testUint << endl;
 
 //	void send8Frames(EndStn& source);
-	void basicLldpTest(std::vector<unique_ptr<Device>> & Devices);
+	void basicLldpTest(std::vector<unique_ptr<Device>> & Devices, unsigned int threads, const ImpairmentProfile* pImpair,
+		unsigned long long impairSeed);
+	void topologyTest(std::vector<unique_ptr<Device>> & Devices, Topology & topology, unsigned int threads);
+
+	unsigned int threads = 1;                         // "-threads N" runs Devices on N threads
+	bool bench = false;                               // "-bench" runs the benchmarks instead of the simulation
+	std::string traceFile;                            // "-trace FILE" records a binary event trace (see tracedecode)
+	ImpairmentProfile impair;                         // "-impair SPEC" impairs every link (see parseImpairmentProfile)
+	unsigned long long impairSeed = 1;
+	bool impaired = false;
+	std::string topologyFile;                         // "-topology FILE" builds and runs the network in FILE (see Topology)
+	std::string scenario;                             // "-scenario SPEC|all" runs generated networks (see Benchmark)
+	for (int arg = 1; arg < argc; arg++)
+	{
+		if ((std::string(argv[arg]) == "-threads") && (arg + 1 < argc))
+			threads = std::max(1, atoi(argv[++arg]));
+		else if (std::string(argv[arg]) == "-nopool")      // "-nopool" allocates Frames and Sdus from the heap
+			FramePool::setEnabled(false);
+		else if (std::string(argv[arg]) == "-bench")
+			bench = true;
+		else if ((std::string(argv[arg]) == "-trace") && (arg + 1 < argc))
+			traceFile = argv[++arg];
+		else if ((std::string(argv[arg]) == "-impair") && (arg + 1 < argc))
+		{
+			impaired = parseImpairmentProfile(argv[++arg], impair, impairSeed);
+			if (!impaired)
+				cout << "   Could not parse impairment profile " << argv[arg] << endl;
+		}
+		else if ((std::string(argv[arg]) == "-topology") && (arg + 1 < argc))
+			topologyFile = argv[++arg];
+		else if ((std::string(argv[arg]) == "-scenario") && (arg + 1 < argc))
+			scenario = argv[++arg];
+		else if ((std::string(argv[arg]) == "-debug") && (arg + 1 < argc))   // "-debug N" sets SimLog::Debug
+			SimLog::Debug = atoi(argv[++arg]);
+	}
+
+	if (bench)
+	{
+		Benchmark::run();
+		return 0;
+	}
+	if (scenario == "all")
+	{
+		Benchmark::scenarios(threads);
+		return 0;
+	}
+	if (!scenario.empty())
+		return (Benchmark::scenario(scenario, threads) ? 0 : 1);
 
 
 	//
@@ -56,30 +108,46 @@ int main()
 	if (SimLog::Debug > 0)
 		SimLog::logFile << "   Building Devices:  " << endl << endl;
 
-//	for (int dev = 0; dev < brgCnt + endStnCnt; dev++)
-	for (int dev = 0; dev < brgCnt; dev++)              // Just build bridges
-		{
-		unique_ptr<Device> thisDev = nullptr;
-		if (dev < brgCnt)  // Build Bridges first
+	Topology topology(Devices);                       // Devices built from topologyFile, if given
+	if (!topologyFile.empty())
+	{
+		std::chrono::steady_clock::time_point buildStart = std::chrono::steady_clock::now();
+		if (!topology.load(topologyFile))
 		{
-			thisDev = make_unique<Device>(brgMacCnt);     // Make a device with brgMacCnt MACs
-		//	thisDev->createBridge(CVlanEthertype);        // Add a C-VLAN bridge component with a bridge port for each MAC
-		//TODO:  This kludge gives each bridge a unique name
-			switch (dev)
+			cout << "   Could not load topology " << topology.getError() << endl;
+			return 1;
+		}
+		double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
+		cout << "   Built " << topology.getDeviceCount() << " Devices with " << topology.getLinkCount() << " links and "
+			<< topology.getEventCount() << " events in " << buildSeconds << " seconds" << endl;
+	}
+	else
+	{
+//	for (int dev = 0; dev < brgCnt + endStnCnt; dev++)
+		for (int dev = 0; dev < brgCnt; dev++)              // Just build bridges
+			{
+			unique_ptr<Device> thisDev = nullptr;
+			if (dev < brgCnt)  // Build Bridges first
 			{
-			case 0: thisDev->createBridge(CVlanEthertype, "Larry", "is in New York"); break;
-			case 1: thisDev->createBridge(CVlanEthertype, "Curly", "is in Boston"); break; 
-			case 2: thisDev->createBridge(CVlanEthertype, "  Moe", "is in Denver"); break;
-			default: thisDev->createBridge(CVlanEthertype, "Anonymous", "is not to be found"); break;
+				thisDev = make_unique<Device>(brgMacCnt);     // Make a device with brgMacCnt MACs
+			//	thisDev->createBridge(CVlanEthertype);        // Add a C-VLAN bridge component with a bridge port for each MAC
+			//TODO:  This kludge gives each bridge a unique name
+				switch (dev)
+				{
+				case 0: thisDev->createBridge(CVlanEthertype, "Larry", "is in New York"); break;
+				case 1: thisDev->createBridge(CVlanEthertype, "Curly", "is in Boston"); break; 
+				case 2: thisDev->createBridge(CVlanEthertype, "  Moe", "is in Denver"); break;
+				default: thisDev->createBridge(CVlanEthertype, "Anonymous", "is not to be found"); break;
+				}
 			}
-		}
 //TODO:  End stations are broken
-		else               //    then build End Stations
-		{
-			thisDev = make_unique<Device>(endStnMacCnt);  // Make a device with endStnMacCnt MACs
-			thisDev->createEndStation();                  // Add an end station component
+			else               //    then build End Stations
+			{
+				thisDev = make_unique<Device>(endStnMacCnt);  // Make a device with endStnMacCnt MACs
+				thisDev->createEndStation();                  // Add an end station component
+			}
+			Devices.push_back(move(thisDev));                       // Put Device in vector of Devices
 		}
-		Devices.push_back(move(thisDev));                       // Put Device in vector of Devices
 	}
 
 	//
@@ -95,7 +163,20 @@ int main()
 	//  Select Link Layer Discovery tests to run
 	//
 
-    basicLldpTest(Devices);
+	if (!traceFile.empty() && !Trace::open(traceFile))
+		cout << "   Could not create trace file " << traceFile << endl;
+
+	if (!topologyFile.empty())
+		topologyTest(Devices, topology, threads);
+	else
+		basicLldpTest(Devices, threads, (impaired ? &impair : nullptr), impairSeed);
+
+	if (Trace::isActive())
+	{
+		Trace::close();
+		cout << "   Traced " << Trace::getRecordCount() << " events to " << traceFile
+			<< " (" << Trace::getDroppedCount() << " dropped)" << endl;
+	}
 
 	//
 	// Clean up devices.
@@ -115,7 +196,57 @@ int main()
 }
 
 
-void basicLldpTest(std::vector<unique_ptr<Device>>& Devices)
+void printResults(std::vector<unique_ptr<Device>>& Devices, EventScheduler& sim, int start)
+{
+	if (SimLog::Debug > 0)
+		SimLog::logFile << endl << "   Simulated " << (SimLog::Time - start) << " ticks in " << sim.getStepCount()
+			<< " steps with " << sim.getDeviceRunCount() << " Device runs" << endl;
+	if (SimLog::Debug > 0)
+		SimLog::logFile << "   Frames live " << FramePool::getLiveFrames() << ", peak " << FramePool::getPeakFrames()
+			<< (FramePool::getEnabled() ? " (pooled)" : " (heap)") << endl;
+	if (SimLog::Debug > 0)
+		for (auto& pDev : Devices)
+		{
+			for (auto& pComp : pDev->pComponents)
+			{
+				if (pComp->getCompType() != ComponentTypes::LINK_LAYER_DISCOVERY)   // End Stations have no LLDP shim
+					continue;
+				LinkLayerDiscovery& LLDP = (LinkLayerDiscovery&)*pComp;
+				SimLog::logFile << "   LLDP chassis " << hex << LLDP.chassisId << dec << " neighbor MIB size "
+					<< LLDP.get_nborMibSize() << ", peak " << LLDP.get_nborMibPeakSize() << endl;
+				LldpStatsSnapshot stats = LLDP.get_stats();
+				SimLog::logFile << "     ";
+				for (int stat = 0; stat < LLDP_STATS_COUNT; stat++)
+					SimLog::logFile << " " << lldpStatisticName((LldpStatistics)stat) << " " << stats.get((LldpStatistics)stat);
+				SimLog::logFile << endl;
+			}
+			for (auto& pMac : pDev->pMacs)
+			{
+				const LinkStats& link = pMac->getLinkStats();
+				if ((link.frames == 0) && (link.drops == 0))
+					continue;
+				SimLog::logFile << "      MAC " << hex << pMac->getDevNum() << ":" << pMac->getSapId() << dec
+					<< " frames " << link.frames << " octets " << link.octets << " drops " << link.drops
+					<< " mean latency " << ((double)link.latency / std::max(link.frames, 1ULL))
+					<< " peak queue " << link.peakQueueDepth;
+				if (pMac->getLinkBandwidth() != 0)
+					SimLog::logFile << " utilization " << (100.0 * pMac->getLinkUtilization()) << "%";
+				SimLog::logFile << endl;
+				if (const LinkImpairments* pImpairments = pMac->getImpairments())
+				{
+					SimLog::logFile << "       ";
+					for (int count = 0; count < IMPAIR_COUNT; count++)
+						SimLog::logFile << " " << impairmentCountName((ImpairmentCounts)count) << " "
+							<< pImpairments->get((ImpairmentCounts)count);
+					SimLog::logFile << endl;
+				}
+			}
+		}
+}
+
+
+void basicLldpTest(std::vector<unique_ptr<Device>>& Devices, unsigned int threads, const ImpairmentProfile* pImpair,
+	unsigned long long impairSeed)
 {
 	int start = SimLog::Time;
 
@@ -132,74 +263,87 @@ void basicLldpTest(std::vector<unique_ptr<Device>>& Devices)
 //  LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);  // alias to LinkAgg shim of bridge b00
 //	dev0Lldp.pLldpPorts[0]->set_aAggPortWTRTime(30);                  // temp: set WTR timer on bridge:port b00:100
 
-	for (int i = 0; i < 1000; i++)
-	{
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-
-		//  Make or break connections
+	EventScheduler sim(Devices);                                       // Runs each Device only when it has something to do
+	sim.setThreads(threads);
 
-		if (SimLog::Time == start + 10)
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);   // Connect two Bridges
-		// Link 1 comes up with AggPort b00:100 on Aggregator b00:200 and AggPort b01:100 on Aggregator b01:200.
-
-		if ((SimLog::Time == start + 33) || (SimLog::Time == start + 35))     // remove neighbor MIB info on dev 0 port 0
-		{
-			LinkLayerDiscovery& LLDP = (LinkLayerDiscovery&)*(Devices[0]->pComponents[1]);  // assumes LLDP shim is component after bridge
-			LLDP.pLldpPorts[0]->test_removeNbor();
-		}
+	//  Make or break connections
 
-		if (SimLog::Time == start + 50)      // set lldpV2Enabled in all ports on all three bridges
+	sim.schedule(start + 10, [&Devices, pImpair, impairSeed]() {
+		Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);   // Connect two Bridges
+		if (pImpair)
 		{
-			for (unsigned int i = 0; i < 3; i++)
-			{
-				LinkLayerDiscovery& LLDP = (LinkLayerDiscovery&)*(Devices[i]->pComponents[1]);  // assumes LLDP shim is component after bridge
-				for (unsigned int j = 0; j < LLDP.pLldpPorts.size(); j++)
-				{
-					LldpPort& port = *LLDP.pLldpPorts[j];
-					port.set_lldpV2Enabled(true);
-					port.test_removeNbor();
-				}
-			}
+			Devices[0]->pMacs[0]->setImpairments(*pImpair, impairSeed);        // Each direction gets its own seed
+			Devices[1]->pMacs[0]->setImpairments(*pImpair, impairSeed + 1);
 		}
-
-		if (SimLog::Time == start + 300)
-			Mac::Disconnect((Devices[0]->pMacs[0]));                           // Take down first link
-		// Link 1 goes down and conversations immediately re-allocated to other links.
-		// AggPorts b00:102 and b00:103 remain up on Aggregator b00:200
-
-		if (SimLog::Time == start + 990)
+		});
+	// Link 1 comes up with AggPort b00:100 on Aggregator b00:200 and AggPort b01:100 on Aggregator b01:200.
+
+	auto removeNbor = [&Devices]() {                                  // remove neighbor MIB info on dev 0 port 0
+		LinkLayerDiscovery& LLDP = (LinkLayerDiscovery&)*(Devices[0]->pComponents[1]);  // assumes LLDP shim is component after bridge
+		LLDP.pLldpPorts[0]->test_removeNbor();
+	};
+	sim.schedule(start + 33, removeNbor);
+	sim.schedule(start + 35, removeNbor);
+
+	sim.schedule(start + 50, [&Devices]() {                           // set lldpV2Enabled in all ports on all three bridges
+		for (unsigned int i = 0; i < 3; i++)
 		{
-//			dev0Lag.pAggPorts[0]->set_aAggPortWTRTime(0);                  // temp: restore default WTR timer on bridge:port b00:100
-			for (auto& pDev : Devices)
+			LinkLayerDiscovery& LLDP = (LinkLayerDiscovery&)*(Devices[i]->pComponents[1]);  // assumes LLDP shim is component after bridge
+			for (unsigned int j = 0; j < LLDP.pLldpPorts.size(); j++)
 			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
+				LldpPort& port = *LLDP.pLldpPorts[j];
+				port.set_lldpV2Enabled(true);
+				port.test_removeNbor();
 			}
 		}
+		});
 
+	sim.schedule(start + 300, [&Devices]() {
+		Mac::Disconnect((Devices[0]->pMacs[0]));                       // Take down first link
+		});
+	// Link 1 goes down and conversations immediately re-allocated to other links.
+	// AggPorts b00:102 and b00:103 remain up on Aggregator b00:200
 
-		//  Run all state machines in all devices
+	sim.schedule(start + 990, [&Devices]() {
+//		dev0Lag.pAggPorts[0]->set_aAggPortWTRTime(0);                  // temp: restore default WTR timer on bridge:port b00:100
 		for (auto& pDev : Devices)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);   // Run device with single-step true
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+		});
 
-		//  Transmit from any MAC with frames to transmit
-		if ((SimLog::Debug > 0)  && (SimLog::Time < 0))
-			SimLog::logFile << endl <<  "   About to transmit from MACs  " << endl;
+	//  Run all state machines in all devices, and transmit from any MAC with frames to transmit, whenever
+	//     something is scheduled to happen.
+	sim.run(start + 1000);
 
-		for (auto& pDev : Devices)
-		{
-			pDev->transmit();
-		}
+	printResults(Devices, sim, start);
+}
 
-		if ((SimLog::Debug > 0) && (SimLog::Time < 0))
-			SimLog::logFile  << "   Done transmiting from MACs  " << endl;
 
+void topologyTest(std::vector<unique_ptr<Device>>& Devices, Topology& topology, unsigned int threads)
+{
+	int start = SimLog::Time;
 
-		SimLog::Time++;
+	cout << endl << endl << "   Topology Test:  " << endl << endl;
+	if (SimLog::Debug > 0)
+		SimLog::logFile << endl << endl << "   Topology Test:  " << endl << endl;
+
+	for (auto& pDev : Devices)
+	{
+		pDev->reset();   // Reset all devices
 	}
+
+	EventScheduler sim(Devices);                                       // Runs each Device only when it has something to do
+	sim.setThreads(threads);
+	topology.schedule(sim, start);                                     // Links and timed events from the topology file
+
+	std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now();
+	sim.run(start + topology.get_endTime());
+	double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+	cout << "   Simulated " << (SimLog::Time - start) << " ticks in " << runSeconds << " seconds ("
+		<< sim.getStepCount() << " steps, " << sim.getDeviceRunCount() << " Device runs)" << endl;
+	printResults(Devices, sim, start);
 }
 
 // Run program: Ctrl + F5 or Debug > Start Without Debugging menu
@@ -16,7 +16,9 @@ SimLog::~SimLog()
 // SimLog;  // init globals: Time and logfile
 int SimLog::Time = 0;
 int SimLog::Debug = 0;
-std::ofstream SimLog::logFile("LLDP output.txt");
+std::ofstream SimLog::logSink("LLDP output.txt");
+AsyncLogBuf SimLog::logBuffer(SimLog::logSink.rdbuf());
+thread_local std::ostream SimLog::logFile(&SimLog::logBuffer);
 
 
 // TODO: reference any additional headers you need in STDAFX.H
@@ -23,6 +23,8 @@
 #include <bitset>
 #include <map>
 #include <string>
+#include <algorithm>
+#include "AsyncLogBuf.h"
 
 
 using std::cout;
@@ -39,7 +41,10 @@ using std::move;
 /*
 *   Class SimLog contains static variables to have global scope in the simulation:
 *      -- Time:  Each time increment is one single-step of the simulation.  No direct correlation to any unit of real time.
-*      -- logFile:  a text file for messages regarding events in the simulation.
+*      -- logFile:  stream for messages regarding events in the simulation.  Normally writes to logBuffer, which
+*            writes to logSink, the text file, in the background.  Each thread has its own logFile so a thread running
+*            a Device can redirect its messages to a buffer (see EventScheduler) without affecting any other thread.
+*      -- Debug:  run time verbosity.  Messages of a level greater than Debug are not logged.
 */
 /**/
 class SimLog
@@ -49,17 +54,51 @@ public:
 	~SimLog();
 
 	static int Time;
-	static std::ofstream logFile;
+	static std::ofstream logSink;
+	static AsyncLogBuf logBuffer;
+	static thread_local std::ostream logFile;
 	static int Debug;
 };
 /**/
 
+/*
+*   Log messages are written with SIM_LOG(level, category) << ... << endl;  or, for a message built in several
+*      statements, inside  if (SIM_LOG_ENABLED(level, category)) { ... }.
+*   A message is logged if its level is at most SimLog::Debug.  Messages with a level above SIMLOG_MAX_LEVEL, or in a
+*      category not in SIMLOG_CATEGORIES, are removed at compile time, including the formatting of their arguments.
+*      By default a release (NDEBUG) build keeps only LOG_RESULT messages.
+*/
+enum SimLogLevels { LOG_RESULT = 1, LOG_EVENT = 5, LOG_DETAIL = 9, LOG_TRACE = 13 };
+enum SimLogCategories { LOG_SIM, LOG_FRAME, LOG_MAC, LOG_LLDP_TX, LOG_LLDP_RX, LOG_LLDP_MIB };
+
+#ifndef SIMLOG_MAX_LEVEL
+#ifdef NDEBUG
+#define SIMLOG_MAX_LEVEL 1
+#else
+#define SIMLOG_MAX_LEVEL 15
+#endif
+#endif
+
+#ifndef SIMLOG_CATEGORIES
+#define SIMLOG_CATEGORIES 0xffffffffu
+#endif
+
+#define SIM_LOG_ENABLED(level, category) \
+	(((level) <= SIMLOG_MAX_LEVEL) && (((SIMLOG_CATEGORIES) >> (category)) & 1u) && ((level) <= SimLog::Debug))
+
+#define SIM_LOG(level, category) \
+	if (!SIM_LOG_ENABLED(level, category)) {} else SimLog::logFile
+
+const int SimTimeNever = 0x7fffffff;    // SimLog::Time value meaning "no event scheduled"
+const size_t CacheLineSize = 64;        // Padding that keeps data written by different threads on separate cache lines
+
 enum adminValues { FORCE_FALSE, FORCE_TRUE, AUTO };
 enum ComponentTypes { DEVICE, MAC, BRIDGE, END_STATION, LINK_AGG, DIST_RELAY, LINK_LAYER_DISCOVERY };
 enum LagAlgorithms { NONE = 0, UNSPECIFIED = 0x0080c200, C_VID, S_VID, I_SID, TE_SID, ECMP_FLOW_HASH };
 
 const unsigned short CVlanEthertype = 0x8100;
 const unsigned short SVlanEthertype = 0x88a8;
+const unsigned short VlanIdCount = 4096;          // VIDs are 12 bits;  0 (priority tag) and 4095 are reserved
 const unsigned short LldpEthertype = 0x88cc;
 const unsigned short SlowProtocolsEthertype = 0x8809;
 const unsigned char LacpduSubType = 0x01;
@@ -92,4 +131,16 @@ const unsigned long long defaultBrdgAddr = 0x24a60b000000;   // OUI for Bridges:
 const unsigned long long defaultEndStnAddr = 0x24a60e000000;   // OUI for End Stations:  top two hex digits after OUI expected to be device number
 const unsigned long long defaultDA = 0x30be00ffffff;   // Local group (multicast) address
 
+const unsigned int MaxDeviceAddresses = 0x100000;   // Device numbers that get distinct addresses (20 bits)
+
+inline unsigned long long deviceAddress(unsigned long long base, unsigned int devNum)   // Mac or system address of a Device
+{
+	//  The low 8 bits of the device number go in the two hex digits after the device type, as they always have.
+	//     The next 4 bits go in the (zero) upper hex digit of the device type, and the 8 above that are xor'd into the
+	//     second octet of the OUI.  The first octet, with the I/G and U/L bits, is never touched, so device numbers
+	//     wrap at MaxDeviceAddresses rather than turning an address into a group or universal address.
+	unsigned long long bits = devNum % MaxDeviceAddresses;
+	return (base ^ (((bits & 0xff) << 16) | (((bits >> 8) & 0xf) << 28) | ((bits >> 12) << 32)));
+}
+
 /**/
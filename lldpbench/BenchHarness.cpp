@@ -0,0 +1,197 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include "BenchHarness.h"
+
+
+std::atomic<unsigned long long> BenchHarness::allocations(0);
+
+
+void BenchTimer::begin()
+{
+	elapsed = 0.0;
+	allocations = 0;
+	running = false;
+	resume();
+}
+
+void BenchTimer::end()
+{
+	pause();
+}
+
+void BenchTimer::pause()
+{
+	if (running)
+	{
+		elapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		allocations += BenchHarness::allocations.load(std::memory_order_relaxed) - startAllocations;
+		running = false;
+	}
+}
+
+void BenchTimer::resume()
+{
+	if (!running)
+	{
+		running = true;
+		startAllocations = BenchHarness::allocations.load(std::memory_order_relaxed);
+		start = std::chrono::steady_clock::now();
+	}
+}
+
+
+BenchHarness::BenchHarness()
+{
+	minTime = 0.1;
+	warmup = 1;
+	repetitions = 5;
+}
+
+BenchHarness::~BenchHarness()
+{
+}
+
+void BenchHarness::set_minTime(double seconds)
+{
+	minTime = std::max(seconds, 0.001);
+}
+
+void BenchHarness::set_warmup(int reps)
+{
+	warmup = std::max(reps, 0);
+}
+
+void BenchHarness::set_repetitions(int reps)
+{
+	repetitions = std::max(reps, 1);
+}
+
+void BenchHarness::set_filter(const std::string& text)
+{
+	filter = text;
+}
+
+bool BenchHarness::selected(const std::string& name) const
+{
+	return (filter.empty() || (name.find(filter) != std::string::npos));
+}
+
+const std::vector<BenchResult>& BenchHarness::getResults() const
+{
+	return (results);
+}
+
+double BenchHarness::timeBody(const BenchBody& body, unsigned long long ops, unsigned long long& allocs)
+{
+	BenchTimer timer;
+	timer.begin();
+	body(timer, ops);
+	timer.end();
+	allocs = timer.allocations;
+	return (timer.elapsed);
+}
+
+void BenchHarness::run(const std::string& name, unsigned long long size, const BenchBody& body)
+{
+	if (!selected(name))
+		return;
+
+	//  Calibrate:  grow ops until a run takes a tenth of minTime, then scale it up to take about minTime.
+	//     The calibration runs also warm caches, branch predictors and the FramePool free lists.
+	const double target = minTime * 1e9;
+	unsigned long long allocs = 0;
+	unsigned long long ops = 1;
+	double ns = timeBody(body, ops, allocs);
+	while ((ns < target / 10) && (ops < (1ULL << 40)))
+	{
+		double scale = (ns > 0.0) ? std::min(100.0, std::max(2.0, (target / 10) / ns * 1.5)) : 100.0;
+		ops = (unsigned long long)(ops * scale);
+		ns = timeBody(body, ops, allocs);
+	}
+	if (ns < target)
+		ops = std::max(ops, (unsigned long long)(ops * (target / std::max(ns, 1.0))));
+
+	for (int rep = 0; rep < warmup; rep++)
+		timeBody(body, ops, allocs);
+
+	std::vector<double> nsPerOp;
+	double allocSum = 0.0;
+	for (int rep = 0; rep < repetitions; rep++)
+	{
+		nsPerOp.push_back(timeBody(body, ops, allocs) / ops);
+		allocSum += (double)allocs / ops;
+	}
+
+	BenchResult result;
+	result.name = name;
+	result.size = size;
+	result.ops = ops;
+	result.repetitions = repetitions;
+	result.nsMean = 0.0;
+	for (double value : nsPerOp)
+		result.nsMean += value / repetitions;
+	std::sort(nsPerOp.begin(), nsPerOp.end());
+	result.nsMin = nsPerOp.front();
+	result.nsMedian = (repetitions % 2) ? nsPerOp[repetitions / 2]
+	                                    : (nsPerOp[(repetitions / 2) - 1] + nsPerOp[repetitions / 2]) / 2;
+	result.allocsPerOp = allocSum / repetitions;
+	results.push_back(result);
+
+	std::cout << "    " << std::left << std::setw(28) << name << std::right << std::setw(8) << size
+		<< std::fixed << std::setprecision(1) << std::setw(14) << result.nsMedian << " ns/op"
+		<< std::setw(12) << result.nsMin << " min" << std::setprecision(2) << std::setw(10) << result.allocsPerOp
+		<< " allocs/op" << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+}
+
+static std::string jsonString(const std::string& text)
+{
+	std::string quoted = "\"";
+	for (char c : text)
+	{
+		if ((c == '"') || (c == '\\'))
+			quoted += '\\';
+		if ((unsigned char)c >= 0x20)
+			quoted += c;
+	}
+	return (quoted + "\"");
+}
+
+void BenchHarness::writeJson(std::ostream& out) const
+{
+	//  One object per benchmark;  times are in nanoseconds per operation.
+	out << "{" << std::endl;
+	out << "  \"minTime\": " << minTime << "," << std::endl;
+	out << "  \"warmup\": " << warmup << "," << std::endl;
+	out << "  \"repetitions\": " << repetitions << "," << std::endl;
+	out << "  \"benchmarks\": [" << std::endl;
+	out << std::setprecision(6);
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult& result = results[i];
+		out << "    {\"name\": " << jsonString(result.name) << ", \"size\": " << result.size
+			<< ", \"ops\": " << result.ops << ", \"repetitions\": " << result.repetitions
+			<< ", \"ns_per_op\": " << result.nsMedian << ", \"ns_per_op_min\": " << result.nsMin
+			<< ", \"ns_per_op_mean\": " << result.nsMean << ", \"allocs_per_op\": " << result.allocsPerOp << "}"
+			<< ((i + 1 < results.size()) ? "," : "") << std::endl;
+	}
+	out << "  ]" << std::endl;
+	out << "}" << std::endl;
+}
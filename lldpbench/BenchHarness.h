@@ -0,0 +1,99 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+*   Class BenchHarness runs microbenchmarks with warm-up and repetition and reports ns/op and allocations/op, as text
+*      and as JSON so results can be compared between releases.
+*   A benchmark is a body that performs ops operations.  run() first calibrates ops so that one repetition takes
+*      about minTime, runs warmup repetitions that are not recorded, and then runs repetitions that are.  The time of
+*      each repetition is divided by ops;  the report gives the median, minimum and mean of these.
+*   Allocations are counted by the global operator new of the benchmark program (see lldpbench.cpp), which increments
+*      BenchHarness::allocations.  Blocks taken from the FramePool free lists are not heap allocations, so they are
+*      not counted.
+*   The body can call timer.pause() and timer.resume() to leave set up and tear down out of both the time and the
+*      allocation count (e.g. building a network before each run of it).
+*/
+
+class BenchTimer
+{
+public:
+	void pause();
+	void resume();
+
+private:
+	friend class BenchHarness;
+
+	std::chrono::steady_clock::time_point start;
+	unsigned long long startAllocations;
+	double elapsed;                           // Nanoseconds while running
+	unsigned long long allocations;           // Allocations while running
+	bool running;
+
+	void begin();
+	void end();
+};
+
+typedef std::function<void(BenchTimer& timer, unsigned long long ops)> BenchBody;
+
+struct BenchResult
+{
+	std::string name;
+	unsigned long long size;              // What the benchmark scales with (e.g. number of neighbors), or 0
+	unsigned long long ops;               // Operations per repetition
+	int repetitions;
+	double nsMedian;
+	double nsMin;
+	double nsMean;
+	double allocsPerOp;                   // Mean over the repetitions
+};
+
+class BenchHarness
+{
+public:
+	BenchHarness();
+	~BenchHarness();
+	BenchHarness(BenchHarness& copySource) = delete;             // Disable copy constructor
+	BenchHarness& operator= (const BenchHarness&) = delete;      // Disable assignment operator
+
+	static std::atomic<unsigned long long> allocations;
+
+	void set_minTime(double seconds);
+	void set_warmup(int reps);
+	void set_repetitions(int reps);
+	void set_filter(const std::string& text);      // Only run benchmarks whose name contains text
+
+	bool selected(const std::string& name) const;
+	void run(const std::string& name, unsigned long long size, const BenchBody& body);
+	void writeJson(std::ostream& out) const;
+	const std::vector<BenchResult>& getResults() const;
+
+private:
+	double minTime;                       // Seconds per repetition
+	int warmup;
+	int repetitions;
+	std::string filter;
+	std::vector<BenchResult> results;
+
+	double timeBody(const BenchBody& body, unsigned long long ops, unsigned long long& allocs);
+};
@@ -0,0 +1,411 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// lldpbench.cpp : Microbenchmarks of the LLDP simulation (TLV encoding, LLDPDU transmit and receive processing, the
+//    neighbor MIB) and of a whole network run, with warm-up, repetition, ns/op and allocations/op (see BenchHarness).
+//
+//    lldpbench [-json FILE] [-filter TEXT] [-time SECONDS] [-warmup N] [-reps N] [-threads N]
+//
+
+#include "stdafx.h"
+#include <cstdlib>
+#include <new>
+#include "LldpPort.h"
+#include "Topology.h"
+#include "EventScheduler.h"
+#include "BenchHarness.h"
+
+
+//  Replacing the global operator new counts every heap allocation in the program.  The array forms call these.
+void* operator new(size_t size)
+{
+	BenchHarness::allocations.fetch_add(1, std::memory_order_relaxed);
+	void* p = malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return (p);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	BenchHarness::allocations.fetch_add(1, std::memory_order_relaxed);
+	return (malloc(size ? size : 1));
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+
+/*
+*   BenchIss is an ISS that only supplies a MAC address, which an LLDP port needs to encode a Manifest TLV.
+*/
+class BenchIss : public Iss
+{
+public:
+	BenchIss(unsigned long long addr) : macAddress(addr) { enabled = true; }
+
+	virtual unsigned long long getMacAddress() const override { return (macAddress); }
+	virtual unique_ptr<Frame> Indication() override { return (nullptr); }
+	virtual void Request(unique_ptr<Frame> /* pFrameIn */) override {}
+
+	unsigned long long macAddress;
+};
+
+
+/*
+*   Class LldpBench holds the benchmarks.  It is a friend of LldpPort and its state machines so it can time their
+*      receive and transmit routines directly, without the rest of the state machines or the log output around them.
+*   Results are accumulated in sink so the compiler cannot discard the work being timed.
+*/
+
+class LldpBench
+{
+public:
+	static void tlvAccess(BenchHarness& harness);
+	static void tlvConstruction(BenchHarness& harness);
+	static void lldpduEncode(BenchHarness& harness);
+	static void lldpduValidate(BenchHarness& harness);
+	static void nborLookup(BenchHarness& harness);
+	static void manifestReconcile(BenchHarness& harness);
+	static void networkRun(BenchHarness& harness, unsigned int threads);
+
+	static volatile unsigned long long sink;
+
+private:
+	static shared_ptr<Lldpdu> encode(LldpPort& port, unsigned short ttl);
+};
+
+volatile unsigned long long LldpBench::sink = 0;
+
+
+shared_ptr<Lldpdu> LldpBench::encode(LldpPort& port, unsigned short ttl)
+{
+	shared_ptr<Lldpdu> pLldpdu = FramePool::makeSdu<Lldpdu>();
+	LldpPort::LldpTxSM::prepareLldpdu(port, *pLldpdu, ttl);
+	return (pLldpdu);
+}
+
+void LldpBench::tlvAccess(BenchHarness& harness)
+{
+	//  One op is a put (or get) of each width:  char, short, long, address and long long.  Size is the TLV length.
+	TLV tlv(TLVtypes::ORG_SPECIFIC, 32);
+	TlvView view = tlv.view();
+
+	harness.run("tlv put", tlv.getLength(), [&](BenchTimer& /* timer */, unsigned long long ops)
+	{
+		for (unsigned long long op = 0; op < ops; op++)
+		{
+			unsigned short offset = (unsigned short)(2 + (op & 7));
+			tlv.putChar(offset, (unsigned char)op);
+			tlv.putShort(offset + 1, (unsigned short)op);
+			tlv.putLong(offset + 3, (unsigned long)op);
+			tlv.putAddr(offset + 7, op);
+			tlv.putLongLong(offset + 13, op);
+		}
+	});
+	harness.run("tlv get", tlv.getLength(), [&](BenchTimer& /* timer */, unsigned long long ops)
+	{
+		unsigned long long total = 0;
+		for (unsigned long long op = 0; op < ops; op++)
+		{
+			unsigned short offset = (unsigned short)(2 + (op & 7));
+			total += tlv.getChar(offset) + tlv.getShort(offset + 1) + tlv.getLong(offset + 3)
+				+ tlv.getAddr(offset + 7) + tlv.getLongLong(offset + 13);
+		}
+		sink = sink + total;
+	});
+	harness.run("tlvview get", view.getLength(), [&](BenchTimer& /* timer */, unsigned long long ops)
+	{
+		unsigned long long total = 0;
+		for (unsigned long long op = 0; op < ops; op++)
+		{
+			unsigned short offset = (unsigned short)(2 + (op & 7));
+			total += view.getChar(offset) + view.getShort(offset + 1) + view.getLong(offset + 3)
+				+ view.getAddr(offset + 7) + view.getLongLong(offset + 13);
+		}
+		sink = sink + total;
+	});
+}
+
+void LldpBench::tlvConstruction(BenchHarness& harness)
+{
+	//  Building (and destroying) a string TLV, with size the string length, and a Manifest TLV with its
+	//     XPDU descriptors filled in, with size the number of descriptors.
+	const size_t lengths[] = { 8, 64, 255 };
+	const unsigned char xpduCounts[] = { 3, 16, 64 };
+
+	for (size_t length : lengths)
+	{
+		std::string text(length, 'x');
+		harness.run("TlvString construct", length, [&](BenchTimer& /* timer */, unsigned long long ops)
+		{
+			unsigned long long total = 0;
+			for (unsigned long long op = 0; op < ops; op++)
+			{
+				TlvString tlv(TLVtypes::SYSTEM_NAME, text);
+				total += tlv.getLength();
+			}
+			sink = sink + total;
+		});
+	}
+	for (unsigned char xpduCount : xpduCounts)
+	{
+		harness.run("tlvManifest construct", xpduCount, [&](BenchTimer& /* timer */, unsigned long long ops)
+		{
+			unsigned long long total = 0;
+			for (unsigned long long op = 0; op < ops; op++)
+			{
+				tlvManifest tlv(defaultBrdgAddr, xpduCount, 1500);
+				for (unsigned char i = 0; i < xpduCount; i++)
+					tlv.putXpduDescriptor(i, xpduDescriptor(i + 1, 1, (unsigned long)op));
+				total += tlv.getLength();
+			}
+			sink = sink + total;
+		});
+	}
+}
+
+void LldpBench::lldpduEncode(BenchHarness& harness)
+{
+	//  Encoding the Manifest LLDPDU of a port's local MIB, as the transmit state machine does when the local MIB
+	//     has changed.  Size is the encoded length in octets.
+	LldpPort port(defaultBrdgAddr, 1, NearestBridgeDA);
+	port.pIss = make_shared<BenchIss>(defaultBrdgAddr + 1);
+	port.set_lldpV2Enabled(true);
+
+	harness.run("prepareLldpdu", encode(port, 30)->size(), [&](BenchTimer& /* timer */, unsigned long long ops)
+	{
+		unsigned long long total = 0;
+		for (unsigned long long op = 0; op < ops; op++)
+			total += encode(port, 30)->size();
+		sink = sink + total;
+	});
+}
+
+void LldpBench::lldpduValidate(BenchHarness& harness)
+{
+	//  Decoding and validating a received Manifest LLDPDU (and a Shutdown LLDPDU), which rxProcessFrame does for
+	//     every LLDPDU before deciding what to do with it.  Size is the LLDPDU length in octets.
+	LldpPort txPort(defaultBrdgAddr, 1, NearestBridgeDA);
+	txPort.pIss = make_shared<BenchIss>(defaultBrdgAddr + 1);
+	LldpPort rxPort(defaultBrdgAddr + 0x10000, 1, NearestBridgeDA);
+	rxPort.set_lldpV2Enabled(true);
+	shared_ptr<Lldpdu> pManifest = encode(txPort, 30);
+	shared_ptr<Lldpdu> pShutdown = encode(txPort, 0);
+
+	shared_ptr<Lldpdu> pEnded = encode(txPort, 30);           // TLVs after an End TLV are counted as discarded
+	pEnded->putTlv(TLV(TLVtypes::END, 0));
+	pEnded->putTlv(TlvString(TLVtypes::SYSTEM_DESC, "ignored"));
+	pEnded->putTlv(TlvString(TLVtypes::PORT_DESC, "ignored"));
+	rxPort.pRxLldpFrame = make_unique<Frame>(NearestBridgeDA, defaultBrdgAddr, pEnded);
+	LldpPort::LldpRxSM::rxProcessFrame(rxPort);
+	if (rxPort.get_stat(STATS_TLVS_DISCARDED_TOTAL) != 2)
+		cerr << "    rxProcessFrame discarded " << rxPort.get_stat(STATS_TLVS_DISCARDED_TOTAL)
+			<< " TLVs after an End TLV, expected 2" << endl;
+
+	for (auto& pLldpdu : { pManifest, pShutdown })
+	{
+		rxPort.pRxLldpFrame = make_unique<Frame>(NearestBridgeDA, defaultBrdgAddr, pLldpdu);
+		harness.run((pLldpdu == pManifest) ? "rxProcessFrame manifest" : "rxProcessFrame shutdown", pLldpdu->size(),
+			[&](BenchTimer& /* timer */, unsigned long long ops)
+		{
+			unsigned long long total = 0;
+			for (unsigned long long op = 0; op < ops; op++)
+				total += LldpPort::LldpRxSM::rxProcessFrame(rxPort);
+			sink = sink + total;
+		});
+	}
+	rxPort.pRxLldpFrame = nullptr;
+}
+
+void LldpBench::nborLookup(BenchHarness& harness)
+{
+	//  Looking up each neighbor of a port in turn from the first TLVs of its LLDPDU.  Neighbors are many ports on
+	//     a few chassis, as seen by a port facing a hub, TPMR, or virtual switch.  Size is the number of neighbors.
+	const unsigned int nborCounts[] = { 1, 10, 100, 1000, 10000 };
+
+	for (unsigned int nborCount : nborCounts)
+	{
+		LldpPort port(defaultBrdgAddr + 0xff0000, 0, NearestBridgeDA);
+		port.maxSizeNborMIBs = ~0ULL;
+		for (unsigned int i = 0; i < nborCount; i++)
+		{
+			MibEntry nbor;
+			nbor.chassisID = TLV(TLVtypes::CHASSIS_ID, 7);
+			nbor.chassisID.putChar(2, 4);
+			nbor.chassisID.putAddr(3, defaultBrdgAddr + ((unsigned long long)(i / 64) << 16));
+			nbor.portID = TLV(TLVtypes::PORT_ID, 5);
+			nbor.portID.putChar(2, 4);
+			nbor.portID.putLong(3, i % 64);
+			port.addNbor(nbor);
+		}
+		std::vector<std::vector<TlvView>> nborTlvs;          // Views into the MIB stay valid since nborMIBs no longer changes
+		for (auto& nbor : port.nborMIBs)
+			nborTlvs.push_back({ nbor.chassisID.view(), nbor.portID.view() });
+
+		harness.run("findNborIndex", nborCount, [&](BenchTimer& /* timer */, unsigned long long ops)
+		{
+			unsigned long long found = 0;
+			for (unsigned long long op = 0; op < ops; op++)
+			{
+				unsigned int i = (unsigned int)(op % nborCount);
+				found += (LldpPort::LldpRxSM::findNborIndex(port, nborTlvs[i]) == i);
+			}
+			sink = sink + found;
+		});
+	}
+}
+
+void LldpBench::manifestReconcile(BenchHarness& harness)
+{
+	//  Receiving a Manifest LLDPDU from a known neighbor whose XPDUs have all been received.  "same" repeats the
+	//     LLDPDU already in the neighbor MIB, which is the steady state.  "changed" alternates between two LLDPDUs
+	//     whose XPDU 0 differs, so every LLDPDU builds a new XPDU map (reusing the unchanged XPDUs) and completes it.
+	//     Size is the number of XPDUs.  The receiving port has no ISS, so no XREQs are sent.
+	LldpPort txPort(defaultBrdgAddr, 1, NearestBridgeDA);
+	txPort.pIss = make_shared<BenchIss>(defaultBrdgAddr + 1);
+	shared_ptr<Lldpdu> pFirst = encode(txPort, 30);
+	std::vector<shared_ptr<Lldpdu>> pXpdus;                  // Extension LLDPDUs answering the XREQs for the first manifest
+	for (auto& xpdu : *txPort.localMIB.pXpduMap)
+		if (xpdu.first != 0)
+			pXpdus.push_back(LldpPort::LldpRxSM::getXpduLldpdu(txPort, xpdu.second));
+	txPort.set_systemName("Someone else");
+	shared_ptr<Lldpdu> pSecond = encode(txPort, 30);
+
+	std::vector<TlvView> firstTlvs;
+	std::vector<TlvView> secondTlvs;
+	std::vector<TlvView> xpduTlvs;
+	pFirst->decode(firstTlvs);
+	pSecond->decode(secondTlvs);
+	unsigned long long xpdus = txPort.localMIB.pXpduMap->size();
+
+	for (int changed = 0; changed < 2; changed++)
+	{
+		LldpPort rxPort(defaultBrdgAddr + 0x10000, 1, NearestBridgeDA);
+		rxPort.set_lldpV2Enabled(true);
+		LldpPort::LldpRxSM::xRxManifest(rxPort, firstTlvs);      // Creates the neighbor
+		for (auto& pXpdu : pXpdus)                               //    and completes its manifest
+		{
+			pXpdu->decode(xpduTlvs);
+			LldpPort::LldpRxSM::xRxXPDU(rxPort, xpduTlvs);
+		}
+
+		harness.run(changed ? "xRxManifest changed" : "xRxManifest same", xpdus, [&](BenchTimer& /* timer */, unsigned long long ops)
+		{
+			for (unsigned long long op = 0; op < ops; op++)
+				LldpPort::LldpRxSM::xRxManifest(rxPort, (changed && (op & 1)) ? secondTlvs : firstTlvs);
+			sink = sink + rxPort.nborMIBs.size();
+		});
+	}
+}
+
+void LldpBench::networkRun(BenchHarness& harness, unsigned int threads)
+{
+	//  A whole network run:  a k = 4 fat tree of Bridges and End Stations running LLDP for 1000 ticks from power on.
+	//     Building and destroying the network is not timed.  Size is the number of Devices.
+	const std::string spec = "fattree:k=4,hosts=1,end=1000";
+	std::vector<unique_ptr<Device>> Devices;
+	size_t deviceCount = 0;
+	{
+		Topology topology(Devices);
+		topology.generate(spec);
+		deviceCount = topology.getDeviceCount();
+		Devices.clear();
+	}
+
+	harness.run("network run 1000 ticks", deviceCount, [&](BenchTimer& timer, unsigned long long ops)
+	{
+		for (unsigned long long op = 0; op < ops; op++)
+		{
+			timer.pause();
+			{
+				Topology topology(Devices);
+				topology.generate(spec);
+				for (auto& pDev : Devices)
+					pDev->reset();
+				EventScheduler sim(Devices);
+				sim.setThreads(threads);
+				int start = SimLog::Time;
+				topology.schedule(sim, start);
+				timer.resume();
+
+				sim.run(start + topology.get_endTime());
+
+				timer.pause();
+			}   // The scheduler and topology are destroyed here, while the timer is paused
+			Devices.clear();
+			timer.resume();
+		}
+	});
+}
+
+
+int main(int argc, char* argv[])
+{
+	std::string jsonFile;
+	unsigned int threads = 1;
+	BenchHarness harness;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		std::string option = argv[arg];
+		if ((option == "-json") && (arg + 1 < argc))
+			jsonFile = argv[++arg];
+		else if ((option == "-filter") && (arg + 1 < argc))
+			harness.set_filter(argv[++arg]);
+		else if ((option == "-time") && (arg + 1 < argc))
+			harness.set_minTime(atof(argv[++arg]));
+		else if ((option == "-warmup") && (arg + 1 < argc))
+			harness.set_warmup(atoi(argv[++arg]));
+		else if ((option == "-reps") && (arg + 1 < argc))
+			harness.set_repetitions(atoi(argv[++arg]));
+		else if ((option == "-threads") && (arg + 1 < argc))
+			threads = std::max(1, atoi(argv[++arg]));
+		else
+		{
+			cerr << "Usage:  lldpbench [-json FILE] [-filter TEXT] [-time SECONDS] [-warmup N] [-reps N] [-threads N]" << endl;
+			return 1;
+		}
+	}
+	SimLog::Debug = 0;                    // No logging, so the benchmarks time the work and not the log output
+
+	cout << endl << "   LLDP benchmarks (median of repetitions):  " << endl << endl;
+	LldpBench::tlvAccess(harness);
+	LldpBench::tlvConstruction(harness);
+	LldpBench::lldpduEncode(harness);
+	LldpBench::lldpduValidate(harness);
+	LldpBench::nborLookup(harness);
+	LldpBench::manifestReconcile(harness);
+	LldpBench::networkRun(harness, threads);
+
+	if (!jsonFile.empty())
+	{
+		ofstream out(jsonFile);
+		if (!out)
+		{
+			cerr << "Cannot create " << jsonFile << endl;
+			return 1;
+		}
+		harness.writeJson(out);
+	}
+	return 0;
+}
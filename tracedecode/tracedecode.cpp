@@ -0,0 +1,199 @@
+/*
+Copyright 2026 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// tracedecode.cpp : Renders a binary trace file written by the lldp simulation ("lldp -trace FILE") as text
+//    or as Chrome trace event JSON (for chrome://tracing or Perfetto).
+//
+//    tracedecode [-json] TRACEFILE [OUTFILE]
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "TraceFormat.h"
+
+using namespace std;
+
+
+const int MicrosecondsPerTick = 1000;       // Chrome trace timestamps are in microseconds;  show one tick as 1 ms
+
+static bool readTrace(const string& fileName, TraceFileHeader& header, vector<TraceRecord>& records)
+{
+	ifstream in(fileName, ios::binary);
+	if (!in)
+	{
+		cerr << "Cannot open " << fileName << endl;
+		return (false);
+	}
+	in.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!in || (memcmp(header.magic, TraceMagic, sizeof(header.magic)) != 0))
+	{
+		cerr << fileName << " is not a trace file" << endl;
+		return (false);
+	}
+	if ((header.version != TraceVersion) || (header.recordSize != sizeof(TraceRecord)))
+	{
+		cerr << fileName << " has trace version " << header.version << " with " << header.recordSize
+			<< " octet records;  expected version " << TraceVersion << " with " << sizeof(TraceRecord) << endl;
+		return (false);
+	}
+
+	records.resize((size_t)header.recordCount);
+	in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(TraceRecord));
+	if ((size_t)in.gcount() != records.size() * sizeof(TraceRecord))
+	{
+		records.resize((size_t)in.gcount() / sizeof(TraceRecord));
+		cerr << fileName << " is truncated;  decoding " << records.size() << " of " << header.recordCount << " records" << endl;
+	}
+
+	//  Records are in order within each thread's blocks, so a stable sort on time gives a single timeline
+	stable_sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) { return (a.time < b.time); });
+	return (true);
+}
+
+static void writeText(ostream& out, const TraceFileHeader& header, const vector<TraceRecord>& records)
+{
+	for (auto& rec : records)
+	{
+		out << "Time " << setw(6) << rec.time << ":  ";
+		if (rec.event == TRACE_MAC_TRANSMIT)
+		{
+			out << "MAC " << hex << rec.device << " SAP " << dec << rec.port << "  transmit to " << hex << rec.arg0
+				<< " Ethertype " << setw(4) << setfill('0') << rec.arg1 << setfill(' ') << dec
+				<< (rec.arg2 ? "" : "  (not delivered)") << endl;
+		}
+		else
+		{
+			out << "chassis " << hex << rec.device << " port " << rec.port << dec << "  " << traceEventName(rec.event)
+				<< "  " << traceStateName(rec.event, rec.arg1) << " -> " << traceStateName(rec.event, rec.arg2) << endl;
+		}
+	}
+	out << records.size() << " events";
+	if (header.droppedCount)
+		out << " (" << header.droppedCount << " dropped because the trace file was full)";
+	out << endl;
+}
+
+static void writeJson(ostream& out, const vector<TraceRecord>& records)
+{
+	//  Each chassis (LLDP events) or MAC (transmit events) is a process, and each port or SAP a thread.
+	//     State machine states are complete ("X") events lasting until the next transition of the same machine;
+	//     frame transmissions are instant ("i") events.
+	map<pair<bool, uint64_t>, int> pids;
+	map<tuple<uint64_t, uint16_t, uint16_t>, const TraceRecord*> openStates;
+	bool first = true;
+	int lastTime = records.empty() ? 0 : records.back().time;
+
+	auto pidOf = [&](bool mac, uint64_t device) {
+		auto found = pids.find(make_pair(mac, device));
+		if (found != pids.end())
+			return (found->second);
+		int pid = (int)pids.size() + 1;
+		pids[make_pair(mac, device)] = pid;
+		return (pid);
+	};
+	auto separator = [&]() -> ostream& {
+		out << (first ? "\n" : ",\n");
+		first = false;
+		return (out);
+	};
+	auto writeState = [&](const TraceRecord& rec, int endTime) {
+		separator() << "{\"name\":\"" << traceStateName(rec.event, rec.arg2) << "\",\"cat\":\"" << traceEventName(rec.event)
+			<< "\",\"ph\":\"X\",\"ts\":" << (long long)rec.time * MicrosecondsPerTick
+			<< ",\"dur\":" << (long long)(endTime - rec.time) * MicrosecondsPerTick
+			<< ",\"pid\":" << pidOf(false, rec.device) << ",\"tid\":" << rec.port
+			<< ",\"args\":{\"from\":\"" << traceStateName(rec.event, rec.arg1) << "\"}}";
+	};
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	for (auto& rec : records)
+	{
+		if (rec.event == TRACE_MAC_TRANSMIT)
+		{
+			separator() << "{\"name\":\"transmit\",\"cat\":\"MAC\",\"ph\":\"i\",\"s\":\"t\",\"ts\":"
+				<< (long long)rec.time * MicrosecondsPerTick << ",\"pid\":" << pidOf(true, rec.device) << ",\"tid\":" << rec.port
+				<< ",\"args\":{\"da\":\"" << hex << rec.arg0 << "\",\"ethertype\":\"" << rec.arg1 << dec
+				<< "\",\"delivered\":" << (rec.arg2 ? "true" : "false") << "}}";
+		}
+		else
+		{
+			auto key = make_tuple(rec.device, rec.port, rec.event);
+			auto open = openStates.find(key);
+			if (open != openStates.end())
+				writeState(*open->second, rec.time);
+			openStates[key] = &rec;
+		}
+	}
+	for (auto& open : openStates)
+		writeState(*open.second, lastTime);
+
+	for (auto& pid : pids)
+	{
+		separator() << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid.second
+			<< ",\"args\":{\"name\":\"" << (pid.first.first ? "MAC " : "chassis ") << hex << pid.first.second << dec << "\"}}";
+	}
+	out << "\n]}" << endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+	bool json = false;
+	vector<string> files;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		if (string(argv[arg]) == "-json")
+			json = true;
+		else
+			files.push_back(argv[arg]);
+	}
+	if ((files.size() < 1) || (files.size() > 2))
+	{
+		cerr << "Usage:  tracedecode [-json] TRACEFILE [OUTFILE]" << endl;
+		return 1;
+	}
+
+	TraceFileHeader header;
+	vector<TraceRecord> records;
+	if (!readTrace(files[0], header, records))
+		return 1;
+
+	ofstream outFile;
+	if (files.size() > 1)
+	{
+		outFile.open(files[1]);
+		if (!outFile)
+		{
+			cerr << "Cannot create " << files[1] << endl;
+			return 1;
+		}
+	}
+	ostream& out = (files.size() > 1) ? outFile : cout;
+
+	if (json)
+		writeJson(out, records);
+	else
+		writeText(out, header, records);
+
+	return 0;
+}